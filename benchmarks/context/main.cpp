@@ -0,0 +1,90 @@
+// Copyright (C) 2020-2022 Jonathan Müller and lexy contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#define ANKERL_NANOBENCH_IMPLEMENT
+#include <nanobench.h>
+
+#include <string>
+
+#include <lexy/action/match.hpp>
+#include <lexy/dsl.hpp>
+#include <lexy/input/string_input.hpp>
+
+namespace grammar
+{
+namespace dsl = lexy::dsl;
+
+constexpr auto indent  = dsl::context_counter<struct indent_id>;
+constexpr auto depth   = dsl::context_counter<struct depth_id>;
+constexpr auto lines   = dsl::context_counter<struct lines_id>;
+constexpr auto heredoc = dsl::context_counter<struct heredoc_id>;
+
+// Counts the indentation of a line: a line without indentation closes a block,
+// other lines open one.
+template <bool Nesting>
+struct line
+{
+    static constexpr auto rule = [] {
+        auto spaces = indent.create() + indent.push(dsl::while_(dsl::lit_c<' '>));
+        auto text   = dsl::while_(dsl::ascii::alpha) + dsl::newline;
+        if constexpr (Nesting)
+            return spaces + (indent.is_zero() >> depth.dec() | dsl::else_ >> depth.inc()) + text
+                   + lines.inc();
+        else
+            return spaces + (indent.is_zero() >> text | dsl::else_ >> text);
+    }();
+};
+
+// Only the indentation counter.
+struct indent_only
+{
+    static constexpr auto rule = dsl::terminator(dsl::eof).list(dsl::p<line<false>>);
+};
+
+// The other counters are created before the indentation counter of each line.
+struct four_counters
+{
+    static constexpr auto rule = lines.create() + heredoc.create() + depth.create()
+                                 + dsl::terminator(dsl::eof).list(dsl::p<line<true>>);
+};
+// Like four_counters, but the counters need to be found behind more unrelated ones.
+struct eight_counters
+{
+    static constexpr auto rule
+        = lines.create() + heredoc.create() + depth.create()
+          + dsl::context_counter<struct a_id>.create() + dsl::context_counter<struct b_id>.create()
+          + dsl::context_counter<struct c_id>.create() + dsl::context_counter<struct d_id>.create()
+          + dsl::terminator(dsl::eof).list(dsl::p<line<true>>);
+};
+} // namespace grammar
+
+std::string make_document(std::size_t lines)
+{
+    std::string result;
+    for (auto i = 0u; i != lines; ++i)
+    {
+        result.append(i % 4, ' ');
+        result += "line\n";
+    }
+    return result;
+}
+
+int main()
+{
+    ankerl::nanobench::Bench b;
+
+    auto bench_document = [&](const char* title, std::size_t lines) {
+        auto document = make_document(lines);
+        auto input    = lexy::string_input(document.data(), document.size());
+
+        b.title(title).relative(true);
+        b.unit("line").batch(lines);
+
+        b.run("one counter", [&] { return lexy::match<grammar::indent_only>(input); });
+        b.run("four counters", [&] { return lexy::match<grammar::four_counters>(input); });
+        b.run("eight counters", [&] { return lexy::match<grammar::eight_counters>(input); });
+    };
+
+    bench_document("100 lines", 100);
+    bench_document("10000 lines", 10000);
+}
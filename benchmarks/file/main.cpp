@@ -6,6 +6,7 @@
 
 #include <cstdio>
 #include <fstream>
+#include <vector>
 #include <lexy/input/file.hpp>
 
 std::size_t use_buffer(const lexy::buffer<>& buffer)
@@ -59,6 +60,23 @@ std::size_t file_stream(const char* path)
     return use_buffer(buffer);
 }
 
+// Converts big endian UTF-16 by assembling each code unit from its bytes.
+std::size_t utf16_scalar(const std::vector<unsigned char>& data)
+{
+    lexy::buffer<lexy::utf16_encoding>::builder builder(data.size() / 2);
+    for (auto i = std::size_t(0); i != builder.size(); ++i)
+        builder.data()[i] = char16_t((data[2 * i] << 8) | data[2 * i + 1]);
+    auto buffer = LEXY_MOV(builder).finish();
+    return buffer.size() + std::size_t(buffer.data()[buffer.size() / 2]);
+}
+
+std::size_t utf16_lexy(const std::vector<unsigned char>& data)
+{
+    auto make   = lexy::make_buffer_from_raw<lexy::utf16_encoding, lexy::encoding_endianness::big>;
+    auto buffer = make(data.data(), data.size());
+    return buffer.size() + std::size_t(buffer.data()[buffer.size() / 2]);
+}
+
 constexpr auto bm_file_path = "bm-file.delete-me";
 
 void write_file(std::size_t size)
@@ -99,6 +117,23 @@ int main()
 
     bench_data("1 MiB", 1024 * 1024, 100);
 
+    auto bench_utf16 = [&](const char* title, std::size_t size, std::size_t iterations) {
+        b.minEpochIterations(iterations);
+        b.title(title).relative(true);
+        b.unit("byte").batch(size);
+
+        std::vector<unsigned char> data(size);
+        for (auto i = std::size_t(0); i != size; ++i)
+            data[i] = static_cast<unsigned char>(i * 7);
+
+        b.run("scalar", [&] { return utf16_scalar(data); });
+        b.run("lexy", [&] { return utf16_lexy(data); });
+    };
+
+    bench_utf16("UTF-16BE 4 KiB", 4 * 1024, 10 * 1000);
+    bench_utf16("UTF-16BE 64 KiB", 64 * 1024, 1000);
+    bench_utf16("UTF-16BE 1 MiB", 1024 * 1024, 100);
+
     std::remove(bm_file_path);
 }
 
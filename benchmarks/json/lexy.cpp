@@ -1,8 +1,13 @@
 // Copyright (C) 2020-2022 Jonathan Müller and lexy contributors
 // SPDX-License-Identifier: BSL-1.0
 
+#include <atomic>
 #include <lexy/action/validate.hpp>
 #include <lexy/input/file.hpp>
+#include <lexy/input/string_input.hpp>
+#include <lexy/structural_index.hpp>
+#include <thread>
+#include <vector>
 
 #define LEXY_TEST
 #include "../../examples/json.cpp"
@@ -12,3 +17,248 @@ bool json_lexy(const lexy::buffer<lexy::utf8_encoding>& input)
     return lexy::validate<grammar::json>(input, lexy::noop).is_success();
 }
 
+namespace
+{
+namespace dsl = lexy::dsl;
+
+// The productions used to validate the pieces of a document in parallel.
+// Each piece is a run of elements or members that starts after a separator,
+// so we need to skip whitespace first.
+// Note that the recursion limit applies to each piece and not to the entire document.
+struct parallel_elements
+{
+    static constexpr auto max_recursion_depth = grammar::json::max_recursion_depth;
+    static constexpr auto whitespace          = grammar::json::whitespace;
+
+    static constexpr auto rule = dsl::whitespace(whitespace)
+                                 + dsl::list(dsl::p<grammar::json_value>, dsl::sep(dsl::comma))
+                                 + dsl::eof;
+};
+
+struct parallel_members
+{
+    static constexpr auto max_recursion_depth = grammar::json::max_recursion_depth;
+    static constexpr auto whitespace          = grammar::json::whitespace;
+
+    static constexpr auto rule = [] {
+        auto member = dsl::p<grammar::string> + dsl::colon + dsl::p<grammar::json_value>;
+        return dsl::whitespace(whitespace) + dsl::list(member, dsl::sep(dsl::comma)) + dsl::eof;
+    }();
+};
+
+struct parallel_key
+{
+    static constexpr auto whitespace = grammar::json::whitespace;
+    static constexpr auto rule = dsl::whitespace(whitespace) + dsl::p<grammar::string> + dsl::eof;
+};
+
+using char_type = lexy::utf8_encoding::char_type;
+
+struct parallel_task
+{
+    enum kind_t
+    {
+        document,
+        elements,
+        members,
+        key,
+    };
+
+    const char_type* first;
+    const char_type* last;
+    kind_t           kind;
+};
+
+class parallel_splitter
+{
+public:
+    explicit parallel_splitter(const lexy::buffer<lexy::utf8_encoding>& input,
+                               std::size_t                              threshold)
+    : _index(input), _threshold(std::ptrdiff_t(threshold))
+    {}
+
+    // Splits the entire document into tasks; returns false if its structure is already invalid.
+    bool split(std::vector<parallel_task>& tasks) const
+    {
+        auto& input = _index.input();
+        auto  first = input.data();
+        auto  last  = input.data() + input.size();
+        if (first == last || (*first != '[' && *first != '{') || !_index.is_balanced())
+        {
+            tasks.push_back({first, last, parallel_task::document});
+            return true;
+        }
+
+        // Anything after the top-level value must be whitespace.
+        auto close = _index.matching_bracket(first);
+        return _is_blank(close + 1, last) && _split_container(tasks, first, close);
+    }
+
+private:
+    static bool _is_ws(char_type c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+    }
+
+    bool _is_blank(const char_type* first, const char_type* last) const
+    {
+        for (auto cur = first; cur != last; ++cur)
+            if (!_is_ws(*cur))
+                return false;
+        return true;
+    }
+
+    // Returns the opening bracket if the value in [first, last) is a container worth splitting.
+    const char_type* _big_container(const char_type* first, const char_type* last) const
+    {
+        if (last - first < _threshold)
+            return nullptr;
+
+        while (first != last && _is_ws(*first))
+            ++first;
+        if (first != last && (*first == '[' || *first == '{'))
+            return first;
+        else
+            return nullptr;
+    }
+
+    bool _split_value(std::vector<parallel_task>& tasks, const char_type* open,
+                      const char_type* last) const
+    {
+        auto close = _index.matching_bracket(open);
+        return _is_blank(close + 1, last) && _split_container(tasks, open, close);
+    }
+
+    bool _split_container(std::vector<parallel_task>& tasks, const char_type* open,
+                          const char_type* close) const
+    {
+        if (_index.next_separator(open, open + 1) == close && _is_blank(open + 1, close))
+            return true;
+        else if (*open == '[')
+            return _split_array(tasks, open, close);
+        else
+            return _split_object(tasks, open, close);
+    }
+
+    // Small elements are combined into runs of roughly threshold bytes, big ones are split further.
+    bool _split_array(std::vector<parallel_task>& tasks, const char_type* open,
+                      const char_type* close) const
+    {
+        auto run = open + 1;
+        for (auto cur = open + 1;;)
+        {
+            auto sep = _index.next_separator(open, cur);
+            if (*sep == ':')
+                return false;
+
+            if (auto nested = _big_container(cur, sep))
+            {
+                if (run != cur)
+                    tasks.push_back({run, cur - 1, parallel_task::elements});
+                if (!_split_value(tasks, nested, sep))
+                    return false;
+                run = sep + 1;
+            }
+            else if (sep - run >= _threshold || sep == close)
+            {
+                // An empty element in the run also catches trailing commas.
+                tasks.push_back({run, sep, parallel_task::elements});
+                run = sep + 1;
+            }
+
+            if (sep == close)
+                return true;
+            cur = sep + 1;
+        }
+    }
+
+    bool _split_object(std::vector<parallel_task>& tasks, const char_type* open,
+                       const char_type* close) const
+    {
+        auto run = open + 1;
+        for (auto cur = open + 1;;)
+        {
+            auto colon = _index.next_separator(open, cur);
+            if (*colon != ':')
+                return false;
+            auto sep = _index.next_separator(open, colon + 1);
+            if (*sep == ':')
+                return false;
+
+            if (auto nested = _big_container(colon + 1, sep))
+            {
+                if (run != cur)
+                    tasks.push_back({run, cur - 1, parallel_task::members});
+                tasks.push_back({cur, colon, parallel_task::key});
+                if (!_split_value(tasks, nested, sep))
+                    return false;
+                run = sep + 1;
+            }
+            else if (sep - run >= _threshold || sep == close)
+            {
+                tasks.push_back({run, sep, parallel_task::members});
+                run = sep + 1;
+            }
+
+            if (sep == close)
+                return true;
+            cur = sep + 1;
+        }
+    }
+
+    lexy::structural_index<lexy::buffer<lexy::utf8_encoding>> _index;
+    std::ptrdiff_t                                            _threshold;
+};
+} // namespace
+
+bool json_lexy_parallel(const lexy::buffer<lexy::utf8_encoding>& input)
+{
+    auto n_threads = std::thread::hardware_concurrency();
+    if (n_threads == 0)
+        n_threads = 1;
+
+    // First pass: split the document into pieces at the separators of big containers.
+    std::vector<parallel_task> tasks;
+    auto splitter = parallel_splitter(input, input.size() / (8 * std::size_t(n_threads)));
+    if (!splitter.split(tasks))
+        return false;
+
+    // Second pass: validate each piece on its own.
+    std::atomic<std::size_t> next_task(0);
+    std::atomic<bool>        success(true);
+    auto                     worker = [&] {
+        for (auto idx = next_task++; idx < tasks.size() && success; idx = next_task++)
+        {
+            auto& task  = tasks[idx];
+            auto  piece = lexy::string_input<lexy::utf8_encoding>(task.first, task.last);
+
+            auto valid = false;
+            switch (task.kind)
+            {
+            case parallel_task::document:
+                valid = lexy::validate<grammar::json>(piece, lexy::noop).is_success();
+                break;
+            case parallel_task::elements:
+                valid = lexy::validate<parallel_elements>(piece, lexy::noop).is_success();
+                break;
+            case parallel_task::members:
+                valid = lexy::validate<parallel_members>(piece, lexy::noop).is_success();
+                break;
+            case parallel_task::key:
+                valid = lexy::validate<parallel_key>(piece, lexy::noop).is_success();
+                break;
+            }
+            if (!valid)
+                success = false;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (auto i = 1u; i < n_threads; ++i)
+        threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads)
+        thread.join();
+
+    return success;
+}
@@ -8,6 +8,7 @@
 
 bool json_baseline(const lexy::buffer<lexy::utf8_encoding>& input);
 bool json_lexy(const lexy::buffer<lexy::utf8_encoding>& input);
+bool json_lexy_parallel(const lexy::buffer<lexy::utf8_encoding>& input);
 bool json_pegtl(const lexy::buffer<lexy::utf8_encoding>& input);
 bool json_nlohmann(const lexy::buffer<lexy::utf8_encoding>& input);
 bool json_rapid(const lexy::buffer<lexy::utf8_encoding>& input);
@@ -76,6 +77,9 @@ const char* output_suffix()
     This simply adds all input characters of the JSON document without performing actual validation.
 `lexy`::
     A JSON validator using the lexy grammar from the example.
+`lexy (parallel)`::
+    The same grammar, but big arrays and objects are first split into their elements using a `lexy::structural_index`.
+    The elements are then validated in parallel on all hardware threads.
 `pegtl`::
     A JSON validator using the https://github.com/taocpp/PEGTL[PEGTL] JSON grammar.
 `nlohmann/json`::
@@ -117,6 +121,7 @@ int main()
 
         b.run("baseline", [&] { return json_baseline(data); });
         b.run("lexy", [&] { return json_lexy(data); });
+        b.run("lexy (parallel)", [&] { return json_lexy_parallel(data); });
         b.run("pegtl", [&] { return json_pegtl(data); });
         b.run("nlohmann/json", [&] { return json_nlohmann(data); });
         b.run("rapidjson", [&] { return json_rapid(data); });
@@ -0,0 +1,136 @@
+// Copyright (C) 2020-2022 Jonathan Müller and lexy contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#define ANKERL_NANOBENCH_IMPLEMENT
+#include <nanobench.h>
+
+#include <cstdio>
+#include <string>
+
+#include <lexy/action/parse_as_tree.hpp>
+#include <lexy/dsl.hpp>
+#include <lexy/input/string_input.hpp>
+
+namespace grammar
+{
+namespace dsl = lexy::dsl;
+
+struct key
+{
+    static constexpr auto rule = dsl::identifier(dsl::ascii::alpha);
+};
+
+struct value
+{
+    static constexpr auto rule = dsl::digits<>;
+};
+
+struct entry
+{
+    static constexpr auto rule
+        = dsl::p<key> + dsl::lit_c<'='> + dsl::p<value> + dsl::lit_c<';'>;
+};
+
+struct document
+{
+    static constexpr auto whitespace = dsl::ascii::space;
+    static constexpr auto rule       = dsl::terminator(dsl::eof).list(dsl::p<entry>);
+};
+} // namespace grammar
+
+// Forwards to new/delete but counts the allocations.
+struct counting_resource
+{
+    std::size_t allocations = 0;
+
+    void* allocate(std::size_t bytes, std::size_t)
+    {
+        ++allocations;
+        return ::operator new(bytes);
+    }
+    void deallocate(void* ptr, std::size_t, std::size_t) noexcept
+    {
+        ::operator delete(ptr);
+    }
+};
+
+using input_t = lexy::string_input<lexy::utf8_encoding>;
+using tree_t  = lexy::parse_tree_for<input_t, void, counting_resource>;
+
+std::string make_document(std::size_t entries)
+{
+    std::string result;
+    for (auto i = 0u; i != entries; ++i)
+        result += "key" + std::string(1, char('a' + i % 26)) + " = " + std::to_string(i) + ";\n";
+    return result;
+}
+
+// Parses into a new tree every time.
+std::size_t parse_new(counting_resource& resource, const input_t& input)
+{
+    tree_t tree(&resource);
+    lexy::parse_as_tree<grammar::document>(tree, input, lexy::noop);
+    return tree.size();
+}
+
+// Parses into a new tree every time, but reserves memory based on the input size first.
+std::size_t parse_reserve(counting_resource& resource, const input_t& input)
+{
+    tree_t tree(&resource);
+    // The grammar creates about one node per character (including whitespace tokens),
+    // and a node takes up three pointers plus the occasional pointer to its first child.
+    tree.reserve(input.size() * 4 * sizeof(void*));
+    lexy::parse_as_tree<grammar::document>(tree, input, lexy::noop);
+    return tree.size();
+}
+
+// Parses into the same tree every time.
+std::size_t parse_reuse(tree_t& tree, const input_t& input)
+{
+    lexy::parse_as_tree<grammar::document>(tree, input, lexy::noop);
+    return tree.size();
+}
+
+int main()
+{
+    ankerl::nanobench::Bench b;
+
+    auto bench_document = [&](const char* title, std::size_t entries) {
+        auto document = make_document(entries);
+        auto input    = input_t(document.data(), document.size());
+
+        b.title(title).relative(true);
+        b.unit("parse");
+
+        auto run = [&](const char* name, auto f) {
+            counting_resource resource;
+            tree_t            tree(&resource);
+
+            auto parses = std::size_t(0);
+            b.run(name, [&] {
+                ++parses;
+                return f(resource, tree, input);
+            });
+
+            std::printf("%s: %s: %.2f allocations per parse\n", title, name,
+                        double(resource.allocations) / double(parses));
+        };
+
+        run("new tree", [](counting_resource& resource, tree_t&, const input_t& input) {
+            return parse_new(resource, input);
+        });
+        run("new tree with reserve()",
+            [](counting_resource& resource, tree_t&, const input_t& input) {
+                return parse_reserve(resource, input);
+            });
+        run("reused tree", [](counting_resource&, tree_t& tree, const input_t& input) {
+            return parse_reuse(tree, input);
+        });
+    };
+
+    bench_document("10 entries", 10);
+    bench_document("100 entries", 100);
+    bench_document("1000 entries", 1000);
+    bench_document("10000 entries", 10000);
+}
+
@@ -0,0 +1,115 @@
+// Copyright (C) 2020-2022 Jonathan Müller and lexy contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#define ANKERL_NANOBENCH_IMPLEMENT
+#include <nanobench.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <lexy/dsl/symbol.hpp>
+#include <lexy/input/string_input.hpp>
+
+// The symbol with index I: three chars that make it unique followed by up to five filler chars.
+template <std::size_t I, std::size_t J>
+constexpr auto symbol_char
+    = char('a' + (J == 0 ? I : J == 1 ? I / 26 : J == 2 ? I / (26 * 26) : I + J) % 26);
+
+template <std::size_t I, std::size_t... Js>
+constexpr auto _symbol_string(lexy::_detail::index_sequence<Js...>)
+{
+    return lexy::_detail::type_string<char, symbol_char<I, Js>...>{};
+}
+template <std::size_t I>
+using symbol_string
+    = decltype(_symbol_string<I>(lexy::_detail::make_index_sequence<3 + I % 6>{}));
+
+template <std::size_t I, std::size_t N, typename Table>
+LEXY_CONSTEVAL auto build_table(Table table)
+{
+    static_assert(N % 10 == 0);
+    if constexpr (I == N)
+        return table;
+    else
+        // We map ten symbols at a time to keep the recursion depth low.
+        return build_table<I + 10, N>(table.template map<symbol_string<I + 0>>(int(I + 0))
+                                          .template map<symbol_string<I + 1>>(int(I + 1))
+                                          .template map<symbol_string<I + 2>>(int(I + 2))
+                                          .template map<symbol_string<I + 3>>(int(I + 3))
+                                          .template map<symbol_string<I + 4>>(int(I + 4))
+                                          .template map<symbol_string<I + 5>>(int(I + 5))
+                                          .template map<symbol_string<I + 6>>(int(I + 6))
+                                          .template map<symbol_string<I + 7>>(int(I + 7))
+                                          .template map<symbol_string<I + 8>>(int(I + 8))
+                                          .template map<symbol_string<I + 9>>(int(I + 9)));
+}
+
+constexpr auto table_10   = build_table<0, 10>(lexy::symbol_table<int>);
+constexpr auto table_100  = build_table<0, 100>(lexy::symbol_table<int>);
+constexpr auto table_1000 = build_table<0, 1000>(lexy::symbol_table<int>);
+
+// Every symbol of the table and a string that isn't one for each, in random order.
+template <typename Table>
+std::vector<std::string> make_identifiers(const Table& table)
+{
+    std::vector<std::string> result;
+    for (auto entry : table)
+    {
+        result.push_back(entry.symbol);
+        result.push_back(result.back() + "z");
+    }
+
+    std::shuffle(result.begin(), result.end(), std::mt19937(42));
+    return result;
+}
+
+// Looks the identifier up using parse(), which hashes the entire identifier for big tables.
+template <typename Table>
+int lookup_parse(const Table& table, const std::vector<std::string>& identifiers)
+{
+    auto sum = 0;
+    for (auto& id : identifiers)
+    {
+        auto symbol = table.parse(lexy::string_input(id.data(), id.size()));
+        if (symbol)
+            sum += table[symbol];
+    }
+    return sum;
+}
+
+// Looks the identifier up by matching it against the trie.
+template <typename Table>
+int lookup_trie(const Table& table, const std::vector<std::string>& identifiers)
+{
+    auto sum = 0;
+    for (auto& id : identifiers)
+    {
+        auto reader = lexy::string_input(id.data(), id.size()).reader();
+        auto symbol = table.try_parse(reader);
+        if (symbol && reader.peek() == lexy::default_encoding::eof())
+            sum += table[symbol];
+    }
+    return sum;
+}
+
+int main()
+{
+    ankerl::nanobench::Bench b;
+
+    auto bench_table = [&](const char* title, const auto& table) {
+        auto identifiers = make_identifiers(table);
+
+        b.title(title).relative(true);
+        b.unit("lookup").batch(identifiers.size());
+
+        b.run("try_parse", [&] { return lookup_trie(table, identifiers); });
+        b.run("parse", [&] { return lookup_parse(table, identifiers); });
+    };
+
+    bench_table("10 symbols", table_10);
+    bench_table("100 symbols", table_100);
+    bench_table("1000 symbols", table_1000);
+}
+
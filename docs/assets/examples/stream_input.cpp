@@ -0,0 +1,37 @@
+#include <cstdio>
+
+#include <lexy/action/match.hpp>
+#include <lexy/dsl.hpp>
+#include <lexy/input/stream_input.hpp>
+
+namespace dsl = lexy::dsl;
+
+struct line
+{
+    static constexpr auto rule = dsl::while_(dsl::ascii::print) + dsl::newline;
+};
+
+struct production
+{
+    // The list never backtracks into a line after it has been parsed.
+    // As every line is its own production, errors can still be reported with their location.
+    static constexpr auto rule = dsl::terminator(dsl::eof).list(dsl::p<line> + dsl::commit);
+};
+
+//{
+int main()
+{
+    // Create the input, which reads stdin in chunks of 4KiB.
+    lexy::stream_input input(stdin);
+
+    // Use the input.
+    if (!lexy::match<production>(input))
+    {
+        std::puts("Error!\n");
+        return 1;
+    }
+
+    // Only the current and the previous chunk have been in memory at a time.
+    std::printf("max memory: %zu bytes\n", input.max_live_chunks() * input.chunk_size());
+}
+//}
@@ -4,6 +4,8 @@
 #ifndef LEXY_DETAIL_CODE_POINT_HPP_INCLUDED
 #define LEXY_DETAIL_CODE_POINT_HPP_INCLUDED
 
+#include <lexy/_detail/detect.hpp>
+#include <lexy/_detail/simd.hpp>
 #include <lexy/input/base.hpp>
 
 //=== encoding ===//
@@ -135,6 +137,13 @@ struct cp_result
     typename Reader::iterator end;
 };
 
+// A reader can declare that its input is known to be well-formed UTF-8.
+// Then we only need to decode the code points, not check them.
+template <typename Reader>
+using _detect_validated_utf8 = decltype(Reader::validated_utf8);
+template <typename Reader>
+constexpr bool is_validated_utf8_reader = is_detected<_detect_validated_utf8, Reader>;
+
 template <typename Reader>
 constexpr cp_result<Reader> parse_code_point(Reader reader)
 {
@@ -152,6 +161,39 @@ constexpr cp_result<Reader> parse_code_point(Reader reader)
         else
             return {cp, cp_error::out_of_range, reader.position()};
     }
+    else if constexpr (std::is_same_v<typename Reader::encoding, lexy::utf8_encoding>
+                       && is_validated_utf8_reader<Reader>)
+    {
+        auto first = reader.peek();
+        if (first == Reader::encoding::eof())
+            return {{}, cp_error::eof, reader.position()};
+        reader.bump();
+
+        if (first <= 0x7F)
+            return {first, cp_error::success, reader.position()};
+
+        // We know that the sequence is well-formed, so we only need its length.
+        auto result   = char32_t(first & 0b0000'0111);
+        auto trailing = 3;
+        if (first < 0xE0)
+        {
+            result   = char32_t(first & 0b0001'1111);
+            trailing = 1;
+        }
+        else if (first < 0xF0)
+        {
+            result   = char32_t(first & 0b0000'1111);
+            trailing = 2;
+        }
+
+        for (; trailing > 0; --trailing)
+        {
+            result <<= 6;
+            result |= char32_t(reader.peek() & 0b0011'1111);
+            reader.bump();
+        }
+        return {result, cp_error::success, reader.position()};
+    }
     else if constexpr (std::is_same_v<typename Reader::encoding, lexy::utf8_encoding>)
     {
         constexpr auto payload_lead1 = 0b0111'1111;
@@ -359,5 +401,169 @@ constexpr void recover_code_point(Reader& reader, cp_result<Reader> result)
 }
 } // namespace lexy::_detail
 
+//=== validation ===//
+namespace lexy::_detail
+{
+// Returns the beginning of the first ill-formed code unit sequence in [begin, end), or end.
+inline const LEXY_CHAR8_T* find_invalid_utf8(const LEXY_CHAR8_T* begin,
+                                             const LEXY_CHAR8_T* end) noexcept
+{
+    auto cur = begin;
+
+#if LEXY_HAS_SSSE3
+    {
+        // The lookup algorithm of Keiser and Lemire, "Validating UTF-8 In Less Than One Instruction
+        // Per Byte": the high and low nibble of each byte and the high nibble of its predecessor
+        // are mapped to a set of possible errors, which only remain if all three agree.
+        constexpr unsigned char too_short      = 1 << 0; // 11______ 0_______ or 11______ 11______
+        constexpr unsigned char too_long       = 1 << 1; // 0_______ 10______
+        constexpr unsigned char overlong_3     = 1 << 2; // 11100000 100_____
+        constexpr unsigned char too_large      = 1 << 3; // 11110100 1001____ and above
+        constexpr unsigned char surrogate      = 1 << 4; // 11101101 101_____
+        constexpr unsigned char overlong_2     = 1 << 5; // 1100000_ 10______
+        constexpr unsigned char too_large_1000 = 1 << 6; // 11110101 1000____ and above
+        constexpr unsigned char overlong_4     = 1 << 6; // 11110000 1000____
+        constexpr unsigned char two_conts      = 1 << 7; // 10______ 10______
+        constexpr unsigned char carry          = too_short | too_long | two_conts;
+
+        alignas(16) static constexpr unsigned char byte_1_high_table[16] = {
+            // 0_______: ASCII
+            too_long, too_long, too_long, too_long, too_long, too_long, too_long, too_long,
+            // 10______: continuation
+            two_conts, two_conts, two_conts, two_conts,
+            // 1100____, 1101____: two byte lead
+            too_short | overlong_2, too_short,
+            // 1110____: three byte lead
+            too_short | overlong_3 | surrogate,
+            // 1111____: four byte lead
+            too_short | too_large | too_large_1000 | overlong_4};
+        alignas(16) static constexpr unsigned char byte_1_low_table[16] = {
+            // ____0000, ____0001
+            carry | overlong_3 | overlong_2 | overlong_4, carry | overlong_2,
+            // ____001_
+            carry, carry,
+            // ____0100, ____0101, ____011_
+            carry | too_large, carry | too_large | too_large_1000,
+            carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+            // ____1___
+            carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+            carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+            carry | too_large | too_large_1000, carry | too_large | too_large_1000 | surrogate,
+            carry | too_large | too_large_1000, carry | too_large | too_large_1000};
+        alignas(16) static constexpr unsigned char byte_2_high_table[16] = {
+            // 0_______: ASCII
+            too_short, too_short, too_short, too_short, too_short, too_short, too_short,
+            too_short,
+            // 1000____, 1001____, 101_____: continuation
+            too_long | overlong_2 | two_conts | overlong_3 | too_large_1000 | overlong_4,
+            too_long | overlong_2 | two_conts | overlong_3 | too_large,
+            too_long | overlong_2 | two_conts | surrogate | too_large,
+            too_long | overlong_2 | two_conts | surrogate | too_large,
+            // 11______: lead
+            too_short, too_short, too_short, too_short};
+        // A block ends with an incomplete sequence if one of the last three bytes is a lead byte
+        // that requires more continuation bytes than remain.
+        alignas(16) static constexpr unsigned char incomplete_max[16]
+            = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+               0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xEF, 0xDF, 0xBF};
+
+        auto load = [](const void* ptr) {
+            return _mm_loadu_si128(static_cast<const __m128i*>(ptr));
+        };
+        const auto byte_1_high_lookup = load(byte_1_high_table);
+        const auto byte_1_low_lookup  = load(byte_1_low_table);
+        const auto byte_2_high_lookup = load(byte_2_high_table);
+        const auto incomplete_lookup  = load(incomplete_max);
+        const auto low_nibble         = _mm_set1_epi8(0x0F);
+        const auto high_bit           = _mm_set1_epi8(static_cast<char>(0x80));
+
+        auto error           = _mm_setzero_si128();
+        auto prev_input      = _mm_setzero_si128();
+        auto prev_incomplete = _mm_setzero_si128();
+        for (; end - cur >= 16; cur += 16)
+        {
+            auto input = load(cur);
+            if (_mm_movemask_epi8(input) == 0)
+            {
+                // Only ASCII, so the previous block must not end in the middle of a sequence.
+                error           = _mm_or_si128(error, prev_incomplete);
+                prev_incomplete = _mm_setzero_si128();
+            }
+            else
+            {
+                auto prev1 = _mm_alignr_epi8(input, prev_input, 15);
+                auto special
+                    = _mm_and_si128(_mm_shuffle_epi8(byte_1_high_lookup,
+                                                     _mm_and_si128(_mm_srli_epi16(prev1, 4),
+                                                                   low_nibble)),
+                                    _mm_shuffle_epi8(byte_1_low_lookup,
+                                                     _mm_and_si128(prev1, low_nibble)));
+                special = _mm_and_si128(special,
+                                        _mm_shuffle_epi8(byte_2_high_lookup,
+                                                         _mm_and_si128(_mm_srli_epi16(input, 4),
+                                                                       low_nibble)));
+
+                // The second and third byte after a three or four byte lead must be continuation
+                // bytes, which is exactly where two_conts has to be set.
+                auto prev2     = _mm_alignr_epi8(input, prev_input, 14);
+                auto prev3     = _mm_alignr_epi8(input, prev_input, 13);
+                auto is_third  = _mm_subs_epu8(prev2, _mm_set1_epi8(0xE0 - 0x80));
+                auto is_fourth = _mm_subs_epu8(prev3, _mm_set1_epi8(0xF0 - 0x80));
+                auto must_be_continuation
+                    = _mm_and_si128(_mm_or_si128(is_third, is_fourth), high_bit);
+
+                error = _mm_or_si128(error, _mm_xor_si128(must_be_continuation, special));
+                prev_incomplete = _mm_subs_epu8(input, incomplete_lookup);
+            }
+            prev_input = input;
+
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) != 0xFFFF)
+                // The error is in this block or at the end of the previous one,
+                // the scalar loop below will find its exact position.
+                break;
+        }
+
+        // We need to resume at the beginning of a code point,
+        // which is the lead byte of the last sequence if it is (possibly) incomplete.
+        for (auto n = 1; n <= 3 && n <= cur - begin; ++n)
+        {
+            auto c = cur[-n];
+            if (c >= 0xC0)
+            {
+                cur -= n;
+                break;
+            }
+            else if (c < 0x80)
+                break;
+        }
+    }
+#endif
+
+    while (cur != end)
+    {
+#if LEXY_HAS_SSE2
+        if (end - cur >= 16)
+        {
+            // Skip over ASCII characters.
+            auto mask = unsigned(
+                _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cur))));
+            if (mask == 0)
+            {
+                cur += 16;
+                continue;
+            }
+            cur += countr_zero(mask);
+        }
+#endif
+
+        auto result = parse_code_point(lexy::_range_reader<lexy::utf8_encoding>(cur, end));
+        if (result.error != cp_error::success)
+            return cur;
+        cur = result.end;
+    }
+    return end;
+}
+} // namespace lexy::_detail
+
 #endif // LEXY_DETAIL_CODE_POINT_HPP_INCLUDED
 
@@ -85,6 +85,38 @@ using type_or = std::conditional_t<std::is_void_v<T>, Fallback, T>;
 #    define LEXY_CONSTEVAL constexpr
 #endif
 
+//=== is_constant_evaluated ===//
+#ifndef LEXY_HAS_CONSTANT_EVALUATED
+#    if defined(__has_builtin)
+#        if __has_builtin(__builtin_is_constant_evaluated)
+#            define LEXY_HAS_CONSTANT_EVALUATED 1
+#        endif
+#    endif
+#    if !defined(LEXY_HAS_CONSTANT_EVALUATED) && defined(__GNUC__) && __GNUC__ >= 9
+#        define LEXY_HAS_CONSTANT_EVALUATED 1
+#    endif
+#    if !defined(LEXY_HAS_CONSTANT_EVALUATED) && defined(_MSC_VER) && _MSC_VER >= 1925
+#        define LEXY_HAS_CONSTANT_EVALUATED 1
+#    endif
+#    ifndef LEXY_HAS_CONSTANT_EVALUATED
+#        define LEXY_HAS_CONSTANT_EVALUATED 0
+#    endif
+#endif
+
+namespace lexy::_detail
+{
+// Whether or not we're currently evaluated at compile-time, where intrinsics can't be used.
+// If the compiler can't tell us, we have to conservatively assume that we are.
+constexpr bool is_constant_evaluated() noexcept
+{
+#if LEXY_HAS_CONSTANT_EVALUATED
+    return __builtin_is_constant_evaluated();
+#else
+    return true;
+#endif
+}
+} // namespace lexy::_detail
+
 //=== char8_t ===//
 #ifndef LEXY_HAS_CHAR8_T
 #    if __cpp_char8_t
@@ -167,5 +199,15 @@ using _char8_t = unsigned char;
 
 #endif
 
+//=== stack segments ===//
+#ifndef LEXY_HAS_STACK_SEGMENTS
+// We switch the stack pointer using assembly, which we only have for those targets.
+#    if defined(__linux__) && (defined(__x86_64__) || defined(__aarch64__))
+#        define LEXY_HAS_STACK_SEGMENTS 1
+#    else
+#        define LEXY_HAS_STACK_SEGMENTS 0
+#    endif
+#endif
+
 #endif // LEXY_DETAIL_CONFIG_HPP_INCLUDED
 
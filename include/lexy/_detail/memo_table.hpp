@@ -0,0 +1,140 @@
+// Copyright (C) 2020-2022 Jonathan Müller and lexy contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#ifndef LEXY_DETAIL_MEMO_TABLE_HPP_INCLUDED
+#define LEXY_DETAIL_MEMO_TABLE_HPP_INCLUDED
+
+#include <cstdint>
+#include <cstring>
+#include <lexy/_detail/assert.hpp>
+#include <lexy/_detail/config.hpp>
+#include <new>
+
+namespace lexy::_detail
+{
+// The address identifies the production and the context it is parsed in.
+template <typename Context>
+inline constexpr char memo_key = 0;
+
+// A cache of the results of memoized productions, shared by everything on one thread.
+// It is a direct-mapped table: each key has exactly one slot, where it evicts the previous entry.
+// The entries are only valid during a scope, which is opened for each action.
+class memo_table
+{
+public:
+    struct entry
+    {
+        const void*   key;
+        const void*   begin;
+        const void*   end;
+        std::uint64_t generation;
+        bool          whitespace;
+        bool          success;
+        bool          errors;
+    };
+
+    // The table of the current thread.
+    static memo_table& get() noexcept
+    {
+        static thread_local memo_table table;
+        return table;
+    }
+
+    memo_table() noexcept : _entries(nullptr), _capacity(0), _generation(0), _last_generation(0)
+    {}
+
+    ~memo_table() noexcept
+    {
+        ::operator delete(_entries);
+    }
+
+    memo_table(const memo_table&) = delete;
+    memo_table& operator=(const memo_table&) = delete;
+
+    // Invokes the function in a new scope.
+    // The entries of an enclosing scope are invisible until the new one is left again,
+    // as a nested action might parse a different input that reuses the same addresses.
+    template <typename Fn>
+    static auto scoped(Fn fn)
+    {
+        struct leave_t
+        {
+            memo_table&   table;
+            std::uint64_t generation;
+            ~leave_t() noexcept
+            {
+                table._generation = generation;
+            }
+        };
+
+        // The generation is 64 bit, so it never wraps around and all old entries stay invalid.
+        auto&   table = get();
+        leave_t leave{table, table._generation};
+        table._generation = ++table._last_generation;
+        return fn();
+    }
+
+    // Whether we're inside a scope.
+    bool active() const noexcept
+    {
+        return _generation != 0;
+    }
+
+    // Ensures room for at least that many entries, which drops all existing entries if it grows.
+    void reserve(std::size_t capacity)
+    {
+        if (capacity > _capacity)
+            _allocate(capacity);
+    }
+
+    const entry* lookup(const void* key, const void* begin, bool whitespace) const noexcept
+    {
+        auto& slot = _slot(key, begin);
+        if (slot.generation == _generation && slot.key == key && slot.begin == begin
+            && slot.whitespace == whitespace)
+            return &slot;
+        else
+            return nullptr;
+    }
+
+    void insert(const entry& e) noexcept
+    {
+        auto& slot      = _slot(e.key, e.begin);
+        slot            = e;
+        slot.generation = _generation;
+    }
+
+private:
+    entry& _slot(const void* key, const void* begin) const noexcept
+    {
+        LEXY_PRECONDITION(active() && _capacity > 0);
+        auto hash = std::uint64_t(reinterpret_cast<std::uintptr_t>(begin))
+                    ^ (std::uint64_t(reinterpret_cast<std::uintptr_t>(key)) << 17);
+        hash *= 0x9E3779B97F4A7C15u;
+        return _entries[std::size_t(hash >> 32) & (_capacity - 1)];
+    }
+
+    void _allocate(std::size_t capacity)
+    {
+        // Round up to a power of two, so we can mask the hash.
+        auto new_capacity = std::size_t(1);
+        while (new_capacity < capacity)
+            new_capacity *= 2;
+
+        // Generation zero is never used by a scope, so all entries are invalid.
+        auto new_entries = static_cast<entry*>(::operator new(new_capacity * sizeof(entry)));
+        std::memset(static_cast<void*>(new_entries), 0, new_capacity * sizeof(entry));
+
+        ::operator delete(_entries);
+        _entries  = new_entries;
+        _capacity = new_capacity;
+    }
+
+    entry*        _entries;
+    std::size_t   _capacity;
+    std::uint64_t _generation, _last_generation;
+};
+} // namespace lexy::_detail
+
+#endif // LEXY_DETAIL_MEMO_TABLE_HPP_INCLUDED
+
@@ -0,0 +1,271 @@
+// Copyright (C) 2020-2022 Jonathan Müller and lexy contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#ifndef LEXY_DETAIL_PERFECT_HASH_HPP_INCLUDED
+#define LEXY_DETAIL_PERFECT_HASH_HPP_INCLUDED
+
+#include <cstdint>
+#include <cstring>
+#include <lexy/_detail/config.hpp>
+#include <lexy/_detail/integer_sequence.hpp>
+#include <lexy/_detail/simd.hpp>
+
+namespace lexy::_detail
+{
+constexpr std::uint64_t _hash_mix(std::uint64_t hash) noexcept
+{
+    // The finalizer of MurmurHash3, so every bit of the input affects every bit of the output.
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+// Reads N code units of a byte string as little endian integer.
+// Compilers turn that into a single load.
+template <typename CharT, std::size_t... Idx>
+constexpr std::uint64_t _hash_read(const CharT* str, index_sequence<Idx...>) noexcept
+{
+    return (std::uint64_t(0) | ...
+            | (std::uint64_t(static_cast<unsigned char>(str[Idx])) << (8 * Idx)));
+}
+template <std::size_t N, typename CharT>
+constexpr std::uint64_t _hash_read(const CharT* str) noexcept
+{
+    return _hash_read(str, make_index_sequence<N>{});
+}
+
+template <typename CharT>
+LEXY_FORCE_INLINE constexpr std::uint64_t hash_string(std::uint64_t seed, const CharT* str,
+                                    std::size_t length) noexcept
+{
+    auto hash = seed ^ (length * 0x9e3779b97f4a7c15ull);
+    if constexpr (sizeof(CharT) == 1)
+    {
+        // We hash eight bytes at a time; the last read may overlap with the previous one.
+        // This means that most identifiers only require a single mixing step.
+        auto i = std::size_t(0);
+        for (; i + 8 < length; i += 8)
+            hash = _hash_mix(hash ^ _hash_read<8>(str + i));
+
+        auto last = std::uint64_t(0);
+        if (length >= 8)
+            last = _hash_read<8>(str + length - 8);
+        else if (length >= 4)
+            last = _hash_read<4>(str) << 32 | _hash_read<4>(str + length - 4);
+        else if (length > 0)
+            last = _hash_read<1>(str) << 16 | _hash_read<1>(str + length / 2) << 8
+                   | _hash_read<1>(str + length - 1);
+        return _hash_mix(hash ^ last);
+    }
+    else
+    {
+        // FNV-1a over the code units.
+        for (auto i = std::size_t(0); i != length; ++i)
+        {
+            hash ^= static_cast<std::uint64_t>(static_cast<std::make_unsigned_t<CharT>>(str[i]));
+            hash *= 0x100000001b3ull;
+        }
+        return _hash_mix(hash);
+    }
+}
+
+// For fewer keys, matching a trie is about as fast as computing the hash.
+// As the number of keys grows, the trie gets bigger and its branches less predictable.
+constexpr std::size_t string_perfect_hash_min_key_count = 64;
+
+// A perfect hash over a fixed set of strings, built at compile-time using hash and displace:
+// the hash of a key selects a bucket, and the displacement stored for the bucket selects the slot
+// of the key. Displacements are chosen, largest bucket first, such that no two keys share a slot.
+// Looking up a string is then a single hash computation followed by a single comparison.
+template <typename CharT, std::size_t KeyCount>
+struct string_perfect_hash
+{
+    static_assert(KeyCount > 0);
+
+    static constexpr auto bucket_count = (KeyCount + 3) / 4;
+    static constexpr auto slot_count   = [] {
+        auto result = std::size_t(1);
+        while (result < 2 * KeyCount)
+            result *= 2;
+        return result;
+    }();
+    static constexpr auto no_key = KeyCount;
+
+    std::uint64_t seed;
+    std::size_t   displacement[bucket_count];
+    // Index of the key that hashes to the slot, or no_key.
+    std::size_t slot[slot_count];
+
+    const CharT* key[KeyCount];
+    std::size_t  key_length[KeyCount];
+
+    // If the same string is given multiple times, the last index is used.
+    LEXY_CONSTEVAL string_perfect_hash(const CharT* const* keys, const std::size_t* lengths)
+    : seed(0), displacement{}, slot{}, key{}, key_length{}
+    {
+        for (auto i = std::size_t(0); i != KeyCount; ++i)
+        {
+            key[i]        = keys[i];
+            key_length[i] = lengths[i];
+        }
+
+        // The first seed almost always works; the next one is tried if it doesn't.
+        while (!_try_build())
+            ++seed;
+    }
+
+    // Returns the index of the key equal to the string, or no_key.
+    constexpr std::size_t find(const CharT* str, std::size_t length) const noexcept
+    {
+        auto hash = hash_string(seed, str, length);
+        auto idx  = slot[_slot(hash, displacement[_bucket(hash)])];
+        if (idx == no_key || key_length[idx] != length)
+            return no_key;
+
+        if constexpr (sizeof(CharT) == 1)
+        {
+            // Identifiers are short, so comparing the same words we've hashed is faster than
+            // calling memcmp().
+            auto cur = key[idx];
+            auto i   = std::size_t(0);
+            for (; i + 8 < length; i += 8)
+                if (_hash_read<8>(cur + i) != _hash_read<8>(str + i))
+                    return no_key;
+
+            if (length >= 8)
+                return _hash_read<8>(cur + length - 8) == _hash_read<8>(str + length - 8) ? idx
+                                                                                          : no_key;
+            for (; i != length; ++i)
+                if (cur[i] != str[i])
+                    return no_key;
+            return idx;
+        }
+        else
+        {
+            if (!is_constant_evaluated())
+                return std::memcmp(key[idx], str, length * sizeof(CharT)) == 0 ? idx : no_key;
+
+            for (auto i = std::size_t(0); i != length; ++i)
+                if (key[idx][i] != str[i])
+                    return no_key;
+            return idx;
+        }
+    }
+
+private:
+    static constexpr std::size_t _bucket(std::uint64_t hash) noexcept
+    {
+        // Maps the upper half of the hash to [0, bucket_count) without a division.
+        return std::size_t(((hash >> 32) * bucket_count) >> 32);
+    }
+
+    static constexpr std::size_t _slot(std::uint64_t hash, std::size_t displacement) noexcept
+    {
+        // The offset is given by the lower half, which is independent of the bucket.
+        // The stride is odd, so the displacements visit every slot.
+        auto offset = hash & 0xFFFF'FFFFull;
+        auto stride = (hash >> 32) | 1;
+        return std::size_t((offset + displacement * stride) & (slot_count - 1));
+    }
+
+    LEXY_CONSTEVAL bool _equal(std::size_t lhs, std::size_t rhs) const
+    {
+        if (key_length[lhs] != key_length[rhs])
+            return false;
+        for (auto i = std::size_t(0); i != key_length[lhs]; ++i)
+            if (key[lhs][i] != key[rhs][i])
+                return false;
+        return true;
+    }
+
+    LEXY_CONSTEVAL bool _try_build()
+    {
+        std::uint64_t hash[KeyCount] = {};
+        for (auto i = std::size_t(0); i != KeyCount; ++i)
+            hash[i] = hash_string(seed, key[i], key_length[i]);
+
+        // Sort the keys by bucket.
+        std::size_t bucket_begin[bucket_count + 1] = {};
+        for (auto i = std::size_t(0); i != KeyCount; ++i)
+            ++bucket_begin[_bucket(hash[i]) + 1];
+        for (auto b = std::size_t(0); b != bucket_count; ++b)
+            bucket_begin[b + 1] += bucket_begin[b];
+
+        std::size_t bucket_end[bucket_count] = {};
+        for (auto b = std::size_t(0); b != bucket_count; ++b)
+            bucket_end[b] = bucket_begin[b];
+
+        std::size_t order[KeyCount] = {};
+        for (auto i = std::size_t(0); i != KeyCount; ++i)
+            order[bucket_end[_bucket(hash[i])]++] = i;
+
+        // Duplicated keys are necessarily in the same bucket; only keep the last one.
+        auto max_bucket_size = std::size_t(0);
+        for (auto b = std::size_t(0); b != bucket_count; ++b)
+        {
+            for (auto pos = bucket_begin[b]; pos != bucket_end[b]; ++pos)
+                for (auto next = pos + 1; next != bucket_end[b]; ++next)
+                    if (hash[order[pos]] == hash[order[next]] && _equal(order[pos], order[next]))
+                    {
+                        order[pos] = no_key;
+                        break;
+                    }
+
+            if (bucket_end[b] - bucket_begin[b] > max_bucket_size)
+                max_bucket_size = bucket_end[b] - bucket_begin[b];
+        }
+
+        for (auto& s : slot)
+            s = no_key;
+
+        // Place the buckets, starting with the biggest ones as they're the hardest to place.
+        for (auto size = max_bucket_size; size > 0; --size)
+            for (auto b = std::size_t(0); b != bucket_count; ++b)
+            {
+                if (bucket_end[b] - bucket_begin[b] != size)
+                    continue;
+
+                auto placed = false;
+                for (auto d = std::size_t(0); d != slot_count && !placed; ++d)
+                {
+                    // Tentatively place every key; this also detects collisions inside the bucket.
+                    auto pos = bucket_begin[b];
+                    for (; pos != bucket_end[b]; ++pos)
+                    {
+                        if (order[pos] == no_key)
+                            continue;
+
+                        auto& s = slot[_slot(hash[order[pos]], d)];
+                        if (s != no_key)
+                            break;
+                        s = order[pos];
+                    }
+
+                    if (pos == bucket_end[b])
+                    {
+                        displacement[b] = d;
+                        placed          = true;
+                    }
+                    else
+                    {
+                        // Undo the keys we've already placed.
+                        for (auto undo = bucket_begin[b]; undo != pos; ++undo)
+                            if (order[undo] != no_key)
+                                slot[_slot(hash[order[undo]], d)] = no_key;
+                    }
+                }
+
+                if (!placed)
+                    return false;
+            }
+
+        return true;
+    }
+};
+} // namespace lexy::_detail
+
+#endif // LEXY_DETAIL_PERFECT_HASH_HPP_INCLUDED
+
@@ -0,0 +1,141 @@
+// Copyright (C) 2020-2022 Jonathan Müller and lexy contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#ifndef LEXY_DETAIL_SCRATCH_STACK_HPP_INCLUDED
+#define LEXY_DETAIL_SCRATCH_STACK_HPP_INCLUDED
+
+#include <lexy/_detail/assert.hpp>
+#include <lexy/_detail/config.hpp>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace lexy::_detail
+{
+// A stack of objects that is shared by everything that needs temporary storage on one thread.
+// Users push their objects on top and pop them again before anybody below them continues.
+// The memory is kept around, so after a while, no more allocations are necessary.
+template <typename T>
+class scratch_stack
+{
+    static constexpr std::size_t initial_capacity = 64;
+
+public:
+    // The stack of the current thread.
+    static scratch_stack& get() noexcept
+    {
+        static thread_local scratch_stack stack;
+        return stack;
+    }
+
+    scratch_stack() noexcept : _data(nullptr), _size(0), _capacity(0) {}
+
+    ~scratch_stack() noexcept
+    {
+        pop_to(0);
+        deallocate(_data);
+    }
+
+    scratch_stack(const scratch_stack&) = delete;
+    scratch_stack& operator=(const scratch_stack&) = delete;
+
+    std::size_t size() const noexcept
+    {
+        return _size;
+    }
+
+    T& operator[](std::size_t idx) noexcept
+    {
+        LEXY_PRECONDITION(idx < _size);
+        return _data[idx];
+    }
+
+    template <typename... Args>
+    void emplace(Args&&... args)
+    {
+        if (_size == _capacity)
+            grow();
+
+        // Construct it the way a container's emplace() would.
+        construct(_data + _size, LEXY_FWD(args)...);
+        ++_size;
+    }
+
+    // Destroys all objects starting at the given size.
+    void pop_to(std::size_t size) noexcept
+    {
+        LEXY_PRECONDITION(size <= _size);
+        while (_size > size)
+        {
+            --_size;
+            _data[_size].~T();
+        }
+    }
+
+private:
+    static T* allocate(std::size_t capacity)
+    {
+        if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            return static_cast<T*>(
+                ::operator new(capacity * sizeof(T), std::align_val_t(alignof(T))));
+        else
+            return static_cast<T*>(::operator new(capacity * sizeof(T)));
+    }
+    static void deallocate(T* data) noexcept
+    {
+        if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            ::operator delete(data, std::align_val_t(alignof(T)));
+        else
+            ::operator delete(data);
+    }
+
+    template <typename... Args>
+    static void construct(T* ptr, Args&&... args)
+    {
+        std::allocator<T> alloc;
+        std::allocator_traits<std::allocator<T>>::construct(alloc, ptr, LEXY_FWD(args)...);
+    }
+
+    void grow()
+    {
+        // If a constructor throws, we destroy the new block and leave the old one unchanged.
+        struct rollback_t
+        {
+            T*          data;
+            std::size_t size;
+
+            ~rollback_t() noexcept
+            {
+                if (data == nullptr)
+                    return;
+
+                while (size > 0)
+                    data[--size].~T();
+                deallocate(data);
+            }
+        };
+
+        auto new_capacity = _capacity == 0 ? initial_capacity : 2 * _capacity;
+        rollback_t rollback{allocate(new_capacity), 0};
+
+        // Like std::vector, we only move the objects if that can't throw.
+        for (; rollback.size != _size; ++rollback.size)
+            construct(rollback.data + rollback.size, std::move_if_noexcept(_data[rollback.size]));
+
+        auto new_data = rollback.data;
+        rollback.data = nullptr;
+
+        for (auto i = std::size_t(0); i != _size; ++i)
+            _data[i].~T();
+        deallocate(_data);
+
+        _data     = new_data;
+        _capacity = new_capacity;
+    }
+
+    T*          _data;
+    std::size_t _size, _capacity;
+};
+} // namespace lexy::_detail
+
+#endif // LEXY_DETAIL_SCRATCH_STACK_HPP_INCLUDED
@@ -0,0 +1,165 @@
+// Copyright (C) 2020-2022 Jonathan Müller and lexy contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#ifndef LEXY_DETAIL_SIMD_HPP_INCLUDED
+#define LEXY_DETAIL_SIMD_HPP_INCLUDED
+
+#include <cstdint>
+#include <cstring>
+#include <lexy/_detail/config.hpp>
+
+//=== instruction sets ===//
+#ifndef LEXY_HAS_SSE2
+#    if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#        define LEXY_HAS_SSE2 1
+#    else
+#        define LEXY_HAS_SSE2 0
+#    endif
+#endif
+
+#ifndef LEXY_HAS_SSSE3
+#    if defined(__SSSE3__) || defined(__AVX2__)
+#        define LEXY_HAS_SSSE3 1
+#    else
+#        define LEXY_HAS_SSSE3 0
+#    endif
+#endif
+
+#ifndef LEXY_HAS_AVX2
+#    if defined(__AVX2__)
+#        define LEXY_HAS_AVX2 1
+#    else
+#        define LEXY_HAS_AVX2 0
+#    endif
+#endif
+
+#if LEXY_HAS_AVX2
+#    include <immintrin.h>
+#elif LEXY_HAS_SSSE3
+#    include <tmmintrin.h>
+#elif LEXY_HAS_SSE2
+#    include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#    include <intrin.h>
+#endif
+
+namespace lexy::_detail
+{
+// Returns the index of the lowest set bit; mask must not be zero.
+inline unsigned countr_zero(unsigned mask) noexcept
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return unsigned(index);
+#else
+    return unsigned(__builtin_ctz(mask));
+#endif
+}
+inline unsigned countr_zero64(std::uint64_t mask) noexcept
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return unsigned(index);
+#else
+    return unsigned(__builtin_ctzll(mask));
+#endif
+}
+
+// Returns the number of set bits.
+inline unsigned popcount64(std::uint64_t mask) noexcept
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    return unsigned(__popcnt64(mask));
+#else
+    return unsigned(__builtin_popcountll(mask));
+#endif
+}
+} // namespace lexy::_detail
+
+//=== byte swap ===//
+namespace lexy::_detail
+{
+inline std::uint16_t byte_swap(std::uint16_t value) noexcept
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    return _byteswap_ushort(value);
+#else
+    return __builtin_bswap16(value);
+#endif
+}
+inline std::uint32_t byte_swap(std::uint32_t value) noexcept
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    return std::uint32_t(_byteswap_ulong(value));
+#else
+    return __builtin_bswap32(value);
+#endif
+}
+
+// Copies count values of size Size from src to dest, reversing the order of the bytes of each.
+template <std::size_t Size>
+void byte_swap_copy(void* dest, const void* src, std::size_t count) noexcept
+{
+    static_assert(Size == 2 || Size == 4);
+    auto out  = static_cast<unsigned char*>(dest);
+    auto in   = static_cast<const unsigned char*>(src);
+    auto size = count * Size;
+    auto i    = std::size_t(0);
+
+#if LEXY_HAS_AVX2
+    {
+        // The shuffle works on each 128 bit lane separately, so the mask is repeated.
+        const auto mask = Size == 2 ? _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12,
+                                                       15, 14, 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11,
+                                                       10, 13, 12, 15, 14)
+                                    : _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15,
+                                                       14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10,
+                                                       9, 8, 15, 14, 13, 12);
+        for (; i + 32 <= size; i += 32)
+        {
+            auto value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+                                _mm256_shuffle_epi8(value, mask));
+        }
+    }
+#endif
+#if LEXY_HAS_SSSE3
+    {
+        const auto mask
+            = Size == 2 ? _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14)
+                        : _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+        for (; i + 16 <= size; i += 16)
+        {
+            auto value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_shuffle_epi8(value, mask));
+        }
+    }
+#elif LEXY_HAS_SSE2
+    for (; i + 16 <= size; i += 16)
+    {
+        auto value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        if constexpr (Size == 4)
+            // Swap the two 16 bit halves of each value, then swap the bytes of each half.
+            value = _mm_shufflehi_epi16(_mm_shufflelo_epi16(value, 0xB1), 0xB1);
+        value = _mm_or_si128(_mm_slli_epi16(value, 8), _mm_srli_epi16(value, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), value);
+    }
+#endif
+
+    using uint_t = std::conditional_t<Size == 2, std::uint16_t, std::uint32_t>;
+    for (; i != size; i += Size)
+    {
+        uint_t value;
+        std::memcpy(&value, in + i, Size);
+        value = byte_swap(value);
+        std::memcpy(out + i, &value, Size);
+    }
+}
+} // namespace lexy::_detail
+
+#endif // LEXY_DETAIL_SIMD_HPP_INCLUDED
+
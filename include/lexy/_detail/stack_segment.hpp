@@ -0,0 +1,287 @@
+// Copyright (C) 2020-2022 Jonathan Müller and lexy contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#ifndef LEXY_DETAIL_STACK_SEGMENT_HPP_INCLUDED
+#define LEXY_DETAIL_STACK_SEGMENT_HPP_INCLUDED
+
+#include <cstdint>
+#include <cstdlib>
+#include <lexy/_detail/assert.hpp>
+#include <lexy/_detail/config.hpp>
+
+#if LEXY_HAS_STACK_SEGMENTS
+#    include <exception>
+#    include <new>
+#    include <sys/mman.h>
+#    include <unistd.h>
+#endif
+
+#if LEXY_HAS_STACK_SEGMENTS
+// Calls fn(arg) with the stack pointer set to stack_top, then switches back.
+// Unlike swapcontext(), this doesn't save the signal mask, so it doesn't need a system call.
+// It is emitted into a COMDAT section, so every translation unit can define it.
+extern "C" void lexy_detail_call_on_stack(void* arg, void (*fn)(void*), void* stack_top);
+
+#    if defined(__x86_64__)
+asm(".pushsection .text.lexy_detail_call_on_stack,\"axG\",@progbits,"
+    "lexy_detail_call_on_stack,comdat\n"
+    ".weak lexy_detail_call_on_stack\n"
+    ".hidden lexy_detail_call_on_stack\n"
+    ".type lexy_detail_call_on_stack,@function\n"
+    "lexy_detail_call_on_stack:\n"
+    ".cfi_startproc\n"
+    "    pushq %rbp\n"
+    ".cfi_def_cfa_offset 16\n"
+    ".cfi_offset %rbp, -16\n"
+    "    movq %rsp, %rbp\n"
+    ".cfi_def_cfa_register %rbp\n"
+    "    movq %rdx, %rsp\n"
+    "    callq *%rsi\n"
+    "    movq %rbp, %rsp\n"
+    "    popq %rbp\n"
+    ".cfi_def_cfa %rsp, 8\n"
+    "    retq\n"
+    ".cfi_endproc\n"
+    ".size lexy_detail_call_on_stack, .-lexy_detail_call_on_stack\n"
+    ".popsection\n");
+#    elif defined(__aarch64__)
+asm(".pushsection .text.lexy_detail_call_on_stack,\"axG\",@progbits,"
+    "lexy_detail_call_on_stack,comdat\n"
+    ".weak lexy_detail_call_on_stack\n"
+    ".hidden lexy_detail_call_on_stack\n"
+    ".type lexy_detail_call_on_stack,%function\n"
+    ".p2align 2\n"
+    "lexy_detail_call_on_stack:\n"
+    ".cfi_startproc\n"
+    "    stp x29, x30, [sp, #-16]!\n"
+    ".cfi_def_cfa_offset 16\n"
+    ".cfi_offset x29, -16\n"
+    ".cfi_offset x30, -8\n"
+    "    mov x29, sp\n"
+    ".cfi_def_cfa_register x29\n"
+    "    mov sp, x2\n"
+    "    blr x1\n"
+    "    mov sp, x29\n"
+    ".cfi_def_cfa sp, 16\n"
+    "    ldp x29, x30, [sp], #16\n"
+    ".cfi_def_cfa_offset 0\n"
+    "    ret\n"
+    ".cfi_endproc\n"
+    ".size lexy_detail_call_on_stack, .-lexy_detail_call_on_stack\n"
+    ".popsection\n");
+#    endif
+
+namespace lexy::_detail
+{
+// Stacks that a deep recursion continues on, shared by everything on one thread.
+// Segments are only ever used in a LIFO manner and kept around, so later parses reuse them.
+class stack_segments
+{
+public:
+    // How much of the native stack a parse may use before it switches to a segment.
+    static constexpr std::size_t native_stack_reserve = 64 * 1024;
+
+    // The segments of the current thread.
+    static stack_segments& get() noexcept
+    {
+        static thread_local stack_segments segments;
+        return segments;
+    }
+
+    stack_segments() noexcept : _first(nullptr), _cur(nullptr) {}
+
+    ~stack_segments() noexcept
+    {
+        LEXY_PRECONDITION(_cur == nullptr);
+        while (_first != nullptr)
+        {
+            auto next = _first->next;
+            _first->deallocate();
+            delete _first;
+            _first = next;
+        }
+    }
+
+    stack_segments(const stack_segments&) = delete;
+    stack_segments& operator=(const stack_segments&) = delete;
+
+    // The number of segments that have been allocated.
+    std::size_t segment_count() const noexcept
+    {
+        auto count = std::size_t(0);
+        for (auto cur = _first; cur != nullptr; cur = cur->next)
+            ++count;
+        return count;
+    }
+
+    // Invokes the function, on a new segment if the current stack might not have enough room left.
+    // watermark is the address of a local variable at the beginning of the parse.
+    // If the segment can't be allocated, throws std::bad_alloc, or, without exceptions, returns the
+    // result of out_of_memory() instead.
+    template <typename Fn, typename OutOfMemory>
+    bool call(const void* watermark, std::size_t segment_size, Fn& fn, OutOfMemory out_of_memory)
+    {
+        if (!_needs_segment(watermark))
+            return fn();
+
+        auto seg = _next_segment(segment_size);
+        if (seg == nullptr)
+            // We can't continue on the current stack either, as it is about to overflow.
+            return out_of_memory();
+
+        auto invoke = [](void* data) { return (*static_cast<Fn*>(data))(); };
+        return _call_on_segment(seg, invoke, &fn);
+    }
+
+private:
+    struct segment
+    {
+        segment*    next   = nullptr;
+        segment*    prev   = nullptr;
+        char*       memory = nullptr; // the mapping, begins with the guard page
+        char*       stack  = nullptr; // the usable stack, after the guard page
+        std::size_t size   = 0;
+
+        bool (*fn)(void*) = nullptr;
+        void*              data   = nullptr;
+        bool               result = false;
+        std::exception_ptr exception;
+
+        static std::size_t page_size() noexcept
+        {
+            return static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        }
+
+        // Returns false if we're out of memory.
+        bool allocate(std::size_t stack_size) noexcept
+        {
+            auto page = page_size();
+            stack_size = (stack_size + page - 1) / page * page;
+
+            auto new_memory = ::mmap(nullptr, stack_size + page, PROT_READ | PROT_WRITE,
+                                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1,
+                                     0);
+            if (new_memory == MAP_FAILED)
+                return false;
+            // An overflow now crashes like the native stack, instead of corrupting memory.
+            if (::mprotect(new_memory, page, PROT_NONE) != 0)
+            {
+                ::munmap(new_memory, stack_size + page);
+                return false;
+            }
+
+            deallocate();
+            memory = static_cast<char*>(new_memory);
+            stack  = memory + page;
+            size   = stack_size;
+            return true;
+        }
+
+        void deallocate() noexcept
+        {
+            if (memory == nullptr)
+                return;
+
+            auto result = ::munmap(memory, size + page_size());
+            LEXY_PRECONDITION(result == 0);
+            (void)result;
+            memory = stack = nullptr;
+            size           = 0;
+        }
+    };
+
+    bool _needs_segment(const void* watermark) const noexcept
+    {
+        // The stack grows downwards, so we compare how far we are below the mark.
+        char marker;
+        auto pos = reinterpret_cast<std::uintptr_t>(&marker);
+
+        if (_cur == nullptr)
+        {
+            // We're still on the native stack, where the parse has begun at the watermark.
+            auto begin = reinterpret_cast<std::uintptr_t>(watermark);
+            return pos < begin && begin - pos > native_stack_reserve;
+        }
+
+        // Whatever lies below us is still available.
+        // We keep a quarter of the segment in reserve for everything happening between two checks.
+        auto stack = reinterpret_cast<std::uintptr_t>(_cur->stack);
+        if (pos < stack || pos >= stack + _cur->size)
+            return true;
+        return pos - stack < _cur->size / 4;
+    }
+
+    segment* _next_segment(std::size_t segment_size)
+    {
+        auto seg = _cur == nullptr ? _first : _cur->next;
+        if (seg == nullptr)
+        {
+            seg = new (std::nothrow) segment();
+            if (seg == nullptr)
+                return _out_of_memory();
+
+            if (_cur == nullptr)
+                _first = seg;
+            else
+                _cur->next = seg;
+        }
+        if (seg->size < segment_size && !seg->allocate(segment_size))
+            return _out_of_memory();
+
+        return seg;
+    }
+
+    static segment* _out_of_memory()
+    {
+#    if defined(__cpp_exceptions)
+        throw std::bad_alloc();
+#    else
+        return nullptr;
+#    endif
+    }
+
+    bool _call_on_segment(segment* seg, bool (*fn)(void*), void* data)
+    {
+        seg->prev = _cur;
+        seg->fn   = fn;
+        seg->data = data;
+
+        // The end of the segment is page aligned, so the stack is properly aligned for the call.
+        _cur = seg;
+        lexy_detail_call_on_stack(seg, &_entry, seg->stack + seg->size);
+        _cur = seg->prev;
+
+        if (seg->exception)
+        {
+            auto exception = seg->exception;
+            seg->exception = nullptr;
+            std::rethrow_exception(exception);
+        }
+        return seg->result;
+    }
+
+    static void _entry(void* data)
+    {
+        auto seg = static_cast<segment*>(data);
+#    if defined(__cpp_exceptions)
+        try
+        {
+            seg->result = seg->fn(seg->data);
+        }
+        catch (...)
+        {
+            // An exception can't unwind past the start of the segment.
+            seg->exception = std::current_exception();
+        }
+#    else
+        seg->result = seg->fn(seg->data);
+#    endif
+    }
+
+    segment* _first;
+    segment* _cur;
+};
+} // namespace lexy::_detail
+#endif
+
+#endif // LEXY_DETAIL_STACK_SEGMENT_HPP_INCLUDED
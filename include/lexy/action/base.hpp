@@ -4,8 +4,10 @@
 #ifndef LEXY_ACTION_BASE_HPP_INCLUDED
 #define LEXY_ACTION_BASE_HPP_INCLUDED
 
+#include <atomic>
 #include <lexy/_detail/config.hpp>
 #include <lexy/_detail/lazy_init.hpp>
+#include <lexy/_detail/memo_table.hpp>
 #include <lexy/_detail/type_name.hpp>
 #include <lexy/callback/noop.hpp>
 #include <lexy/dsl/base.hpp>
@@ -16,26 +18,73 @@ namespace lexy
 {
 namespace _detail
 {
+    // The number of context variables that can be found without walking the list.
+    constexpr std::size_t parse_context_var_slots = 8;
+
+    // One more than the index of an id, or zero if it doesn't have one yet.
+    template <typename Id>
+    inline std::atomic<std::size_t> parse_context_var_index_storage(0);
+
+    inline std::size_t assign_parse_context_var_index(std::atomic<std::size_t>& storage) noexcept
+    {
+        static std::atomic<std::size_t> next(0);
+
+        // If another thread assigns one first, we use its index instead.
+        auto index    = std::size_t(0);
+        auto assigned = next.fetch_add(1) + 1;
+        if (storage.compare_exchange_strong(index, assigned))
+            return assigned;
+        else
+            return index;
+    }
+
+    // Each id gets a distinct index the first time a variable with it is used.
+    // If it is less than parse_context_var_slots, the variable is stored in that slot.
+    template <typename Id>
+    std::size_t parse_context_var_index() noexcept
+    {
+        auto& storage = parse_context_var_index_storage<Id>;
+        auto  index   = storage.load(std::memory_order_relaxed);
+        if (index == 0)
+            index = assign_parse_context_var_index(storage);
+        return index - 1;
+    }
+
     struct parse_context_var_base
     {
-        const void*             id;
+        const void* id;
+        std::size_t slot;
+        // The previous variable in our slot, or in the list if we don't have one.
         parse_context_var_base* next;
 
-        constexpr parse_context_var_base(const void* id) : id(id), next(nullptr) {}
+        constexpr parse_context_var_base(const void* id, std::size_t slot)
+        : id(id), slot(slot), next(nullptr)
+        {}
 
         template <typename Context>
         constexpr void link(Context& context)
         {
-            auto cb  = context.control_block;
-            next     = cb->vars;
-            cb->vars = this;
+            auto cb = context.control_block;
+            if (slot < parse_context_var_slots)
+            {
+                next                = cb->var_slots[slot];
+                cb->var_slots[slot] = this;
+            }
+            else
+            {
+                next     = cb->vars;
+                cb->vars = this;
+            }
         }
 
         template <typename Context>
         constexpr void unlink(Context& context)
         {
-            auto cb  = context.control_block;
-            cb->vars = next;
+            auto cb = context.control_block;
+            if (slot < parse_context_var_slots)
+                cb->var_slots[slot] = next;
+            else
+                cb->vars = next;
         }
     };
 
@@ -46,13 +95,28 @@ namespace _detail
 
         T value;
 
+        // The index can't be assigned during constant evaluation, so we only use the list then.
         explicit constexpr parse_context_var(T&& value)
-        : parse_context_var_base(&type_id), value(LEXY_MOV(value))
+        : parse_context_var_base(&type_id, is_constant_evaluated() ? parse_context_var_slots
+                                                                   : parse_context_var_index<Id>()),
+          value(LEXY_MOV(value))
         {}
 
         template <typename ControlBlock>
         static constexpr T& get(const ControlBlock* cb)
         {
+            if (!is_constant_evaluated())
+            {
+                // The variable has been created before, so the id already has its index.
+                auto slot = parse_context_var_index_storage<Id>.load(std::memory_order_relaxed) - 1;
+                if (slot < parse_context_var_slots)
+                {
+                    auto var = cb->var_slots[slot];
+                    LEXY_ASSERT(var != nullptr, "context variable hasn't been created");
+                    return static_cast<parse_context_var*>(var)->value;
+                }
+            }
+
             for (auto cur = cb->vars; cur; cur = cur->next)
                 if (cur->id == &type_id)
                     return static_cast<parse_context_var*>(cur)->value;
@@ -68,17 +132,36 @@ namespace _detail
         LEXY_EMPTY_MEMBER Handler parse_handler;
         const State*              parse_state;
 
+        // The variables without a slot are kept in a list.
+        parse_context_var_base* var_slots[parse_context_var_slots];
         parse_context_var_base* vars;
 
         int  cur_depth, max_depth;
         bool enable_whitespace_skipping;
 
+        // If non-zero, recursion continues on stack segments of that size once the native stack
+        // has grown too far beyond the watermark.
+        std::size_t stack_segment_size;
+        const void* stack_watermark;
+
         constexpr parse_context_control_block(Handler&& handler, const State* state,
                                               std::size_t max_depth)
         : parse_handler(LEXY_MOV(handler)), parse_state(state), //
-          vars(nullptr),                                        //
-          cur_depth(0), max_depth(static_cast<int>(max_depth)), enable_whitespace_skipping(true)
+          var_slots{}, vars(nullptr),                           //
+          cur_depth(0), max_depth(static_cast<int>(max_depth)), enable_whitespace_skipping(true),
+          stack_segment_size(0), stack_watermark(nullptr)
         {}
+
+        constexpr bool has_vars() const
+        {
+            if (vars != nullptr)
+                return true;
+
+            for (auto var : var_slots)
+                if (var != nullptr)
+                    return true;
+            return false;
+        }
     };
 } // namespace _detail
 
@@ -170,14 +253,21 @@ namespace lexy
 {
 constexpr void* no_parse_state = nullptr;
 
-template <typename Production, typename Handler, typename State, typename Reader>
-constexpr auto do_action(Handler&& handler, const State* state, Reader& reader)
+// Like do_action(), but with the given whitespace and recursion limit.
+// This allows parsing a production as if it were nested in another one.
+template <typename Production, typename WhitespaceProduction, typename Handler, typename State,
+          typename Reader>
+constexpr auto _do_action(Handler&& handler, const State* state, Reader& reader,
+                          std::size_t max_depth)
 {
     static_assert(!std::is_reference_v<Handler>, "need to move handler in");
 
-    _detail::parse_context_control_block control_block(LEXY_MOV(handler), state,
-                                                       max_recursion_depth<Production>());
-    _pc<Handler, State, Production>      context(&control_block);
+    using context_t = _pc<Handler, State, Production, WhitespaceProduction>;
+    _detail::parse_context_control_block control_block(LEXY_MOV(handler), state, max_depth);
+    control_block.stack_segment_size = stack_segment_size<Production>();
+    char stack_watermark             = 0;
+    control_block.stack_watermark    = &stack_watermark;
+    context_t context(&control_block);
 
     context.on(parse_events::production_start{}, reader.position());
 
@@ -201,6 +291,23 @@ constexpr auto do_action(Handler&& handler, const State* state, Reader& reader)
     else
         return LEXY_MOV(control_block.parse_handler).template get_result<value_type>(rule_result);
 }
+
+template <typename Production, typename Handler, typename State, typename Reader>
+constexpr auto do_action(Handler&& handler, const State* state, Reader& reader)
+{
+    if constexpr (_has_memoized_production<Production>)
+    {
+        // Memoized productions share their results with all lookahead during the action.
+        if (!_detail::is_constant_evaluated())
+            return _detail::memo_table::scoped([&] {
+                return _do_action<Production, _whitespace_production_of<Production>>(
+                    LEXY_MOV(handler), state, reader, max_recursion_depth<Production>());
+            });
+    }
+
+    return _do_action<Production, _whitespace_production_of<Production>>(
+        LEXY_MOV(handler), state, reader, max_recursion_depth<Production>());
+}
 } // namespace lexy
 
 //=== value callback ===//
@@ -6,6 +6,12 @@
 
 #include <lexy/action/base.hpp>
 
+namespace lexyd
+{
+template <typename Production>
+struct _prd;
+} // namespace lexyd
+
 namespace lexy
 {
 class match_handler
@@ -40,6 +46,10 @@ public:
 
 private:
     bool _failed;
+
+    // Memoized productions need to cache and restore the errors.
+    template <typename Production>
+    friend struct lexyd::_prd;
 };
 
 template <typename Production, typename Input>
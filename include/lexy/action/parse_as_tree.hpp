@@ -6,6 +6,7 @@
 
 #include <lexy/action/base.hpp>
 #include <lexy/action/validate.hpp>
+#include <lexy/compact_parse_tree.hpp>
 #include <lexy/parse_tree.hpp>
 
 namespace lexy
@@ -13,9 +14,14 @@ namespace lexy
 template <typename Tree, typename Input, typename ErrorCallback>
 class parse_tree_handler
 {
+    template <typename Builder>
+    using _detect_overflowed = decltype(LEXY_DECLVAL(const Builder&).overflowed());
+    template <typename Builder>
+    using _detect_had_errors = decltype(LEXY_DECLVAL(Builder&).set_had_errors());
+
 public:
     explicit parse_tree_handler(Tree& tree, const Input& input, const ErrorCallback& cb)
-    : _tree(&tree), _depth(0), _validate(input, cb)
+    : _tree(&tree), _depth(0), _overflow(false), _had_errors(false), _validate(input, cb)
     {}
 
     template <typename Production>
@@ -27,17 +33,47 @@ public:
         void on(parse_tree_handler& handler, parse_events::production_start ev, iterator pos)
         {
             if (handler._depth++ == 0)
-                handler._builder.emplace(LEXY_MOV(*handler._tree), Production{});
+            {
+                using builder = typename Tree::builder;
+                if constexpr (std::is_constructible_v<builder, Tree&&, Production, iterator>)
+                    // The builder wants to know where the input begins.
+                    handler._builder.emplace(LEXY_MOV(*handler._tree), Production{}, pos);
+                else
+                    handler._builder.emplace(LEXY_MOV(*handler._tree), Production{});
+            }
             else
                 _marker = handler._builder->start_production(Production{});
 
             _validate.on(handler._validate, ev, pos);
         }
 
-        void on(parse_tree_handler& handler, parse_events::production_finish, iterator)
+        void on(parse_tree_handler& handler, parse_events::production_finish, iterator pos)
         {
             if (--handler._depth == 0)
+            {
+                using builder = typename Tree::builder;
+                if constexpr (lexy::_detail::is_detected<_detect_overflowed, builder>)
+                {
+                    // The tree can't store the nodes, so the parse fails.
+                    handler._overflow = handler._builder->overflowed();
+                    if (handler._overflow)
+                    {
+                        auto err = lexy::error<lexy::input_reader<Input>,
+                                               lexy::compact_parse_tree_overflow>(
+                            _validate.production_begin(), pos);
+                        _validate.on(handler._validate, parse_events::error{}, err);
+                    }
+                }
+                if constexpr (lexy::_detail::is_detected<_detect_had_errors, builder>)
+                {
+                    if (handler._had_errors)
+                        handler._builder->set_had_errors();
+                }
+
                 *handler._tree = LEXY_MOV(*handler._builder).finish();
+                if (handler._overflow)
+                    handler._tree->clear();
+            }
             else
                 handler._builder->finish_production(LEXY_MOV(_marker));
         }
@@ -89,6 +125,7 @@ public:
         template <typename Error>
         void on(parse_tree_handler& handler, parse_events::error ev, Error&& error)
         {
+            handler._had_errors = true;
             _validate.on(handler._validate, ev, LEXY_FWD(error));
         }
 
@@ -110,13 +147,14 @@ public:
     constexpr auto get_result_void(bool rule_parse_result) &&
     {
         LEXY_PRECONDITION(_depth == 0);
-        return LEXY_MOV(_validate).get_result_void(rule_parse_result);
+        return LEXY_MOV(_validate).get_result_void(rule_parse_result && !_overflow);
     }
 
 private:
     lexy::_detail::lazy_init<typename Tree::builder> _builder;
     Tree*                                            _tree;
     int                                              _depth;
+    bool                                             _overflow, _had_errors;
 
     validate_handler<Input, ErrorCallback> _validate;
 };
@@ -142,6 +180,191 @@ auto parse_as_tree(parse_tree<lexy::input_reader<Input>, TokenKind, MemoryResour
     auto reader  = input.reader();
     return lexy::do_action<Production>(LEXY_MOV(handler), &state, reader);
 }
+
+template <typename Production, typename TokenKind, typename MemoryResource, typename Input,
+          typename ErrorCallback>
+auto parse_as_tree(compact_parse_tree<lexy::input_reader<Input>, TokenKind, MemoryResource>& tree,
+                   const Input& input, const ErrorCallback& callback)
+    -> validate_result<ErrorCallback>
+{
+    auto handler = parse_tree_handler(tree, input, LEXY_MOV(callback));
+    auto reader  = input.reader();
+    return lexy::do_action<Production>(LEXY_MOV(handler), no_parse_state, reader);
+}
+
+template <typename Production, typename TokenKind, typename MemoryResource, typename Input,
+          typename State, typename ErrorCallback>
+auto parse_as_tree(compact_parse_tree<lexy::input_reader<Input>, TokenKind, MemoryResource>& tree,
+                   const Input& input, const State& state, const ErrorCallback& callback)
+    -> validate_result<ErrorCallback>
+{
+    auto handler = parse_tree_handler(tree, input, LEXY_MOV(callback));
+    auto reader  = input.reader();
+    return lexy::do_action<Production>(LEXY_MOV(handler), &state, reader);
+}
+} // namespace lexy
+
+//=== reparse_as_tree ===//
+namespace lexy
+{
+/// Describes how the input changed since it was parsed:
+/// `removed` code units starting at `offset` were replaced by `inserted` code units.
+struct input_edit
+{
+    std::size_t offset;
+    std::size_t removed;
+    std::size_t inserted;
+};
+} // namespace lexy
+
+namespace lexy::_detail
+{
+struct cpt_reparse
+{
+    struct candidate
+    {
+        std::size_t idx, depth;
+        std::size_t begin, end;
+    };
+
+    template <typename... ReparseProductions, typename Tree>
+    static bool is_reparse_point(const Tree& tree, std::size_t idx)
+    {
+        auto& table = tree._productions;
+        auto  kind  = tree._nodes.kind[idx];
+        return (table.has_name(kind, lexy::production_name<ReparseProductions>()) || ...);
+    }
+
+    // Finds the deepest node above max_depth that is one of the ReparseProductions and contains
+    // the edit, but doesn't begin or end with it.
+    template <typename... ReparseProductions, typename Tree>
+    static bool find(candidate& result, const Tree& tree, input_edit edit, std::size_t max_depth)
+    {
+        auto& nodes = tree._nodes;
+
+        auto found = false;
+        auto cur   = std::size_t(0);
+        for (auto depth = std::size_t(1); depth < max_depth; ++depth)
+        {
+            // As the spans of the children are disjoint, at most one of them contains the edit.
+            auto next = std::size_t(0);
+            auto end  = cur + nodes.subtree_size(cur);
+            for (auto child = cur + 1; child != end; child += nodes.subtree_size(child))
+            {
+                if (nodes.type[child] != Tree::_nodes_t::type_production)
+                    continue;
+
+                std::size_t begin_offset, end_offset;
+                if (!tree._span(child, begin_offset, end_offset))
+                    continue;
+                else if (begin_offset >= edit.offset)
+                    break;
+                else if (edit.offset + edit.removed < end_offset)
+                {
+                    next = child;
+                    if (is_reparse_point<ReparseProductions...>(tree, child))
+                    {
+                        result = {child, depth, begin_offset, end_offset};
+                        found  = true;
+                    }
+                    break;
+                }
+            }
+
+            if (next == 0)
+                break;
+            cur = next;
+        }
+        return found;
+    }
+
+    // Parses the production at the position of the node in the new input and replaces the node.
+    // Returns false, without changing the tree, if the result would differ from a full reparse.
+    template <typename Root, typename Production, typename Tree, typename Input, typename State>
+    static bool reparse(Tree& tree, const Input& input, const State* state,
+                        const candidate& node, input_edit edit)
+    {
+        auto reader = input.reader();
+        auto begin  = reader.position();
+        reader.set_position(begin + std::ptrdiff_t(node.begin));
+
+        // Outside of the edit, the new input is the same as the old one, so parsing the production
+        // there yields the same result as parsing its parent, as long as it ends at the same
+        // position. Its whitespace is the one it inherits from the root production.
+        using whitespace_production
+            = std::conditional_t<is_token_production<Production> //
+                                     || _production_defines_whitespace<Production>,
+                                 _whitespace_production_of<Production>,
+                                 _whitespace_production_of<Root>>;
+
+        // Errors are raised again by the full reparse, so we don't need to report them.
+        Tree subtree(tree._nodes.resource());
+        auto result = lexy::_do_action<Production, whitespace_production>(
+            parse_tree_handler(subtree, input, lexy::noop), state, reader,
+            max_recursion_depth<Root>());
+
+        auto shift = std::ptrdiff_t(edit.inserted) - std::ptrdiff_t(edit.removed);
+        if (!result || reader.position() != begin + (std::ptrdiff_t(node.end) + shift))
+            return false;
+
+        tree._splice(node.idx, node.depth, subtree, begin, shift);
+        return true;
+    }
+
+    template <typename Root, typename... ReparseProductions, typename Tree, typename Input,
+              typename State, typename ErrorCallback>
+    static auto reparse_as_tree(Tree& tree, const Input& input, const State* state,
+                                input_edit edit, const ErrorCallback& callback)
+        -> validate_result<ErrorCallback>
+    {
+        // If the old parse raised errors, the tree doesn't tell us whether they're still there,
+        // so we have to parse everything again.
+        if (!tree.empty() && !tree.had_errors())
+        {
+            // We try the reparse points from the innermost to the outermost one.
+            candidate node{};
+            for (auto max_depth = tree.depth() + 1;
+                 find<ReparseProductions...>(node, tree, edit, max_depth); max_depth = node.depth)
+            {
+                auto done = false;
+                ((done = done
+                         || (is_reparse_point<ReparseProductions>(tree, node.idx)
+                             && reparse<Root, ReparseProductions>(tree, input, state, node, edit))),
+                 ...);
+                if (done)
+                    // We didn't raise any errors.
+                    return validate_handler(input, callback).get_result_void(true);
+            }
+        }
+
+        auto handler = parse_tree_handler(tree, input, LEXY_MOV(callback));
+        auto reader  = input.reader();
+        return lexy::do_action<Root>(LEXY_MOV(handler), state, reader);
+    }
+};
+} // namespace lexy::_detail
+
+namespace lexy
+{
+template <typename Production, typename... ReparseProductions, typename TokenKind,
+          typename MemoryResource, typename Input, typename ErrorCallback>
+auto reparse_as_tree(compact_parse_tree<lexy::input_reader<Input>, TokenKind, MemoryResource>& tree,
+                     const Input& input, input_edit edit, const ErrorCallback& callback)
+    -> validate_result<ErrorCallback>
+{
+    return _detail::cpt_reparse::reparse_as_tree<Production, ReparseProductions...>(
+        tree, input, no_parse_state, edit, callback);
+}
+
+template <typename Production, typename... ReparseProductions, typename TokenKind,
+          typename MemoryResource, typename Input, typename State, typename ErrorCallback>
+auto reparse_as_tree(compact_parse_tree<lexy::input_reader<Input>, TokenKind, MemoryResource>& tree,
+                     const Input& input, const State& state, input_edit edit,
+                     const ErrorCallback& callback) -> validate_result<ErrorCallback>
+{
+    return _detail::cpt_reparse::reparse_as_tree<Production, ReparseProductions...>(
+        tree, input, &state, edit, callback);
+}
 } // namespace lexy
 
 #endif // LEXY_ACTION_PARSE_AS_TREE_HPP_INCLUDED
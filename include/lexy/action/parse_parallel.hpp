@@ -0,0 +1,328 @@
+// Copyright (C) 2020-2022 Jonathan Müller and lexy contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#ifndef LEXY_ACTION_PARSE_PARALLEL_HPP_INCLUDED
+#define LEXY_ACTION_PARSE_PARALLEL_HPP_INCLUDED
+
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <lexy/_detail/lazy_init.hpp>
+#include <lexy/action/base.hpp>
+#include <lexy/action/parse.hpp>
+#include <lexy/callback/noop.hpp>
+#include <lexy/dsl/eof.hpp>
+#include <lexy/error.hpp>
+#include <lexy/input/base.hpp>
+#include <thread>
+#include <vector>
+
+//=== splitter ===//
+namespace lexy
+{
+struct _line_splitter
+{
+    template <typename CharT>
+    const CharT* operator()(const CharT* cur, const CharT* end) const noexcept
+    {
+        if constexpr (sizeof(CharT) == 1)
+        {
+            auto newline = std::memchr(cur, '\n', std::size_t(end - cur));
+            return newline == nullptr ? end : reinterpret_cast<const CharT*>(newline) + 1;
+        }
+        else
+        {
+            while (cur != end)
+                if (*cur++ == CharT('\n'))
+                    break;
+            return cur;
+        }
+    }
+};
+
+/// Splits the input into records after each newline.
+/// As a record cannot contain a newline, it finds the next record from any position.
+constexpr auto line_splitter = _line_splitter{};
+} // namespace lexy
+
+//=== parse_parallel ===//
+namespace lexy
+{
+// Records are parsed with a reader that ends at the end of the record,
+// which can be different from the reader of the input (e.g. the buffer relies on its sentinel).
+// This converts an error of the record reader into an error of the input.
+template <typename Input, typename Reader, typename Tag>
+constexpr auto _pp_error(const error<Reader, Tag>& err)
+{
+    using reader = input_reader<Input>;
+    if constexpr (std::is_same_v<Reader, reader>)
+        return err;
+    else if constexpr (std::is_same_v<Tag, expected_literal>)
+        return error<reader, Tag>(err.position(), err.string(), err.index(), err.length());
+    else if constexpr (std::is_same_v<Tag, expected_keyword>)
+        return error<reader, Tag>(err.begin(), err.end(), err.string(), err.length());
+    else if constexpr (std::is_same_v<Tag, expected_char_class>)
+        return error<reader, Tag>(err.position(), err.name());
+    else
+        return error<reader, Tag>(err.begin(), err.end());
+}
+
+// The handler used to parse a single record on the main thread.
+// It forwards all events to the validate handler of the final result, so errors are reported there.
+template <typename Input, typename ErrorCallback>
+class _pp_record_handler
+{
+    using _validate_t = validate_handler<Input, ErrorCallback>;
+
+public:
+    template <typename T>
+    struct result
+    {
+        bool                        rule_parse_result;
+        lexy::_detail::lazy_init<T> value;
+    };
+
+    constexpr explicit _pp_record_handler(_validate_t& validate) : _validate(&validate) {}
+
+    template <typename Production>
+    class event_handler
+    {
+    public:
+        template <typename Event, typename... Args>
+        constexpr auto on(_pp_record_handler& handler, Event ev, Args&&... args)
+        {
+            if constexpr (std::is_same_v<Event, parse_events::error>)
+                return _impl.on(*handler._validate, ev, _pp_error<Input>(args)...);
+            else
+                return _impl.on(*handler._validate, ev, LEXY_FWD(args)...);
+        }
+
+    private:
+        typename _validate_t::template event_handler<Production> _impl;
+    };
+
+    constexpr operator _validate_t&()
+    {
+        return *_validate;
+    }
+
+    template <typename Production, typename State>
+    using value_callback = production_value_callback<Production, State>;
+
+    constexpr auto get_result_void(bool rule_parse_result) &&
+    {
+        result<void> r{rule_parse_result, {}};
+        if (rule_parse_result)
+            r.value.emplace();
+        return r;
+    }
+
+    template <typename T>
+    constexpr auto get_result(bool rule_parse_result, T&& value) &&
+    {
+        result<T> r{rule_parse_result, {}};
+        r.value.emplace(LEXY_MOV(value));
+        return r;
+    }
+    template <typename T>
+    constexpr auto get_result(bool rule_parse_result) &&
+    {
+        return result<T>{rule_parse_result, {}};
+    }
+
+private:
+    _validate_t* _validate;
+};
+
+template <typename T, typename Iterator>
+struct _pp_record
+{
+    Iterator begin, end;
+    // Only set if the record was parsed without errors.
+    lexy::_detail::lazy_init<T> value;
+};
+
+template <typename Production, typename Input, typename State, typename Splitter, typename Sink,
+          typename ErrorCallback>
+auto _parse_parallel(const Input& input, const State* state, unsigned n_threads,
+                     const Splitter& splitter, const Sink& sink, const ErrorCallback& callback)
+{
+    using iterator = typename lexy::input_reader<Input>::iterator;
+    using encoding = typename lexy::input_reader<Input>::encoding;
+    static_assert(std::is_pointer_v<iterator>, "parse_parallel() requires contiguous input");
+
+    using value_type = typename lexy::production_value_callback<Production, State>::return_type;
+    using record     = _pp_record<value_type, iterator>;
+
+    if (n_threads == 0)
+        n_threads = std::thread::hardware_concurrency();
+    if (n_threads == 0)
+        n_threads = 1;
+
+    //=== split into chunks ===//
+    // We use more chunks than threads, so a thread that finishes early can help with the rest.
+    auto begin = input.data();
+    auto end   = begin + input.size();
+    auto size  = std::size_t(end - begin);
+
+    auto chunk_count = n_threads == 1 ? std::size_t(1) : 4 * std::size_t(n_threads);
+
+    std::vector<iterator> boundaries;
+    boundaries.push_back(begin);
+    for (auto i = std::size_t(1); i != chunk_count; ++i)
+    {
+        // The record that contains the split point is the last record of the chunk.
+        auto split = begin + i * (size / chunk_count);
+        if (split < boundaries.back())
+            split = boundaries.back();
+        boundaries.push_back(split == end ? end : splitter(split, end));
+    }
+    boundaries.push_back(end);
+
+    //=== parse chunks ===//
+    // Each record is parsed on its own, with its own control block.
+    // Errors are not reported yet; they're only counted by the noop callback.
+    // A record where the production doesn't consume everything is treated like one with an error.
+    std::vector<std::vector<record>> chunks(chunk_count);
+    std::atomic<std::size_t>         next_chunk(0);
+    auto                             parse_chunks = [&] {
+        for (auto idx = next_chunk++; idx < chunk_count; idx = next_chunk++)
+        {
+            auto& records = chunks[idx];
+            for (auto cur = boundaries[idx]; cur != boundaries[idx + 1];)
+            {
+                auto record_end = splitter(cur, boundaries[idx + 1]);
+                LEXY_ASSERT(cur != record_end, "splitter must make progress");
+
+                auto& rec = records.emplace_back(record{cur, record_end, {}});
+                auto  reader = _range_reader<encoding>(cur, record_end);
+                if constexpr (std::is_void_v<value_type>)
+                {
+                    auto handler = lexy::validate_handler(input, lexy::noop);
+                    auto result  = lexy::do_action<Production>(LEXY_MOV(handler), state, reader);
+                    if (result.is_success() && reader.position() == record_end)
+                        rec.value.emplace();
+                }
+                else
+                {
+                    auto handler = lexy::parse_handler(input, lexy::noop);
+                    auto result  = lexy::do_action<Production>(LEXY_MOV(handler), state, reader);
+                    if (result.is_success() && reader.position() == record_end)
+                        rec.value.emplace(LEXY_MOV(result).value());
+                }
+
+                cur = record_end;
+            }
+        }
+    };
+
+    // An exception must not escape a thread, so we rethrow the first one after all have finished.
+    std::exception_ptr exception;
+    std::atomic<bool>  has_exception(false);
+    auto               worker = [&] {
+#if defined(__cpp_exceptions)
+        try
+        {
+            parse_chunks();
+        }
+        catch (...)
+        {
+            if (!has_exception.exchange(true))
+                exception = std::current_exception();
+            // The other threads don't need to start on new chunks.
+            next_chunk = chunk_count;
+        }
+#else
+        parse_chunks();
+#endif
+    };
+
+    std::vector<std::thread> threads;
+    for (auto i = 1u; i < n_threads; ++i)
+        threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads)
+        thread.join();
+
+    if (exception)
+        std::rethrow_exception(exception);
+
+    //=== merge ===//
+    // Records with errors are parsed again, so the errors are reported in input order.
+    auto  handler  = lexy::parse_handler(input, callback);
+    auto& validate = static_cast<validate_handler<Input, ErrorCallback>&>(handler);
+
+    auto value_sink        = sink.sink();
+    auto rule_parse_result = true;
+    for (auto& records : chunks)
+        for (auto& rec : records)
+        {
+            if (!rec.value)
+            {
+                auto reader         = _range_reader<encoding>(rec.begin, rec.end);
+                auto record_handler = _pp_record_handler<Input, ErrorCallback>(validate);
+                auto result
+                    = lexy::do_action<Production>(LEXY_MOV(record_handler), state, reader);
+                if (!result.rule_parse_result)
+                {
+                    rule_parse_result = false;
+                }
+                else if (reader.position() != rec.end)
+                {
+                    // The production stopped early, which we report as error.
+                    using events_t = typename validate_handler<Input, ErrorCallback>::
+                        template event_handler<Production>;
+                    using error_t = lexy::error_for<Input, lexy::expected_eof>;
+
+                    events_t events;
+                    events.on(validate, parse_events::production_start{}, rec.begin);
+                    events.on(validate, parse_events::error{}, error_t(reader.position()));
+                    events.on(validate, parse_events::production_cancel{}, reader.position());
+
+                    rule_parse_result = false;
+                    continue;
+                }
+                rec.value = LEXY_MOV(result.value);
+            }
+
+            if (!rec.value)
+                continue;
+            else if constexpr (std::is_void_v<value_type>)
+                value_sink();
+            else
+                value_sink(LEXY_MOV(*rec.value));
+        }
+
+    using sink_result = LEXY_DECAY_DECLTYPE(LEXY_MOV(value_sink).finish());
+    if constexpr (std::is_void_v<sink_result>)
+    {
+        LEXY_MOV(value_sink).finish();
+        return LEXY_MOV(validate).get_result_void(rule_parse_result);
+    }
+    else if (rule_parse_result)
+        return LEXY_MOV(handler).get_result(true, LEXY_MOV(value_sink).finish());
+    else
+        return LEXY_MOV(handler).template get_result<sink_result>(false);
+}
+
+/// Parses every record of the input on multiple threads and passes the values to the sink.
+/// The input is split at arbitrary positions first, so the splitter must be able to find the
+/// beginning of the next record from anywhere, not just from the beginning of a record.
+template <typename Production, typename Input, typename Splitter, typename Sink,
+          typename ErrorCallback>
+auto parse_parallel(const Input& input, unsigned n_threads, const Splitter& splitter,
+                    const Sink& sink, const ErrorCallback& callback)
+{
+    return _parse_parallel<Production>(input, no_parse_state, n_threads, splitter, sink, callback);
+}
+
+template <typename Production, typename Input, typename State, typename Splitter, typename Sink,
+          typename ErrorCallback>
+auto parse_parallel(const Input& input, const State& state, unsigned n_threads,
+                    const Splitter& splitter, const Sink& sink, const ErrorCallback& callback)
+{
+    return _parse_parallel<Production>(input, &state, n_threads, splitter, sink, callback);
+}
+} // namespace lexy
+
+#endif // LEXY_ACTION_PARSE_PARALLEL_HPP_INCLUDED
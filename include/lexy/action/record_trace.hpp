@@ -0,0 +1,716 @@
+// Copyright (C) 2020-2022 Jonathan Müller and lexy contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#ifndef LEXY_ACTION_RECORD_TRACE_HPP_INCLUDED
+#define LEXY_ACTION_RECORD_TRACE_HPP_INCLUDED
+
+#include <cstdint>
+#include <cstring>
+#include <lexy/_detail/iterator.hpp>
+#include <lexy/_detail/memory_resource.hpp>
+#include <lexy/action/trace.hpp>
+#include <new>
+
+//=== internal: trace_event_buffer ===//
+namespace lexy::_detail
+{
+enum class trace_event_kind : unsigned char
+{
+    production_start,
+    production_finish,
+    production_cancel,
+    operation_chain_start,
+    operation_chain_op,
+    operation_chain_finish,
+    token,
+    backtracked,
+    error,
+    recovery_start,
+    recovery_finish,
+    recovery_cancel,
+    debug,
+};
+
+enum class trace_error_kind : unsigned char
+{
+    message,
+    expected_literal,
+    expected_keyword,
+    expected_char_class,
+};
+
+// A single parse event; it doesn't own any memory.
+template <typename Iterator, typename TokenKind>
+struct trace_event
+{
+    Iterator begin;
+    Iterator end; // only for tokens and backtracking
+    // The name of the production or operation, the message or expected string of an error,
+    // or the string of a debug event.
+    const void*                 str;
+    std::uint_least32_t         length; // of an expected string
+    lexy::token_kind<TokenKind> token;
+    trace_event_kind            kind;
+    trace_error_kind            error;
+};
+
+// Stores events in blocks that are never moved.
+// Blocks are kept when cleared, so recording the next parse doesn't allocate.
+template <typename Event, typename MemoryResource>
+class trace_event_buffer
+{
+    using resource_ptr = _detail::memory_resource_ptr<MemoryResource>;
+
+    // The first block stores 256 events, every following one twice as many as the previous one,
+    // up to 64k events.
+    static constexpr std::size_t initial_block_capacity = 256;
+    static constexpr std::size_t max_block_capacity     = 64 * 1024;
+
+    struct block
+    {
+        block*      next;
+        std::size_t capacity;
+        std::size_t size;
+
+        Event* events() noexcept
+        {
+            // NOLINTNEXTLINE: The memory is allocated together with the header.
+            return reinterpret_cast<Event*>(this + 1);
+        }
+        const Event* events() const noexcept
+        {
+            // NOLINTNEXTLINE: The memory is allocated together with the header.
+            return reinterpret_cast<const Event*>(this + 1);
+        }
+    };
+    static_assert(sizeof(block) % alignof(Event) == 0);
+    static_assert(std::is_trivially_copyable_v<Event> && std::is_trivially_destructible_v<Event>);
+
+public:
+    explicit constexpr trace_event_buffer(MemoryResource* resource) noexcept
+    : _resource(resource), _head(nullptr), _cur_block(nullptr), _cur_pos(nullptr),
+      _cur_end(nullptr)
+    {}
+
+    trace_event_buffer(const trace_event_buffer&) = delete;
+    trace_event_buffer& operator=(const trace_event_buffer&) = delete;
+
+    ~trace_event_buffer() noexcept
+    {
+        auto cur = _head;
+        while (cur != nullptr)
+        {
+            auto next = cur->next;
+            _resource->deallocate(cur, sizeof(block) + cur->capacity * sizeof(Event),
+                                  alignof(block));
+            cur = next;
+        }
+    }
+
+    resource_ptr resource() const noexcept
+    {
+        return _resource;
+    }
+
+    std::size_t size() const noexcept
+    {
+        auto result = std::size_t(0);
+        for_each_block([&](const Event*, std::size_t size) { result += size; });
+        return result;
+    }
+
+    void clear() noexcept
+    {
+        for (auto cur = _head; cur != nullptr; cur = cur->next)
+            cur->size = 0;
+
+        _cur_block = _head;
+        _cur_pos   = _head == nullptr ? nullptr : _head->events();
+        _cur_end   = _head == nullptr ? nullptr : _head->events() + _head->capacity;
+    }
+
+    LEXY_FORCE_INLINE void push_back(const Event& event)
+    {
+        if (_cur_pos == _cur_end)
+            _next_block();
+        ::new (static_cast<void*>(_cur_pos)) Event(event);
+        ++_cur_pos;
+    }
+
+    // Calls fn(events, size) for every block in order.
+    template <typename Fn>
+    void for_each_block(Fn fn) const
+    {
+        for (auto cur = _head; cur != nullptr; cur = cur->next)
+        {
+            if (cur == _cur_block)
+            {
+                fn(cur->events(), std::size_t(_cur_pos - cur->events()));
+                break;
+            }
+            fn(cur->events(), cur->size);
+        }
+    }
+
+private:
+    void _next_block()
+    {
+        if (_cur_block != nullptr)
+            _cur_block->size = std::size_t(_cur_pos - _cur_block->events());
+
+        auto next = _cur_block == nullptr ? _head : _cur_block->next;
+        if (next == nullptr)
+        {
+            auto capacity
+                = _cur_block == nullptr ? initial_block_capacity : 2 * _cur_block->capacity;
+            if (capacity > max_block_capacity)
+                capacity = max_block_capacity;
+
+            auto memory
+                = _resource->allocate(sizeof(block) + capacity * sizeof(Event), alignof(block));
+            next           = ::new (memory) block;
+            next->next     = nullptr;
+            next->capacity = capacity;
+            next->size     = 0;
+
+            if (_cur_block == nullptr)
+                _head = next;
+            else
+                _cur_block->next = next;
+        }
+
+        _cur_block = next;
+        _cur_pos   = next->events();
+        _cur_end   = next->events() + next->capacity;
+    }
+
+    LEXY_EMPTY_MEMBER resource_ptr _resource;
+    block*                         _head;
+    block*                         _cur_block;
+    Event*                         _cur_pos;
+    Event*                         _cur_end;
+};
+
+// A stack that allocates from the memory resource of the recorder.
+template <typename T, typename MemoryResource>
+class trace_stack
+{
+    using resource_ptr = _detail::memory_resource_ptr<MemoryResource>;
+    static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>);
+
+public:
+    explicit constexpr trace_stack(resource_ptr resource) noexcept
+    : _resource(resource), _data(nullptr), _size(0), _capacity(0)
+    {}
+
+    trace_stack(const trace_stack&) = delete;
+    trace_stack& operator=(const trace_stack&) = delete;
+
+    ~trace_stack() noexcept
+    {
+        if (_data != nullptr)
+            _resource->deallocate(_data, _capacity * sizeof(T), alignof(T));
+    }
+
+    void push_back(const T& value)
+    {
+        if (_size == _capacity)
+            _grow();
+        ::new (static_cast<void*>(_data + _size)) T(value);
+        ++_size;
+    }
+
+    T pop_back() noexcept
+    {
+        LEXY_PRECONDITION(_size > 0);
+        return _data[--_size];
+    }
+
+private:
+    void _grow()
+    {
+        auto new_capacity = _capacity == 0 ? std::size_t(16) : 2 * _capacity;
+        auto new_data
+            = static_cast<T*>(_resource->allocate(new_capacity * sizeof(T), alignof(T)));
+        if (_size > 0)
+            std::memcpy(static_cast<void*>(new_data), _data, _size * sizeof(T));
+
+        if (_data != nullptr)
+            _resource->deallocate(_data, _capacity * sizeof(T), alignof(T));
+        _data     = new_data;
+        _capacity = new_capacity;
+    }
+
+    LEXY_EMPTY_MEMBER resource_ptr _resource;
+    T*                             _data;
+    std::size_t                    _size;
+    std::size_t                    _capacity;
+};
+
+// Escapes the characters written to it for use inside a JSON string.
+template <typename OutputIt>
+struct json_string_output_iterator
+{
+    OutputIt _out;
+
+    json_string_output_iterator& operator*() noexcept
+    {
+        return *this;
+    }
+    json_string_output_iterator& operator++(int) noexcept
+    {
+        return *this;
+    }
+
+    json_string_output_iterator& operator=(char c)
+    {
+        if (c == '"' || c == '\\')
+        {
+            *_out++ = '\\';
+            *_out++ = c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+            _out = _detail::write_format(_out, "\\u%04X", unsigned(c));
+        else
+            *_out++ = c;
+        return *this;
+    }
+};
+} // namespace lexy::_detail
+
+//=== trace_recorder ===//
+namespace lexy
+{
+/// Records the parse events of a parse, so they can be rendered as a trace afterwards.
+template <typename Input, typename TokenKind = void, typename MemoryResource = void>
+class trace_recorder
+{
+    using iterator = typename lexy::input_reader<Input>::iterator;
+    using encoding = typename lexy::input_reader<Input>::encoding;
+    using event    = _detail::trace_event<iterator, TokenKind>;
+
+public:
+    explicit trace_recorder(MemoryResource* resource
+                            = _detail::get_memory_resource<MemoryResource>()) noexcept
+    : _input(nullptr), _events(resource)
+    {}
+
+    /// The number of recorded events.
+    std::size_t size() const noexcept
+    {
+        return _events.size();
+    }
+
+    /// Removes all recorded events, but keeps the memory around.
+    void clear() noexcept
+    {
+        _input = nullptr;
+        _events.clear();
+    }
+
+    /// Writes the trace in the same format as `lexy::trace_to()`.
+    template <typename OutputIt>
+    OutputIt render_to(OutputIt out, visualization_options opts = {}) const
+    {
+        LEXY_PRECONDITION(opts.max_tree_depth <= visualization_options::max_tree_depth_limit);
+        LEXY_PRECONDITION(_input != nullptr);
+
+        _detail::trace_writer<OutputIt, TokenKind> writer(out, opts);
+
+        // Like trace_handler, we start the search for a location at the beginning of the current
+        // production, and restore the previous one if it is canceled.
+        auto anchor           = input_location_anchor<Input>(*_input);
+        auto previous_anchors = _detail::trace_stack<input_location_anchor<Input>, MemoryResource>(
+            _events.resource());
+
+        // Events are mostly in order, so we can usually continue the search where the previous one
+        // stopped instead of at the beginning of a long production.
+        auto cursor       = anchor;
+        auto get_location = [&](iterator pos) {
+            auto result = [&] {
+                if constexpr (_detail::is_random_access_iterator<iterator>)
+                {
+                    if (anchor._line_begin < cursor._line_begin && cursor._line_begin <= pos)
+                        return get_input_location(*_input, pos, cursor);
+                }
+                return get_input_location(*_input, pos, anchor);
+            }();
+            cursor = result.anchor();
+            return result;
+        };
+
+        _events.for_each_block([&](const event* events, std::size_t size) {
+            for (auto ev = events; ev != events + size; ++ev)
+            {
+                auto loc = get_location(ev->begin);
+                switch (ev->kind)
+                {
+                case _detail::trace_event_kind::production_start:
+                    writer.write_production_start(loc, static_cast<const char*>(ev->str));
+                    previous_anchors.push_back(anchor);
+                    anchor = loc.anchor();
+                    break;
+                case _detail::trace_event_kind::production_finish:
+                    writer.write_finish(loc);
+                    previous_anchors.pop_back();
+                    break;
+                case _detail::trace_event_kind::production_cancel:
+                    writer.write_cancel(loc);
+                    anchor = previous_anchors.pop_back();
+                    break;
+
+                case _detail::trace_event_kind::operation_chain_start:
+                    writer.write_production_start(loc, "operation chain");
+                    break;
+                case _detail::trace_event_kind::operation_chain_op:
+                    writer.write_operation(loc, static_cast<const char*>(ev->str));
+                    break;
+                case _detail::trace_event_kind::operation_chain_finish:
+                    writer.write_finish(loc);
+                    break;
+
+                case _detail::trace_event_kind::token:
+                    writer.write_token(loc, ev->token, lexeme_for<Input>(ev->begin, ev->end));
+                    break;
+                case _detail::trace_event_kind::backtracked:
+                    writer.write_backtrack(loc, lexeme_for<Input>(ev->begin, ev->end));
+                    break;
+
+                case _detail::trace_event_kind::error:
+                    _render_error(writer, loc, *ev);
+                    break;
+
+                case _detail::trace_event_kind::recovery_start:
+                    writer.write_recovery_start(loc);
+                    break;
+                case _detail::trace_event_kind::recovery_finish:
+                    writer.write_finish(loc);
+                    break;
+                case _detail::trace_event_kind::recovery_cancel:
+                    writer.write_cancel(loc);
+                    break;
+
+                case _detail::trace_event_kind::debug:
+                    writer.write_debug(loc, static_cast<const char*>(ev->str));
+                    break;
+                }
+            }
+        });
+
+        return LEXY_MOV(writer).finish();
+    }
+
+    /// Writes the trace in the JSON format of Chrome's trace viewer and Perfetto.
+    /// The timestamp of an event is its offset in the input.
+    template <typename OutputIt>
+    OutputIt render_chrome_json_to(OutputIt out) const
+    {
+        LEXY_PRECONDITION(_input != nullptr);
+
+        const auto begin = _input->reader().position();
+        auto       first = true;
+
+        out = _detail::write_str(out, "{\"traceEvents\":[");
+        _events.for_each_block([&](const event* events, std::size_t size) {
+            for (auto ev = events; ev != events + size; ++ev)
+            {
+                if (first)
+                    first = false;
+                else
+                    *out++ = ',';
+                *out++ = '\n';
+
+                auto write_event = [&](const char* phase, auto write_name) {
+                    out = _detail::write_str(out, "{\"ph\":\"");
+                    out = _detail::write_str(out, phase);
+                    out = _detail::write_str(out, "\",\"name\":\"");
+                    out = write_name(_detail::json_string_output_iterator<OutputIt>{out})._out;
+                    out = _detail::write_format<48>(out, "\",\"pid\":0,\"tid\":0,\"ts\":%zu",
+                                                    _detail::range_size(begin, ev->begin));
+                };
+                auto name = [&](const char* str) {
+                    return [str](auto it) { return _detail::write_str(it, str); };
+                };
+
+                switch (ev->kind)
+                {
+                case _detail::trace_event_kind::production_start:
+                    write_event("B", name(static_cast<const char*>(ev->str)));
+                    break;
+                case _detail::trace_event_kind::operation_chain_start:
+                    write_event("B", name("operation chain"));
+                    break;
+                case _detail::trace_event_kind::recovery_start:
+                    write_event("B", name("error recovery"));
+                    break;
+
+                case _detail::trace_event_kind::production_finish:
+                case _detail::trace_event_kind::operation_chain_finish:
+                case _detail::trace_event_kind::recovery_finish:
+                    write_event("E", name(""));
+                    break;
+                case _detail::trace_event_kind::production_cancel:
+                case _detail::trace_event_kind::recovery_cancel:
+                    write_event("E", name(""));
+                    out = _detail::write_str(out, ",\"args\":{\"canceled\":true}");
+                    break;
+
+                case _detail::trace_event_kind::token:
+                    write_event("X", name(ev->token.name()));
+                    out = _detail::write_format<32>(out, ",\"dur\":%zu",
+                                                    _detail::range_size(ev->begin, ev->end));
+                    out = _detail::write_str(out, ",\"cat\":\"token\"");
+                    break;
+                case _detail::trace_event_kind::backtracked:
+                    write_event("X", name("backtracked"));
+                    out = _detail::write_format<32>(out, ",\"dur\":%zu",
+                                                    _detail::range_size(ev->begin, ev->end));
+                    out = _detail::write_str(out, ",\"cat\":\"backtracked\"");
+                    break;
+
+                case _detail::trace_event_kind::operation_chain_op:
+                    write_event("i", name(static_cast<const char*>(ev->str)));
+                    out = _detail::write_str(out, ",\"s\":\"t\",\"cat\":\"operation\"");
+                    break;
+                case _detail::trace_event_kind::error:
+                    write_event("i", [&](auto it) { return _write_error_message(it, *ev); });
+                    out = _detail::write_str(out, ",\"s\":\"t\",\"cat\":\"error\"");
+                    break;
+                case _detail::trace_event_kind::debug:
+                    write_event("i", name(static_cast<const char*>(ev->str)));
+                    out = _detail::write_str(out, ",\"s\":\"t\",\"cat\":\"debug\"");
+                    break;
+                }
+
+                *out++ = '}';
+            }
+        });
+        out = _detail::write_str(out, "\n]}\n");
+
+        return out;
+    }
+
+private:
+    template <typename Writer, typename Location>
+    static void _render_error(Writer& writer, const Location& loc, const event& ev)
+    {
+        auto str = static_cast<const typename encoding::char_type*>(ev.str);
+        switch (ev.error)
+        {
+        case _detail::trace_error_kind::message:
+            writer.write_message_error(loc, "", static_cast<const char*>(ev.str));
+            break;
+        case _detail::trace_error_kind::expected_literal:
+            writer.template write_expected_error<encoding>(loc, "expected '", str, ev.length);
+            break;
+        case _detail::trace_error_kind::expected_keyword:
+            writer.template write_expected_error<encoding>(loc, "expected keyword '", str,
+                                                           ev.length);
+            break;
+        case _detail::trace_error_kind::expected_char_class:
+            writer.write_message_error(loc, "expected ", static_cast<const char*>(ev.str));
+            break;
+        }
+    }
+
+    template <typename OutputIt>
+    static OutputIt _write_error_message(OutputIt out, const event& ev)
+    {
+        auto str = static_cast<const typename encoding::char_type*>(ev.str);
+        switch (ev.error)
+        {
+        case _detail::trace_error_kind::message:
+            out = _detail::write_str(out, static_cast<const char*>(ev.str));
+            break;
+        case _detail::trace_error_kind::expected_literal:
+            out = _detail::write_str(out, "expected '");
+            out = visualize_to(out, _detail::make_literal_lexeme<encoding>(str, ev.length));
+            out = _detail::write_str(out, "'");
+            break;
+        case _detail::trace_error_kind::expected_keyword:
+            out = _detail::write_str(out, "expected keyword '");
+            out = visualize_to(out, _detail::make_literal_lexeme<encoding>(str, ev.length));
+            out = _detail::write_str(out, "'");
+            break;
+        case _detail::trace_error_kind::expected_char_class:
+            out = _detail::write_str(out, "expected ");
+            out = _detail::write_str(out, static_cast<const char*>(ev.str));
+            break;
+        }
+        return out;
+    }
+
+    const Input*                                        _input;
+    _detail::trace_event_buffer<event, MemoryResource> _events;
+
+    template <typename, typename, typename>
+    friend class record_trace_handler;
+};
+
+template <typename Input, typename TokenKind = void, typename MemoryResource = void>
+class record_trace_handler
+{
+    using iterator = typename lexy::input_reader<Input>::iterator;
+    using recorder = trace_recorder<Input, TokenKind, MemoryResource>;
+    using event    = typename recorder::event;
+    using kind     = _detail::trace_event_kind;
+
+public:
+    explicit record_trace_handler(recorder& r, const Input& input) noexcept : _recorder(&r)
+    {
+        r.clear();
+        r._input = &input;
+    }
+
+    template <typename Production>
+    class event_handler
+    {
+    public:
+        void on(record_trace_handler& handler, parse_events::production_start, iterator pos)
+        {
+            handler._push(kind::production_start, pos, lexy::production_name<Production>());
+        }
+        void on(record_trace_handler& handler, parse_events::production_finish, iterator pos)
+        {
+            handler._push(kind::production_finish, pos);
+        }
+        void on(record_trace_handler& handler, parse_events::production_cancel, iterator pos)
+        {
+            handler._push(kind::production_cancel, pos);
+        }
+
+        int on(record_trace_handler& handler, parse_events::operation_chain_start, iterator pos)
+        {
+            handler._push(kind::operation_chain_start, pos);
+            return 0; // need to return something
+        }
+        template <typename Operation>
+        void on(record_trace_handler& handler, parse_events::operation_chain_op, Operation,
+                iterator pos)
+        {
+            handler._push(kind::operation_chain_op, pos, lexy::production_name<Operation>());
+        }
+        void on(record_trace_handler& handler, parse_events::operation_chain_finish, int,
+                iterator pos)
+        {
+            handler._push(kind::operation_chain_finish, pos);
+        }
+
+        template <typename TK>
+        void on(record_trace_handler& handler, parse_events::token, TK tk, iterator begin,
+                iterator end)
+        {
+            auto token = lexy::token_kind<TokenKind>(tk);
+            if (token.ignore_if_empty() && begin == end)
+                return;
+
+            auto ev  = handler._make(kind::token, begin);
+            ev.end   = end;
+            ev.token = token;
+            handler._recorder->_events.push_back(ev);
+        }
+        void on(record_trace_handler& handler, parse_events::backtracked, iterator begin,
+                iterator end)
+        {
+            if (begin == end)
+                return;
+
+            auto ev = handler._make(kind::backtracked, begin);
+            ev.end  = end;
+            handler._recorder->_events.push_back(ev);
+        }
+
+        template <typename Reader, typename Tag>
+        void on(record_trace_handler& handler, parse_events::error,
+                const lexy::error<Reader, Tag>& error)
+        {
+            auto ev = handler._make(kind::error, error.position());
+            if constexpr (std::is_same_v<Tag, lexy::expected_literal>)
+            {
+                ev.error  = _detail::trace_error_kind::expected_literal;
+                ev.str    = error.string();
+                ev.length = static_cast<std::uint_least32_t>(error.length());
+            }
+            else if constexpr (std::is_same_v<Tag, lexy::expected_keyword>)
+            {
+                ev.error  = _detail::trace_error_kind::expected_keyword;
+                ev.str    = error.string();
+                ev.length = static_cast<std::uint_least32_t>(error.length());
+            }
+            else if constexpr (std::is_same_v<Tag, lexy::expected_char_class>)
+            {
+                ev.error = _detail::trace_error_kind::expected_char_class;
+                ev.str   = error.name();
+            }
+            else
+            {
+                ev.error = _detail::trace_error_kind::message;
+                ev.str   = error.message();
+            }
+            handler._recorder->_events.push_back(ev);
+        }
+
+        void on(record_trace_handler& handler, parse_events::recovery_start, iterator pos)
+        {
+            handler._push(kind::recovery_start, pos);
+        }
+        void on(record_trace_handler& handler, parse_events::recovery_finish, iterator pos)
+        {
+            handler._push(kind::recovery_finish, pos);
+        }
+        void on(record_trace_handler& handler, parse_events::recovery_cancel, iterator pos)
+        {
+            handler._push(kind::recovery_cancel, pos);
+        }
+
+        void on(record_trace_handler& handler, parse_events::debug, iterator pos, const char* str)
+        {
+            handler._push(kind::debug, pos, str);
+        }
+    };
+
+    template <typename Production, typename State>
+    using value_callback = _detail::void_value_callback;
+
+    constexpr bool get_result_void(bool rule_parse_result) &&
+    {
+        return rule_parse_result;
+    }
+
+private:
+    static event _make(kind k, iterator pos, const char* str = nullptr) noexcept
+    {
+        return event{pos, pos, str, 0, {}, k, _detail::trace_error_kind::message};
+    }
+    void _push(kind k, iterator pos, const char* str = nullptr)
+    {
+        _recorder->_events.push_back(_make(k, pos, str));
+    }
+
+    recorder* _recorder;
+};
+
+/// Parses the production and records its events in the recorder, replacing the previous ones.
+template <typename Production, typename Input, typename TokenKind, typename MemoryResource>
+bool record_trace(trace_recorder<Input, TokenKind, MemoryResource>& recorder, const Input& input)
+{
+    auto reader = input.reader();
+    return lexy::do_action<Production>(record_trace_handler<Input, TokenKind, MemoryResource>(
+                                           recorder, input),
+                                       no_parse_state, reader);
+}
+
+template <typename Production, typename Input, typename TokenKind, typename MemoryResource,
+          typename State>
+bool record_trace(trace_recorder<Input, TokenKind, MemoryResource>& recorder, const Input& input,
+                  const State& state)
+{
+    auto reader = input.reader();
+    return lexy::do_action<Production>(record_trace_handler<Input, TokenKind, MemoryResource>(
+                                           recorder, input),
+                                       &state, reader);
+}
+} // namespace lexy
+
+#endif // LEXY_ACTION_RECORD_TRACE_HPP_INCLUDED
+
@@ -125,46 +125,48 @@ public:
 
     template <typename Location, typename Reader, typename Tag>
     void write_error(const Location& loc, const lexy::error<Reader, Tag>& error)
+    {
+        if constexpr (std::is_same_v<Tag, lexy::expected_literal>)
+            write_expected_error<typename Reader::encoding>(loc, "expected '", error.string(),
+                                                            error.length());
+        else if constexpr (std::is_same_v<Tag, lexy::expected_keyword>)
+            write_expected_error<typename Reader::encoding>(loc, "expected keyword '",
+                                                            error.string(), error.length());
+        else if constexpr (std::is_same_v<Tag, lexy::expected_char_class>)
+            write_message_error(loc, "expected ", error.name());
+        else
+            write_message_error(loc, "", error.message());
+    }
+
+    // An error that expected the given string, e.g. a literal.
+    template <typename Encoding, typename Location>
+    void write_expected_error(const Location& loc, const char* prefix,
+                              const typename Encoding::char_type* str, std::size_t length)
     {
         if (_cur_depth > _opts.max_tree_depth)
             return;
 
-        write_prefix(loc, prefix::event);
+        write_error_prefix(loc);
+
+        auto string = _detail::make_literal_lexeme<Encoding>(str, length);
+        _out        = _detail::write_str(_out, prefix);
+        _out        = visualize_to(_out, string, _opts);
+        _out        = _detail::write_str(_out, "'");
 
-        _out = _detail::write_color<_detail::color::red, _detail::color::bold>(_out, _opts);
-        _out = _detail::write_str(_out, "error");
         _out = _detail::write_color<_detail::color::reset>(_out, _opts);
+    }
 
-        _out = _detail::write_color<_detail::color::red>(_out, _opts);
-        _out = _detail::write_str(_out, ": ");
+    // An error with the given message.
+    template <typename Location>
+    void write_message_error(const Location& loc, const char* prefix, const char* message)
+    {
+        if (_cur_depth > _opts.max_tree_depth)
+            return;
 
-        if constexpr (std::is_same_v<Tag, lexy::expected_literal>)
-        {
-            auto string = _detail::make_literal_lexeme<typename Reader::encoding>(error.string(),
-                                                                                  error.length());
+        write_error_prefix(loc);
 
-            _out = _detail::write_str(_out, "expected '");
-            _out = visualize_to(_out, string, _opts);
-            _out = _detail::write_str(_out, "'");
-        }
-        else if constexpr (std::is_same_v<Tag, lexy::expected_keyword>)
-        {
-            auto string = _detail::make_literal_lexeme<typename Reader::encoding>(error.string(),
-                                                                                  error.length());
-
-            _out = _detail::write_str(_out, "expected keyword '");
-            _out = visualize_to(_out, string, _opts);
-            _out = _detail::write_str(_out, "'");
-        }
-        else if constexpr (std::is_same_v<Tag, lexy::expected_char_class>)
-        {
-            _out = _detail::write_str(_out, "expected ");
-            _out = _detail::write_str(_out, error.name());
-        }
-        else
-        {
-            _out = _detail::write_str(_out, error.message());
-        }
+        _out = _detail::write_str(_out, prefix);
+        _out = _detail::write_str(_out, message);
 
         _out = _detail::write_color<_detail::color::reset>(_out, _opts);
     }
@@ -257,6 +259,19 @@ private:
         finish,
     };
 
+    template <typename Location>
+    void write_error_prefix(const Location& loc)
+    {
+        write_prefix(loc, prefix::event);
+
+        _out = _detail::write_color<_detail::color::red, _detail::color::bold>(_out, _opts);
+        _out = _detail::write_str(_out, "error");
+        _out = _detail::write_color<_detail::color::reset>(_out, _opts);
+
+        _out = _detail::write_color<_detail::color::red>(_out, _opts);
+        _out = _detail::write_str(_out, ": ");
+    }
+
     template <typename Location>
     void write_prefix(const Location& loc, prefix p)
     {
@@ -449,12 +464,14 @@ OutputIt trace_to(OutputIt out, const Input& input, const ParseState& state,
 template <typename Production, typename TokenKind = void, typename Input>
 void trace(std::FILE* file, const Input& input, visualization_options opts = {})
 {
-    trace_to<Production, TokenKind>(cfile_output_iterator{file}, input, opts);
+    cfile_output_buffer buffer(file);
+    trace_to<Production, TokenKind>(buffer.output_iterator(), input, opts);
 }
 template <typename Production, typename TokenKind = void, typename Input, typename State>
 void trace(std::FILE* file, const Input& input, const State& state, visualization_options opts = {})
 {
-    trace_to<Production, TokenKind>(cfile_output_iterator{file}, input, state, opts);
+    cfile_output_buffer buffer(file);
+    trace_to<Production, TokenKind>(buffer.output_iterator(), input, state, opts);
 }
 } // namespace lexy
 
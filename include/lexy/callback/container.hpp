@@ -4,17 +4,13 @@
 #ifndef LEXY_CALLBACK_CONTAINER_HPP_INCLUDED
 #define LEXY_CALLBACK_CONTAINER_HPP_INCLUDED
 
+#include <lexy/_detail/scratch_stack.hpp>
 #include <lexy/callback/base.hpp>
 
 namespace lexy
 {
 struct nullopt;
 
-template <typename Container>
-using _detect_reserve = decltype(LEXY_DECLVAL(Container&).reserve(std::size_t()));
-template <typename Container>
-constexpr auto _has_reserve = _detail::is_detected<_detect_reserve, Container>;
-
 template <typename Container>
 struct _list_sink
 {
@@ -40,7 +36,82 @@ struct _list_sink
     }
 };
 
-template <typename Container, typename AllocFn>
+// Collects the items on the scratch stack of the thread first.
+// That way, the final container can be created with the exact size.
+template <typename Container, bool Collection>
+class _scratch_sink
+{
+    using _value_type = typename Container::value_type;
+    using _stack      = _detail::scratch_stack<_value_type>;
+
+public:
+    using return_type = Container;
+
+    explicit _scratch_sink(Container&& container)
+    : _result(LEXY_MOV(container)), _begin(_stack::get().size()), _size(0), _active(true)
+    {}
+
+    _scratch_sink(_scratch_sink&& other) noexcept
+    : _result(LEXY_MOV(other._result)), _begin(other._begin), _size(other._size),
+      _active(other._active)
+    {
+        other._active = false;
+    }
+    _scratch_sink& operator=(_scratch_sink&&) = delete;
+
+    ~_scratch_sink() noexcept
+    {
+        // The sink has been abandoned, so we need to clean up after us.
+        if (_active)
+            _stack::get().pop_to(_begin);
+    }
+
+    template <typename... Args,
+              typename = std::enable_if_t<std::is_constructible_v<_value_type, Args&&...>>>
+    void operator()(Args&&... args)
+    {
+        auto& stack = _stack::get();
+        LEXY_PRECONDITION(_active && stack.size() == _begin + _size);
+        stack.emplace(LEXY_FWD(args)...);
+        ++_size;
+    }
+
+    Container&& finish() &&
+    {
+        auto& stack = _stack::get();
+        LEXY_PRECONDITION(_active && stack.size() == _begin + _size);
+
+        if constexpr (_has_reserve<Container>)
+            _result.reserve(_size);
+        for (auto i = _begin; i != _begin + _size; ++i)
+        {
+            if constexpr (Collection)
+                _result.insert(LEXY_MOV(stack[i]));
+            else
+                _result.push_back(LEXY_MOV(stack[i]));
+        }
+
+        stack.pop_to(_begin);
+        _active = false;
+        return LEXY_MOV(_result);
+    }
+
+private:
+    Container   _result;
+    std::size_t _begin, _size;
+    bool        _active;
+};
+
+template <typename Container, bool Scratch>
+constexpr auto _make_list_sink(Container&& container)
+{
+    if constexpr (Scratch)
+        return _scratch_sink<Container, false>(LEXY_MOV(container));
+    else
+        return _list_sink<Container>{LEXY_MOV(container)};
+}
+
+template <typename Container, typename AllocFn, bool Scratch = false>
 struct _list_alloc
 {
     AllocFn _alloc;
@@ -84,11 +155,16 @@ struct _list_alloc
     template <typename State>
     constexpr auto sink(const State& state) const
     {
-        return _list_sink<Container>{Container(_detail::invoke(_alloc, state))};
+        return _make_list_sink<Container, Scratch>(Container(_detail::invoke(_alloc, state)));
+    }
+
+    constexpr auto scratch() const
+    {
+        return _list_alloc<Container, AllocFn, true>{_alloc};
     }
 };
 
-template <typename Container>
+template <typename Container, bool Scratch = false>
 struct _list
 {
     using return_type = Container;
@@ -126,18 +202,25 @@ struct _list
 
     constexpr auto sink() const
     {
-        return _list_sink<Container>{Container()};
+        return _make_list_sink<Container, Scratch>(Container());
     }
     template <typename C = Container>
     constexpr auto sink(const typename C::allocator_type& allocator) const
     {
-        return _list_sink<Container>{Container(allocator)};
+        return _make_list_sink<Container, Scratch>(Container(allocator));
+    }
+
+    /// Collects the items of the sink in thread-local scratch memory first,
+    /// so the container can be created with the exact size.
+    constexpr auto scratch() const
+    {
+        return _list<Container, true>{};
     }
 
     template <typename AllocFn>
     constexpr auto allocator(AllocFn alloc_fn) const
     {
-        return _list_alloc<Container, AllocFn>{alloc_fn};
+        return _list_alloc<Container, AllocFn, Scratch>{alloc_fn};
     }
     constexpr auto allocator() const
     {
@@ -178,7 +261,16 @@ struct _collection_sink
     }
 };
 
-template <typename Container, typename AllocFn>
+template <typename Container, bool Scratch>
+constexpr auto _make_collection_sink(Container&& container)
+{
+    if constexpr (Scratch)
+        return _scratch_sink<Container, true>(LEXY_MOV(container));
+    else
+        return _collection_sink<Container>{LEXY_MOV(container)};
+}
+
+template <typename Container, typename AllocFn, bool Scratch = false>
 struct _collection_alloc
 {
     AllocFn _alloc;
@@ -222,11 +314,17 @@ struct _collection_alloc
     template <typename State>
     constexpr auto sink(const State& state) const
     {
-        return _collection_sink<Container>{Container(_detail::invoke(_alloc, state))};
+        return _make_collection_sink<Container, Scratch>(
+            Container(_detail::invoke(_alloc, state)));
+    }
+
+    constexpr auto scratch() const
+    {
+        return _collection_alloc<Container, AllocFn, true>{_alloc};
     }
 };
 
-template <typename Container>
+template <typename Container, bool Scratch = false>
 struct _collection
 {
     using return_type = Container;
@@ -265,18 +363,25 @@ struct _collection
 
     constexpr auto sink() const
     {
-        return _collection_sink<Container>{Container()};
+        return _make_collection_sink<Container, Scratch>(Container());
     }
     template <typename C = Container>
     constexpr auto sink(const typename C::allocator_type& allocator) const
     {
-        return _collection_sink<Container>{Container(allocator)};
+        return _make_collection_sink<Container, Scratch>(Container(allocator));
+    }
+
+    /// Collects the items of the sink in thread-local scratch memory first,
+    /// so the container can reserve the exact size.
+    constexpr auto scratch() const
+    {
+        return _collection<Container, true>{};
     }
 
     template <typename AllocFn>
     constexpr auto allocator(AllocFn alloc_fn) const
     {
-        return _collection_alloc<Container, AllocFn>{alloc_fn};
+        return _collection_alloc<Container, AllocFn, Scratch>{alloc_fn};
     }
     constexpr auto allocator() const
     {
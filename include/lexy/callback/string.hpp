@@ -96,7 +96,16 @@ struct _as_string
         {
             static_assert(lexy::char_type_compatible_with_reader<Reader, _char_type>,
                           "cannot convert lexeme to this string type");
-            _result.append(lex.begin(), lex.end());
+
+            using iterator = typename lexeme<Reader>::iterator;
+            if constexpr (std::is_convertible_v<iterator, const _char_type*>)
+                _result.append(lex.data(), lex.size());
+            else if constexpr (std::is_pointer_v<iterator> && std::is_same_v<_char_type, char>)
+                // char can alias the other character type (e.g. char8_t), so we can still append
+                // the entire range at once instead of converting one character at a time.
+                _result.append(reinterpret_cast<const char*>(lex.data()), lex.size());
+            else
+                _result.append(lex.begin(), lex.end());
         }
 
         void operator()(code_point cp)
@@ -106,6 +115,16 @@ struct _as_string
             _result.append(buffer, buffer + size);
         }
 
+        // Size hint from rules that know a lower bound of the final length.
+        void reserve(std::size_t size)
+        {
+            if constexpr (_has_reserve<String>)
+            {
+                if (size > _result.capacity())
+                    _result.reserve(size);
+            }
+        }
+
         String&& finish() &&
         {
             return LEXY_MOV(_result);
@@ -127,6 +146,7 @@ struct _as_string
 /// As a callback, it converts a lexeme into the string.
 /// As a sink, it repeatedly calls `.push_back()` for individual characters,
 /// or `.append()` for lexemes or other strings.
+/// Size hints from the rule are forwarded to `.reserve()`.
 template <typename String, typename Encoding = deduce_encoding<_string_char_type<String>>>
 constexpr auto as_string = _as_string<String, Encoding>{};
 } // namespace lexy
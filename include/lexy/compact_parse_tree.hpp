@@ -0,0 +1,1348 @@
+// Copyright (C) 2020-2022 Jonathan Müller and lexy contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#ifndef LEXY_COMPACT_PARSE_TREE_HPP_INCLUDED
+#define LEXY_COMPACT_PARSE_TREE_HPP_INCLUDED
+
+#include <cstdint>
+#include <cstring>
+#include <lexy/_detail/assert.hpp>
+#include <lexy/_detail/config.hpp>
+#include <lexy/_detail/iterator.hpp>
+#include <lexy/_detail/memory_resource.hpp>
+#include <lexy/grammar.hpp>
+#include <lexy/parse_tree.hpp>
+#include <lexy/token.hpp>
+
+//=== internal: cpt_nodes ===//
+namespace lexy::_detail
+{
+// Stores the nodes of a compact parse tree in preorder using parallel arrays.
+//
+// A token stores the offset of its beginning relative to the beginning of the input and its
+// length. A production stores the distance to its parent and the number of nodes in its subtree,
+// including itself. This means each node takes up 11 bytes.
+//
+// The arrays are read-only, nodes are modified using the member functions.
+// A value that doesn't fit into 32 bits marks the nodes as overflowed, which is checked at the end.
+template <typename MemoryResource>
+class cpt_nodes
+{
+    using resource_ptr = _detail::memory_resource_ptr<MemoryResource>;
+
+    static constexpr std::size_t node_size = 2 * sizeof(std::uint32_t) + sizeof(std::uint16_t) + 1;
+    static constexpr std::size_t initial_capacity = 256;
+
+public:
+    static constexpr std::uint8_t type_token      = 0;
+    static constexpr std::uint8_t type_production = 1;
+
+    const std::uint32_t* offset; // token: begin offset, production: distance to parent
+    const std::uint32_t* size;   // token: length, production: size of the subtree
+    const std::uint16_t* kind; // token: raw token kind, production: index into the production table
+    const std::uint8_t*  type;
+
+    //=== constructors/destructors/assignment ===//
+    explicit constexpr cpt_nodes(MemoryResource* resource) noexcept
+    : offset(nullptr), size(nullptr), kind(nullptr), type(nullptr), _resource(resource),
+      _memory(nullptr), _count(0), _capacity(0), _overflow(false)
+    {}
+
+    cpt_nodes(cpt_nodes&& other) noexcept
+    : offset(other.offset), size(other.size), kind(other.kind), type(other.type),
+      _resource(other._resource), _memory(other._memory), _count(other._count),
+      _capacity(other._capacity), _overflow(other._overflow)
+    {
+        other.offset = other.size = nullptr;
+        other.kind                = nullptr;
+        other.type                = nullptr;
+        other._memory             = nullptr;
+        other._count              = 0;
+        other._capacity           = 0;
+        other._overflow           = false;
+    }
+
+    ~cpt_nodes() noexcept
+    {
+        if (_capacity > 0)
+            _resource->deallocate(_memory, _capacity * node_size, alignof(std::uint32_t));
+    }
+
+    cpt_nodes& operator=(cpt_nodes&& other) noexcept
+    {
+        lexy::_detail::swap(offset, other.offset);
+        lexy::_detail::swap(size, other.size);
+        lexy::_detail::swap(kind, other.kind);
+        lexy::_detail::swap(type, other.type);
+        lexy::_detail::swap(_resource, other._resource);
+        lexy::_detail::swap(_memory, other._memory);
+        lexy::_detail::swap(_count, other._count);
+        lexy::_detail::swap(_capacity, other._capacity);
+        lexy::_detail::swap(_overflow, other._overflow);
+        return *this;
+    }
+
+    //=== access ===//
+    auto resource() const noexcept
+    {
+        return _resource.get();
+    }
+
+    std::size_t count() const noexcept
+    {
+        return _count;
+    }
+
+    // Whether an offset or size didn't fit into 32 bits since the last clear().
+    bool overflowed() const noexcept
+    {
+        return _overflow;
+    }
+
+    // The number of nodes in the subtree of the node.
+    std::size_t subtree_size(std::size_t idx) const noexcept
+    {
+        return type[idx] == type_token ? 1 : size[idx];
+    }
+
+    // The index of the parent of a production node; the root is its own parent.
+    std::size_t production_parent(std::size_t idx) const noexcept
+    {
+        LEXY_PRECONDITION(type[idx] == type_production);
+        return idx - offset[idx];
+    }
+
+    //=== modifiers ===//
+    // Removes all nodes without releasing memory.
+    void clear() noexcept
+    {
+        _count    = 0;
+        _overflow = false;
+    }
+
+    // Uses nodes stored elsewhere in the same layout, e.g. in a mapped file.
+    // As we don't have any capacity, the memory is neither modified nor released.
+    void assign_view(const void* memory, std::size_t count) noexcept
+    {
+        LEXY_PRECONDITION(_capacity == 0);
+        auto bytes = static_cast<const unsigned char*>(memory);
+
+        offset = reinterpret_cast<const std::uint32_t*>(bytes);
+        size   = offset + count;
+        kind   = reinterpret_cast<const std::uint16_t*>(size + count);
+        type   = reinterpret_cast<const std::uint8_t*>(kind + count);
+        _count = count;
+    }
+
+    // Removes all nodes starting at the index.
+    void truncate(std::size_t count) noexcept
+    {
+        LEXY_PRECONDITION(count <= _count);
+        _count = count;
+    }
+
+    std::size_t push(std::uint8_t t, std::uint16_t k, std::size_t o, std::size_t s)
+    {
+        if (_count == _capacity)
+            _grow();
+
+        auto idx = _count++;
+        assign(idx, t, k, o, s);
+        return idx;
+    }
+
+    // Inserts a node at the index, moving all nodes after it back by one.
+    // This is linear in the number of nodes after it.
+    void insert(std::size_t idx, std::uint8_t t, std::uint16_t k, std::size_t o, std::size_t s)
+    {
+        LEXY_PRECONDITION(idx <= _count);
+        if (_count == _capacity)
+            _grow();
+
+        _move(idx, idx + 1, _count - idx);
+        ++_count;
+
+        assign(idx, t, k, o, s);
+    }
+
+    // Replaces the nodes [idx, idx + old_count) by new_count nodes that need to be assigned,
+    // moving all nodes after them.
+    // This is linear in the number of nodes after them.
+    void replace(std::size_t idx, std::size_t old_count, std::size_t new_count)
+    {
+        LEXY_PRECONDITION(idx + old_count <= _count);
+        while (_count - old_count + new_count > _capacity)
+            _grow();
+
+        _move(idx + old_count, idx + new_count, _count - idx - old_count);
+        _count = _count - old_count + new_count;
+    }
+
+    void assign(std::size_t idx, std::uint8_t t, std::uint16_t k, std::size_t o, std::size_t s)
+    {
+        set_offset(idx, o);
+        set_size(idx, s);
+        _kind()[idx] = k;
+        _type()[idx] = t;
+    }
+
+    void set_offset(std::size_t idx, std::size_t o) noexcept
+    {
+        LEXY_PRECONDITION(idx < _count);
+        _offset()[idx] = _narrow(o);
+    }
+    void set_size(std::size_t idx, std::size_t s) noexcept
+    {
+        LEXY_PRECONDITION(idx < _count);
+        _size()[idx] = _narrow(s);
+    }
+
+private:
+    std::uint32_t _narrow(std::size_t value) noexcept
+    {
+        if (value > UINT32_MAX)
+        {
+            _overflow = true;
+            return 0;
+        }
+        return std::uint32_t(value);
+    }
+
+    // Only nodes we've allocated ourselves can be modified.
+    std::uint32_t* _offset() const noexcept
+    {
+        LEXY_PRECONDITION(_capacity > 0);
+        return reinterpret_cast<std::uint32_t*>(_memory);
+    }
+    std::uint32_t* _size() const noexcept
+    {
+        return _offset() + _capacity;
+    }
+    std::uint16_t* _kind() const noexcept
+    {
+        return reinterpret_cast<std::uint16_t*>(_size() + _capacity);
+    }
+    std::uint8_t* _type() const noexcept
+    {
+        return reinterpret_cast<std::uint8_t*>(_kind() + _capacity);
+    }
+
+    void _move(std::size_t from, std::size_t to, std::size_t n) noexcept
+    {
+        std::memmove(_offset() + to, _offset() + from, n * sizeof(*offset));
+        std::memmove(_size() + to, _size() + from, n * sizeof(*size));
+        std::memmove(_kind() + to, _kind() + from, n * sizeof(*kind));
+        std::memmove(_type() + to, _type() + from, n * sizeof(*type));
+    }
+
+    void _grow()
+    {
+        auto new_capacity = _capacity == 0 ? initial_capacity : 2 * _capacity;
+
+        auto memory = static_cast<unsigned char*>(
+            _resource->allocate(new_capacity * node_size, alignof(std::uint32_t)));
+        auto new_offset = reinterpret_cast<std::uint32_t*>(memory);
+        auto new_size   = new_offset + new_capacity;
+        auto new_kind   = reinterpret_cast<std::uint16_t*>(new_size + new_capacity);
+        auto new_type   = reinterpret_cast<std::uint8_t*>(new_kind + new_capacity);
+
+        if (_capacity > 0)
+        {
+            std::memcpy(new_offset, offset, _count * sizeof(*offset));
+            std::memcpy(new_size, size, _count * sizeof(*size));
+            std::memcpy(new_kind, kind, _count * sizeof(*kind));
+            std::memcpy(new_type, type, _count * sizeof(*type));
+            _resource->deallocate(_memory, _capacity * node_size, alignof(std::uint32_t));
+        }
+
+        offset    = new_offset;
+        size      = new_size;
+        kind      = new_kind;
+        type      = new_type;
+        _memory   = memory;
+        _capacity = new_capacity;
+    }
+
+    LEXY_EMPTY_MEMBER resource_ptr _resource;
+    unsigned char*                 _memory;
+    std::size_t                    _count, _capacity;
+    bool                           _overflow;
+};
+
+// Maps the names of the productions in a compact parse tree to 16-bit indices.
+template <typename MemoryResource>
+class cpt_production_table
+{
+    using resource_ptr = _detail::memory_resource_ptr<MemoryResource>;
+
+    static constexpr std::uint16_t no_entry = UINT16_MAX;
+
+    struct entry
+    {
+        const char* name;
+        bool        token_production;
+    };
+
+public:
+    //=== constructors/destructors/assignment ===//
+    explicit constexpr cpt_production_table(MemoryResource* resource) noexcept
+    : _resource(resource), _entries(nullptr), _slots(nullptr), _count(0), _capacity(0),
+      _copied_names(false)
+    {}
+
+    cpt_production_table(cpt_production_table&& other) noexcept
+    : _resource(other._resource), _entries(other._entries), _slots(other._slots),
+      _count(other._count), _capacity(other._capacity), _copied_names(other._copied_names)
+    {
+        other._entries  = nullptr;
+        other._slots    = nullptr;
+        other._count    = 0;
+        other._capacity = 0;
+    }
+
+    ~cpt_production_table() noexcept
+    {
+        _deallocate();
+    }
+
+    cpt_production_table& operator=(cpt_production_table&& other) noexcept
+    {
+        lexy::_detail::swap(_resource, other._resource);
+        lexy::_detail::swap(_entries, other._entries);
+        lexy::_detail::swap(_slots, other._slots);
+        lexy::_detail::swap(_count, other._count);
+        lexy::_detail::swap(_capacity, other._capacity);
+        lexy::_detail::swap(_copied_names, other._copied_names);
+        return *this;
+    }
+
+    //=== access ===//
+    std::size_t count() const noexcept
+    {
+        return _count;
+    }
+
+    const char* name(std::uint16_t idx) const noexcept
+    {
+        return _entries[idx].name;
+    }
+    bool has_name(std::uint16_t idx, const char* name) const noexcept
+    {
+        if (_entries[idx].name == name)
+            return true;
+        else if (!_copied_names)
+            // The names are interned, so different pointers mean different names.
+            return false;
+        else
+            return std::strcmp(_entries[idx].name, name) == 0;
+    }
+    bool is_token_production(std::uint16_t idx) const noexcept
+    {
+        return _entries[idx].token_production;
+    }
+
+    //=== modifiers ===//
+    void clear() noexcept
+    {
+        for (auto i = std::size_t(0); i != 2 * _capacity; ++i)
+            _slots[i] = no_entry;
+        _count        = 0;
+        _copied_names = false;
+    }
+
+    // Subsequently inserted names are not the pointers returned by lexy::production_name(),
+    // but copies of them.
+    void set_copied_names() noexcept
+    {
+        _copied_names = true;
+    }
+
+    // Returns the index of the production, adding it if necessary.
+    std::uint16_t insert(const char* name, bool token_production)
+    {
+        if (_count == _capacity)
+            _grow();
+
+        // Names are interned (see parse_tree::node_kind), so we can hash the address.
+        auto slot = _find_slot(name);
+        if (_slots[slot] == no_entry)
+        {
+            LEXY_PRECONDITION(_count < no_entry);
+            _entries[_count] = {name, token_production};
+            _slots[slot]     = std::uint16_t(_count++);
+        }
+        return _slots[slot];
+    }
+
+private:
+    std::size_t _find_slot(const char* name) const noexcept
+    {
+        auto hash = std::size_t(reinterpret_cast<std::uintptr_t>(name) * 0x9e3779b97f4a7c15ull);
+        auto mask = 2 * _capacity - 1;
+        for (auto slot = (hash >> 16) & mask;; slot = (slot + 1) & mask)
+            if (_slots[slot] == no_entry || _entries[_slots[slot]].name == name)
+                return slot;
+    }
+
+    void _grow()
+    {
+        auto old_entries  = _entries;
+        auto old_slots    = _slots;
+        auto old_capacity = _capacity;
+
+        _capacity = _capacity == 0 ? 16 : 2 * _capacity;
+        _entries  = static_cast<entry*>(
+            _resource->allocate(_capacity * sizeof(entry), alignof(entry)));
+        _slots = static_cast<std::uint16_t*>(
+            _resource->allocate(2 * _capacity * sizeof(std::uint16_t), alignof(std::uint16_t)));
+        for (auto i = std::size_t(0); i != 2 * _capacity; ++i)
+            _slots[i] = no_entry;
+
+        for (auto i = std::size_t(0); i != _count; ++i)
+        {
+            _entries[i]                          = old_entries[i];
+            _slots[_find_slot(_entries[i].name)] = std::uint16_t(i);
+        }
+
+        if (old_capacity > 0)
+        {
+            _resource->deallocate(old_entries, old_capacity * sizeof(entry), alignof(entry));
+            _resource->deallocate(old_slots, 2 * old_capacity * sizeof(std::uint16_t),
+                                  alignof(std::uint16_t));
+        }
+    }
+
+    void _deallocate() noexcept
+    {
+        if (_capacity > 0)
+        {
+            _resource->deallocate(_entries, _capacity * sizeof(entry), alignof(entry));
+            _resource->deallocate(_slots, 2 * _capacity * sizeof(std::uint16_t),
+                                  alignof(std::uint16_t));
+        }
+    }
+
+    LEXY_EMPTY_MEMBER resource_ptr _resource;
+    entry*                         _entries;
+    std::uint16_t*                 _slots;
+    std::size_t                    _count, _capacity;
+    bool                           _copied_names;
+};
+} // namespace lexy::_detail
+
+//=== compact_parse_tree ===//
+namespace lexy::_detail
+{
+struct cpt_reparse;
+} // namespace lexy::_detail
+
+namespace lexy
+{
+/// The input or the parse tree is too big for the 32-bit offsets of a compact parse tree.
+struct compact_parse_tree_overflow
+{
+    static LEXY_CONSTEVAL auto name()
+    {
+        return "compact parse tree overflow";
+    }
+};
+
+template <typename Reader, typename TokenKind>
+class mapped_parse_tree;
+
+template <typename Reader, typename TokenKind = void, typename MemoryResource = void>
+class compact_parse_tree
+{
+    static_assert(_detail::is_random_access_iterator<typename Reader::iterator>,
+                  "compact_parse_tree stores offsets into the input");
+
+    using _nodes_t = _detail::cpt_nodes<MemoryResource>;
+
+public:
+    //=== construction ===//
+    class builder;
+
+    constexpr compact_parse_tree()
+    : compact_parse_tree(_detail::get_memory_resource<MemoryResource>())
+    {}
+    constexpr explicit compact_parse_tree(MemoryResource* resource)
+    : _nodes(resource), _productions(resource), _begin(), _depth(0), _had_errors(false)
+    {}
+
+    //=== container access ===//
+    bool empty() const noexcept
+    {
+        return _nodes.count() == 0;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return _nodes.count();
+    }
+
+    std::size_t depth() const noexcept
+    {
+        LEXY_PRECONDITION(!empty());
+        return _depth;
+    }
+
+    void clear() noexcept
+    {
+        _nodes.clear();
+        _productions.clear();
+        _had_errors = false;
+    }
+
+    /// Whether the parse that created the tree raised errors.
+    bool had_errors() const noexcept
+    {
+        return _had_errors;
+    }
+
+    //=== node access ===//
+    class node;
+    class node_kind;
+
+    node root() const noexcept
+    {
+        LEXY_PRECONDITION(!empty());
+        return node(this, 0, 0);
+    }
+
+    //=== traverse ===//
+    class traverse_range;
+
+    traverse_range traverse(const node& n) const noexcept
+    {
+        return traverse_range(n);
+    }
+    traverse_range traverse() const noexcept
+    {
+        if (empty())
+            return traverse_range();
+        else
+            return traverse_range(root());
+    }
+
+private:
+    // The maximal depth of a node in the subtree of the node, relative to it.
+    std::size_t _subtree_depth(std::size_t idx) const noexcept
+    {
+        auto result = std::size_t(0);
+        auto depth  = std::size_t(0);
+        for (auto [event, n] : traverse(node(this, idx, _nodes.production_parent(idx))))
+        {
+            (void)n;
+            if (event == traverse_event::enter)
+            {
+                if (depth > result)
+                    result = depth;
+                ++depth;
+            }
+            else if (event == traverse_event::exit)
+            {
+                --depth;
+            }
+            else if (depth > result)
+            {
+                result = depth;
+            }
+        }
+        return result;
+    }
+
+    // Computes the offsets of the beginning of the first token and the end of the last token of
+    // the subtree of the node; returns false if it doesn't have any tokens.
+    bool _span(std::size_t idx, std::size_t& begin, std::size_t& end) const noexcept
+    {
+        auto last = idx + _nodes.subtree_size(idx);
+
+        auto first_token = idx;
+        while (first_token != last && _nodes.type[first_token] != _nodes_t::type_token)
+            ++first_token;
+        if (first_token == last)
+            return false;
+
+        auto last_token = last - 1;
+        while (_nodes.type[last_token] != _nodes_t::type_token)
+            --last_token;
+
+        begin = _nodes.offset[first_token];
+        end   = _nodes.offset[last_token] + std::size_t(_nodes.size[last_token]);
+        return true;
+    }
+
+    // Replaces the subtree of the production node at idx, which has the given depth, by the
+    // subtree, which was parsed on the new input beginning at begin.
+    // The tokens after the node are moved by shift code units.
+    void _splice(std::size_t idx, std::size_t depth, const compact_parse_tree& subtree,
+                 typename Reader::iterator begin, std::ptrdiff_t shift)
+    {
+        LEXY_PRECONDITION(_nodes.type[idx] == _nodes_t::type_production);
+        LEXY_PRECONDITION(!subtree.empty());
+        auto& sub = subtree._nodes;
+
+        auto old_count     = std::size_t(_nodes.size[idx]);
+        auto new_count     = sub.count();
+        auto count_shift   = std::ptrdiff_t(new_count) - std::ptrdiff_t(old_count);
+        auto old_depth     = _subtree_depth(idx);
+        auto parent_offset = _nodes.offset[idx];
+        auto token_offset  = std::size_t(subtree._begin - begin);
+
+        // Copy the nodes of the subtree, their productions need to use our indices.
+        _nodes.replace(idx, old_count, new_count);
+        for (auto i = std::size_t(0); i != new_count; ++i)
+        {
+            auto offset = std::size_t(sub.offset[i]);
+            auto kind   = sub.kind[i];
+            if (sub.type[i] == _nodes_t::type_token)
+                offset += token_offset;
+            else
+                kind = _productions.insert(subtree._productions.name(kind),
+                                           subtree._productions.is_token_production(kind));
+
+            _nodes.assign(idx + i, sub.type[i], kind, offset, sub.size[i]);
+        }
+        // The root of the subtree has the parent of the node.
+        _nodes.set_offset(idx, parent_offset);
+
+        // Tokens after the node are moved by the edit.
+        // Productions after the node whose parent is before it are now further away from it.
+        for (auto i = idx + new_count; i != _nodes.count(); ++i)
+        {
+            auto offset = std::ptrdiff_t(_nodes.offset[i]);
+            if (_nodes.type[i] == _nodes_t::type_token)
+                offset += shift;
+            else if (std::ptrdiff_t(i) - count_shift - offset < std::ptrdiff_t(idx))
+                offset += count_shift;
+
+            LEXY_PRECONDITION(0 <= offset);
+            _nodes.set_offset(i, std::size_t(offset));
+        }
+
+        // The subtrees of all ancestors changed their size.
+        for (auto cur = idx; cur != 0;)
+        {
+            cur = _nodes.production_parent(cur);
+            _nodes.set_size(cur, std::size_t(std::ptrdiff_t(_nodes.size[cur]) + count_shift));
+        }
+
+        // We only need to look at the entire tree if the node might have been the deepest one.
+        if (depth + subtree._depth >= _depth)
+            _depth = depth + subtree._depth;
+        else if (depth + old_depth == _depth)
+            _depth = _subtree_depth(0);
+
+        _begin = begin;
+    }
+
+    _nodes_t                                      _nodes;
+    _detail::cpt_production_table<MemoryResource> _productions;
+    // The position the token offsets are relative to.
+    typename Reader::iterator _begin;
+    std::size_t               _depth;
+    bool                      _had_errors;
+
+    template <typename, typename>
+    friend class mapped_parse_tree;
+    friend _detail::cpt_reparse;
+};
+
+template <typename Input, typename TokenKind = void, typename MemoryResource = void>
+using compact_parse_tree_for
+    = lexy::compact_parse_tree<lexy::input_reader<Input>, TokenKind, MemoryResource>;
+
+template <typename Reader, typename TokenKind, typename MemoryResource>
+class compact_parse_tree<Reader, TokenKind, MemoryResource>::builder
+{
+    static constexpr auto no_node = std::size_t(-1);
+
+public:
+    class marker
+    {
+    public:
+        marker() : marker(0, no_node, 0) {}
+
+    private:
+        // The index of the first node added after the marker; everything starting there is removed
+        // when we cancel.
+        std::size_t begin;
+        // The current production node.
+        // no_node if using the container API.
+        std::size_t prod;
+        // The production the children are added to.
+        // For a production node, the node itself; for a container node, the enclosing production.
+        std::size_t parent;
+        // The last child that was added, or no_node.
+        std::size_t last_child;
+
+        explicit marker(std::size_t begin, std::size_t prod, std::size_t parent)
+        : begin(begin), prod(prod), parent(parent), last_child(no_node)
+        {}
+
+        friend builder;
+    };
+
+    //=== root node ===//
+    template <typename Production>
+    explicit builder(compact_parse_tree&& tree, Production production,
+                     typename Reader::iterator begin)
+    : _result(LEXY_MOV(tree))
+    {
+        // Empty the initial parse tree.
+        _result.clear();
+        _result._begin = begin;
+        _has_begin     = true;
+
+        // Add the root node, which is its own parent.
+        _result._nodes.push(_nodes_t::type_production, _production_kind(production), 0, 1);
+        _result._depth = 0;
+
+        // Begin construction at the root.
+        _cur = marker(1, 0, 0);
+    }
+    /// Uses the beginning of the first token as the position the tokens are relative to,
+    /// so subsequent tokens must not begin before it.
+    template <typename Production>
+    explicit builder(compact_parse_tree&& tree, Production production)
+    : builder(LEXY_MOV(tree), production, typename Reader::iterator())
+    {
+        _has_begin = false;
+    }
+    template <typename Production>
+    explicit builder(Production production) : builder(compact_parse_tree(), production)
+    {}
+
+    /// Whether a node didn't fit into the 32-bit offsets; the tree is then unusable.
+    bool overflowed() const noexcept
+    {
+        return _result._nodes.overflowed() || _result._nodes.count() > UINT32_MAX;
+    }
+
+    /// Records that the parse raised errors, see compact_parse_tree::had_errors().
+    void set_had_errors() noexcept
+    {
+        _result._had_errors = true;
+    }
+
+    compact_parse_tree&& finish() &&
+    {
+        LEXY_PRECONDITION(_cur.prod == 0);
+        _result._nodes.set_size(0, _result._nodes.count());
+
+        // The tree is stored in preorder, so we can compute the depth in a single pass.
+        _result._depth = _result._subtree_depth(0);
+
+        return LEXY_MOV(_result);
+    }
+
+    //=== production nodes ===//
+    template <typename Production>
+    auto start_production(Production production)
+    {
+        if constexpr (lexy::is_transparent_production<Production>)
+            // Don't need to add a new node for a transparent production.
+            return _cur;
+
+        // We immediately add the node, as its children follow it in preorder.
+        // If we backtrack, it is removed again.
+        auto kind = _production_kind(production);
+        auto node = _result._nodes.count();
+        _result._nodes.push(_nodes_t::type_production, kind, node - _cur.parent, 1);
+
+        // Subsequent insertions are to the new node, so update marker and return old one.
+        auto old = LEXY_MOV(_cur);
+        _cur     = marker(node, node, node);
+        return old;
+    }
+
+    void finish_production(marker&& m)
+    {
+        LEXY_PRECONDITION(_cur.prod != no_node || m.prod == _cur.prod);
+        if (m.prod == _cur.prod)
+            // We're finishing with a transparent production, do nothing.
+            return;
+
+        // The subtree consists of all nodes added since the production.
+        _result._nodes.set_size(_cur.prod, _result._nodes.count() - _cur.prod);
+
+        // Continue with the parent, which now has the production as last child.
+        m.last_child = _cur.prod;
+        _cur         = LEXY_MOV(m);
+    }
+
+    void cancel_production(marker&& m)
+    {
+        LEXY_PRECONDITION(_cur.prod != no_node);
+        if (_cur.prod == m.prod)
+            // We're backtracking a transparent production, do nothing.
+            return;
+
+        _result._nodes.truncate(_cur.begin);
+        // Continue with parent.
+        _cur = LEXY_MOV(m);
+    }
+
+    //=== container nodes ===//
+    marker start_container()
+    {
+        // The children of the container are added directly to the enclosing production.
+        auto old = LEXY_MOV(_cur);
+        _cur     = marker(_result._nodes.count(), no_node, old.parent);
+        return old;
+    }
+
+    template <typename Production>
+    void set_container_production(Production production)
+    {
+        LEXY_PRECONDITION(_cur.prod == no_node);
+        if constexpr (lexy::is_transparent_production<Production>)
+            // If the production is transparent, we do nothing.
+            return;
+
+        // The production contains all the children of the container, so it needs to be inserted
+        // before them. This is linear in the number of nodes of the container, but containers
+        // are only used for operation chains, which are usually short.
+        auto& nodes = _result._nodes;
+        auto  node  = _cur.begin;
+        nodes.insert(node, _nodes_t::type_production, _production_kind(production),
+                     node - _cur.parent, nodes.count() + 1 - node);
+
+        // The production nodes of the container now have the new production as parent.
+        for (auto child = node + 1; child != nodes.count(); child += nodes.subtree_size(child))
+            if (nodes.type[child] == _nodes_t::type_production)
+                nodes.set_offset(child, child - node);
+
+        // And the container continues with the production as its only child.
+        _cur.last_child = node;
+    }
+
+    void finish_container(marker&& m)
+    {
+        LEXY_PRECONDITION(_cur.prod == no_node);
+
+        // The children of our container are already children of the parent.
+        if (_cur.last_child != no_node)
+            m.last_child = _cur.last_child;
+
+        // Continue with the parent.
+        _cur = LEXY_MOV(m);
+    }
+
+    void cancel_container(marker&& m)
+    {
+        LEXY_PRECONDITION(_cur.prod == no_node);
+
+        // Remove everything we've inserted.
+        _result._nodes.truncate(_cur.begin);
+        // Continue with parent.
+        _cur = LEXY_MOV(m);
+    }
+
+    //=== token nodes ===//
+    void token(token_kind<TokenKind> _kind, typename Reader::iterator begin,
+               typename Reader::iterator end)
+    {
+        if (_kind.ignore_if_empty() && begin == end)
+            return;
+
+        auto  kind  = token_kind<TokenKind>::to_raw(_kind);
+        auto& nodes = _result._nodes;
+
+        if (!_has_begin)
+        {
+            _result._begin = begin;
+            _has_begin     = true;
+        }
+        LEXY_PRECONDITION(_result._begin <= begin);
+
+        // We merge error tokens.
+        if (kind == lexy::error_token_kind && _cur.last_child != no_node
+            && nodes.type[_cur.last_child] == _nodes_t::type_token
+            && nodes.kind[_cur.last_child] == lexy::error_token_kind)
+        {
+            // No need to add a new node, just extend the previous one.
+            auto token_begin = _result._begin + nodes.offset[_cur.last_child];
+            nodes.set_size(_cur.last_child, std::size_t(end - token_begin));
+        }
+        else
+        {
+            _cur.last_child = nodes.push(_nodes_t::type_token, kind,
+                                         std::size_t(begin - _result._begin),
+                                         std::size_t(end - begin));
+        }
+    }
+
+private:
+    template <typename Production>
+    std::uint16_t _production_kind(Production)
+    {
+        return _result._productions.insert(lexy::production_name<Production>(),
+                                           lexy::is_token_production<Production>);
+    }
+
+    compact_parse_tree _result;
+    marker             _cur;
+    bool               _has_begin;
+};
+
+template <typename Reader, typename TokenKind, typename MemoryResource>
+class compact_parse_tree<Reader, TokenKind, MemoryResource>::node_kind
+{
+public:
+    bool is_token() const noexcept
+    {
+        return _type() == _nodes_t::type_token;
+    }
+    bool is_production() const noexcept
+    {
+        return _type() == _nodes_t::type_production;
+    }
+
+    bool is_root() const noexcept
+    {
+        return _idx == 0;
+    }
+    bool is_token_production() const noexcept
+    {
+        return is_production() && _tree->_productions.is_token_production(_kind());
+    }
+
+    const char* name() const noexcept
+    {
+        if (is_production())
+            return _tree->_productions.name(_kind());
+        else
+            return token_kind<TokenKind>::from_raw(_kind()).name();
+    }
+
+    friend bool operator==(node_kind lhs, node_kind rhs)
+    {
+        if (lhs.is_token() && rhs.is_token())
+            return lhs._kind() == rhs._kind();
+        else if (lhs.is_production() && rhs.is_production())
+            // See parse_tree::node_kind for rationale why this works.
+            return lhs.name() == rhs.name();
+        else
+            return false;
+    }
+    friend bool operator!=(node_kind lhs, node_kind rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    friend bool operator==(node_kind nk, token_kind<TokenKind> tk)
+    {
+        if (nk.is_token())
+            return token_kind<TokenKind>::from_raw(nk._kind()) == tk;
+        else
+            return false;
+    }
+    friend bool operator==(token_kind<TokenKind> tk, node_kind nk)
+    {
+        return nk == tk;
+    }
+    friend bool operator!=(node_kind nk, token_kind<TokenKind> tk)
+    {
+        return !(nk == tk);
+    }
+    friend bool operator!=(token_kind<TokenKind> tk, node_kind nk)
+    {
+        return !(nk == tk);
+    }
+
+    template <typename Production, typename = lexy::production_rule<Production>>
+    friend bool operator==(node_kind nk, Production)
+    {
+        return nk.is_production() && nk._has_name(lexy::production_name<Production>());
+    }
+    template <typename Production, typename = lexy::production_rule<Production>>
+    friend bool operator==(Production p, node_kind nk)
+    {
+        return nk == p;
+    }
+    template <typename Production, typename = lexy::production_rule<Production>>
+    friend bool operator!=(node_kind nk, Production p)
+    {
+        return !(nk == p);
+    }
+    template <typename Production, typename = lexy::production_rule<Production>>
+    friend bool operator!=(Production p, node_kind nk)
+    {
+        return !(nk == p);
+    }
+
+private:
+    explicit node_kind(const compact_parse_tree* tree, std::size_t idx) : _tree(tree), _idx(idx) {}
+
+    std::uint8_t _type() const noexcept
+    {
+        return _tree->_nodes.type[_idx];
+    }
+    std::uint16_t _kind() const noexcept
+    {
+        return _tree->_nodes.kind[_idx];
+    }
+    bool _has_name(const char* name) const noexcept
+    {
+        return _tree->_productions.has_name(_kind(), name);
+    }
+
+    const compact_parse_tree* _tree;
+    std::size_t               _idx;
+
+    friend compact_parse_tree::node;
+};
+
+template <typename Reader, typename TokenKind, typename MemoryResource>
+class compact_parse_tree<Reader, TokenKind, MemoryResource>::node
+{
+public:
+    const void* address() const noexcept
+    {
+        return _tree->_nodes.kind + _idx;
+    }
+
+    auto kind() const noexcept
+    {
+        return node_kind(_tree, _idx);
+    }
+
+    auto parent() const noexcept
+    {
+        // Tokens don't know their parent, so every node remembers it.
+        // The root has itself as parent.
+        return node(_tree, _parent, _tree->_nodes.production_parent(_parent));
+    }
+
+    class children_range
+    {
+    public:
+        class iterator : public _detail::forward_iterator_base<iterator, node, node, void>
+        {
+        public:
+            iterator() noexcept : _tree(nullptr), _cur(0), _parent(0) {}
+
+            node deref() const noexcept
+            {
+                return node(_tree, _cur, _parent);
+            }
+
+            void increment() noexcept
+            {
+                // The next sibling follows the subtree of the current node.
+                _cur += _tree->_nodes.subtree_size(_cur);
+            }
+
+            bool equal(iterator rhs) const noexcept
+            {
+                return _cur == rhs._cur;
+            }
+
+        private:
+            explicit iterator(const compact_parse_tree* tree, std::size_t cur,
+                              std::size_t parent) noexcept
+            : _tree(tree), _cur(cur), _parent(parent)
+            {}
+
+            const compact_parse_tree* _tree;
+            std::size_t               _cur, _parent;
+
+            friend children_range;
+        };
+
+        bool empty() const noexcept
+        {
+            return begin() == end();
+        }
+
+        std::size_t size() const noexcept
+        {
+            auto result = std::size_t(0);
+            for (auto iter = begin(); iter != end(); ++iter)
+                ++result;
+            return result;
+        }
+
+        iterator begin() const noexcept
+        {
+            // The first child immediately follows the node.
+            return iterator(_tree, _idx + 1, _idx);
+        }
+        iterator end() const noexcept
+        {
+            return iterator(_tree, _idx + _tree->_nodes.subtree_size(_idx), _idx);
+        }
+
+    private:
+        explicit children_range(const compact_parse_tree* tree, std::size_t idx) noexcept
+        : _tree(tree), _idx(idx)
+        {}
+
+        const compact_parse_tree* _tree;
+        std::size_t               _idx;
+
+        friend node;
+    };
+
+    auto children() const noexcept
+    {
+        return children_range(_tree, _idx);
+    }
+
+    class sibling_range
+    {
+    public:
+        class iterator : public _detail::forward_iterator_base<iterator, node, node, void>
+        {
+        public:
+            iterator() noexcept : _tree(nullptr), _cur(0), _parent(0) {}
+
+            node deref() const noexcept
+            {
+                return node(_tree, _cur, _parent);
+            }
+
+            void increment() noexcept
+            {
+                auto& nodes = _tree->_nodes;
+
+                _cur += nodes.subtree_size(_cur);
+                if (_cur == _parent + nodes.subtree_size(_parent))
+                    // We're at the end of the parent, go to first child instead.
+                    _cur = _parent + 1;
+            }
+
+            bool equal(iterator rhs) const noexcept
+            {
+                return _cur == rhs._cur;
+            }
+
+        private:
+            explicit iterator(const compact_parse_tree* tree, std::size_t cur,
+                              std::size_t parent) noexcept
+            : _tree(tree), _cur(cur), _parent(parent)
+            {}
+
+            const compact_parse_tree* _tree;
+            std::size_t               _cur, _parent;
+
+            friend sibling_range;
+        };
+
+        bool empty() const noexcept
+        {
+            return begin() == end();
+        }
+
+        iterator begin() const noexcept
+        {
+            // We begin with the next node after ours.
+            // If we don't have siblings, this is our node itself.
+            if (_idx == _parent)
+                // The root doesn't have siblings.
+                return end();
+            return ++iterator(_tree, _idx, _parent);
+        }
+        iterator end() const noexcept
+        {
+            // We end when we're back at the node.
+            return iterator(_tree, _idx, _parent);
+        }
+
+    private:
+        explicit sibling_range(const compact_parse_tree* tree, std::size_t idx,
+                               std::size_t parent) noexcept
+        : _tree(tree), _idx(idx), _parent(parent)
+        {}
+
+        const compact_parse_tree* _tree;
+        std::size_t               _idx, _parent;
+
+        friend node;
+    };
+
+    auto siblings() const noexcept
+    {
+        return sibling_range(_tree, _idx, _parent);
+    }
+
+    bool is_last_child() const noexcept
+    {
+        // We're the last child if our subtree ends where the subtree of our parent ends.
+        auto& nodes = _tree->_nodes;
+        return _idx + nodes.subtree_size(_idx) == _parent + nodes.subtree_size(_parent);
+    }
+
+    auto lexeme() const noexcept
+    {
+        auto& nodes = _tree->_nodes;
+        if (nodes.type[_idx] == _nodes_t::type_token)
+        {
+            auto begin = _tree->_begin + nodes.offset[_idx];
+            return lexy::lexeme<Reader>(begin, begin + nodes.size[_idx]);
+        }
+        else
+        {
+            return lexy::lexeme<Reader>();
+        }
+    }
+
+    auto token() const noexcept
+    {
+        LEXY_PRECONDITION(kind().is_token());
+
+        auto kind = token_kind<TokenKind>::from_raw(_tree->_nodes.kind[_idx]);
+        return lexy::token<Reader, TokenKind>(kind, lexeme());
+    }
+
+    friend bool operator==(node lhs, node rhs) noexcept
+    {
+        return lhs._tree == rhs._tree && lhs._idx == rhs._idx;
+    }
+    friend bool operator!=(node lhs, node rhs) noexcept
+    {
+        return !(lhs == rhs);
+    }
+
+private:
+    explicit node(const compact_parse_tree* tree, std::size_t idx, std::size_t parent) noexcept
+    : _tree(tree), _idx(std::uint32_t(idx)), _parent(std::uint32_t(parent))
+    {}
+
+    const compact_parse_tree* _tree;
+    std::uint32_t             _idx, _parent;
+
+    friend compact_parse_tree;
+};
+
+template <typename Reader, typename TokenKind, typename MemoryResource>
+class compact_parse_tree<Reader, TokenKind, MemoryResource>::traverse_range
+{
+public:
+    using event = traverse_event;
+
+    struct _value_type
+    {
+        traverse_event           event;
+        compact_parse_tree::node node;
+    };
+
+    class iterator : public _detail::forward_iterator_base<iterator, _value_type, _value_type, void>
+    {
+    public:
+        iterator() noexcept = default;
+
+        _value_type deref() const noexcept
+        {
+            return {_ev, node(_tree, _cur, _parent)};
+        }
+
+        void increment() noexcept
+        {
+            auto& nodes = _tree->_nodes;
+            if (_ev == traverse_event::enter && nodes.size[_cur] > 1)
+            {
+                // We go to the first child next, which immediately follows in preorder.
+                _parent = _cur;
+                ++_cur;
+                _ev = _event_of(_cur);
+            }
+            else if (_ev == traverse_event::enter)
+            {
+                // Don't have children, exit.
+                _ev = traverse_event::exit;
+            }
+            else if (_cur == _parent)
+            {
+                // We've exited the root, so we're done.
+                _cur = nodes.count();
+            }
+            else
+            {
+                auto next = _cur + nodes.subtree_size(_cur);
+                if (next != _parent + nodes.size[_parent])
+                {
+                    // We have a sibling.
+                    _cur = next;
+                    _ev  = _event_of(_cur);
+                }
+                else
+                {
+                    // We go back to the parent for the second time.
+                    _cur    = _parent;
+                    _parent = nodes.production_parent(_parent);
+                    _ev     = traverse_event::exit;
+                }
+            }
+        }
+
+        bool equal(iterator rhs) const noexcept
+        {
+            return _ev == rhs._ev && _cur == rhs._cur;
+        }
+
+    private:
+        traverse_event _event_of(std::size_t idx) const noexcept
+        {
+            if (_tree->_nodes.type[idx] == _nodes_t::type_token)
+                return traverse_event::leaf;
+            else
+                return traverse_event::enter;
+        }
+
+        const compact_parse_tree* _tree   = nullptr;
+        std::size_t               _cur    = 0;
+        std::size_t               _parent = 0;
+        traverse_event            _ev;
+
+        friend traverse_range;
+    };
+
+    bool empty() const noexcept
+    {
+        return _begin == _end;
+    }
+
+    iterator begin() const noexcept
+    {
+        return _begin;
+    }
+
+    iterator end() const noexcept
+    {
+        return _end;
+    }
+
+private:
+    traverse_range() noexcept = default;
+    traverse_range(node n) noexcept
+    {
+        _begin._tree   = n._tree;
+        _begin._cur    = n._idx;
+        _begin._parent = n._parent;
+
+        if (n.kind().is_token())
+        {
+            _begin._ev = traverse_event::leaf;
+
+            _end = _detail::next(_begin);
+        }
+        else
+        {
+            _begin._ev = traverse_event::enter;
+
+            _end     = _begin;
+            _end._ev = traverse_event::exit;
+            ++_end; // half-open range
+        }
+    }
+
+    iterator _begin, _end;
+
+    friend compact_parse_tree;
+};
+} // namespace lexy
+
+#endif // LEXY_COMPACT_PARSE_TREE_HPP_INCLUDED
+
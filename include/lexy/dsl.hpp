@@ -17,6 +17,7 @@
 #include <lexy/dsl/choice.hpp>
 #include <lexy/dsl/code_point.hpp>
 #include <lexy/dsl/combination.hpp>
+#include <lexy/dsl/commit.hpp>
 #include <lexy/dsl/context_counter.hpp>
 #include <lexy/dsl/context_flag.hpp>
 #include <lexy/dsl/context_identifier.hpp>
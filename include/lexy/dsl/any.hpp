@@ -20,8 +20,17 @@ struct _any : token_base<_any, unconditional_branch_base>
 
         constexpr std::true_type try_parse(Reader reader)
         {
-            while (reader.peek() != Reader::encoding::eof())
-                reader.bump();
+            if constexpr (lexy::_detail::is_contiguous_reader<Reader>)
+            {
+                // We know where the input ends, so we can jump there directly.
+                reader.advance(reader.remaining().size());
+            }
+            else
+            {
+                while (reader.peek() != Reader::encoding::eof())
+                    reader.bump();
+            }
+
             end = reader.position();
             return {};
         }
@@ -30,12 +30,23 @@ struct _b : token_base<_b<N>>
         {
             static_assert(std::is_same_v<typename Reader::encoding, lexy::byte_encoding>);
 
-            // Bump N times.
-            auto result = ((reader.peek() == Reader::encoding::eof() ? ((void)Idx, false)
-                                                                     : (reader.bump(), true))
-                           && ...);
-            end         = reader.position();
-            return result;
+            if constexpr (lexy::_detail::is_contiguous_reader<Reader>)
+            {
+                // Consume as many bytes as are available at once.
+                auto available = reader.remaining().size();
+                reader.advance(available < N ? available : N);
+                end = reader.position();
+                return available >= N;
+            }
+            else
+            {
+                // Bump N times.
+                auto result = ((reader.peek() == Reader::encoding::eof() ? ((void)Idx, false)
+                                                                         : (reader.bump(), true))
+                               && ...);
+                end         = reader.position();
+                return result;
+            }
         }
 
         template <typename Context>
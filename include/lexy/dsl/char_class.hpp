@@ -5,6 +5,7 @@
 #define LEXY_DSL_CHAR_CLASS_HPP_INCLUDED
 
 #include <lexy/_detail/code_point.hpp>
+#include <lexy/_detail/simd.hpp>
 #include <lexy/dsl/base.hpp>
 #include <lexy/dsl/token.hpp>
 
@@ -157,6 +158,90 @@ struct ascii_set_matcher<CompressedAsciiSet, index_sequence<RangeIdx...>,
             // or one of the single characters.
             || ((cur == to_int_type<Encoding>(CompressedAsciiSet.singles[SingleIdx])) || ...);
     }
+
+#if LEXY_HAS_SSE2
+    template <char Lower, char Upper>
+    static __m128i _sse2_match_range(__m128i chunk)
+    {
+        // Non-ASCII code units are negative, so they are never in the range.
+        auto result = _mm_cmpgt_epi8(chunk, _mm_set1_epi8(char(Lower - 1)));
+        if constexpr (Upper != 0x7F)
+            result = _mm_and_si128(result, _mm_cmplt_epi8(chunk, _mm_set1_epi8(char(Upper + 1))));
+        return result;
+    }
+
+    static __m128i _sse2_match([[maybe_unused]] __m128i chunk)
+    {
+        constexpr auto& set    = CompressedAsciiSet;
+        auto            result = _mm_setzero_si128();
+        ((result = _mm_or_si128(result, _sse2_match_range<set.range_lower[RangeIdx],
+                                                          set.range_upper[RangeIdx]>(chunk))),
+         ...);
+        ((result = _mm_or_si128(result,
+                                _mm_cmpeq_epi8(chunk, _mm_set1_epi8(set.singles[SingleIdx])))),
+         ...);
+        return result;
+    }
+#endif
+
+#if LEXY_HAS_AVX2
+    template <char Lower, char Upper>
+    static __m256i _avx2_match_range(__m256i chunk)
+    {
+        // Non-ASCII code units are negative, so they are never in the range.
+        auto result = _mm256_cmpgt_epi8(chunk, _mm256_set1_epi8(char(Lower - 1)));
+        if constexpr (Upper != 0x7F)
+            result = _mm256_and_si256(result,
+                                      _mm256_cmpgt_epi8(_mm256_set1_epi8(char(Upper + 1)), chunk));
+        return result;
+    }
+
+    static __m256i _avx2_match([[maybe_unused]] __m256i chunk)
+    {
+        constexpr auto& set    = CompressedAsciiSet;
+        auto            result = _mm256_setzero_si256();
+        ((result = _mm256_or_si256(result, _avx2_match_range<set.range_lower[RangeIdx],
+                                                             set.range_upper[RangeIdx]>(chunk))),
+         ...);
+        ((result = _mm256_or_si256(result, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(
+                                                                        set.singles[SingleIdx])))),
+         ...);
+        return result;
+    }
+#endif
+
+    // Returns the first code unit in [cur, end) that is not in the set.
+    // Requires a single byte encoding; only ASCII characters can be in the set.
+    template <typename Encoding>
+    static const typename Encoding::char_type* find_first_not_of(
+        const typename Encoding::char_type* cur, const typename Encoding::char_type* end)
+    {
+        static_assert(sizeof(typename Encoding::char_type) == 1);
+
+#if LEXY_HAS_AVX2
+        for (; end - cur >= 32; cur += 32)
+        {
+            auto chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cur));
+            auto mask  = static_cast<unsigned>(_mm256_movemask_epi8(_avx2_match(chunk)));
+            if (mask != 0xFFFF'FFFFu)
+                return cur + countr_zero(~mask);
+        }
+#endif
+#if LEXY_HAS_SSE2
+        for (; end - cur >= 16; cur += 16)
+        {
+            auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur));
+            auto mask  = static_cast<unsigned>(_mm_movemask_epi8(_sse2_match(chunk)));
+            if (mask != 0xFFFFu)
+                return cur + countr_zero(~mask);
+        }
+#endif
+
+        // Match the remaining code units one at a time.
+        while (cur != end && match<Encoding>(Encoding::to_int_type(*cur)))
+            ++cur;
+        return cur;
+    }
 };
 } // namespace lexy::_detail
 
@@ -248,6 +333,43 @@ struct char_class_base : token_base<Derived>, _char_class_base
 };
 } // namespace lexyd
 
+namespace lexy::_detail
+{
+// Whether the reader is a contiguous reader over single byte code units.
+template <typename Reader>
+constexpr bool is_byte_pointer_reader
+    = sizeof(typename Reader::encoding::char_type) == 1 && is_contiguous_reader<Reader>;
+
+// Consumes characters as long as they match the char class.
+// Equivalent to `while (lexy::try_match_token(CharClass{}, reader)) {}`.
+template <typename CharClass, typename Reader>
+constexpr void skip_char_class_run(CharClass, Reader& reader)
+{
+    using encoding = typename Reader::encoding;
+    if constexpr (is_byte_pointer_reader<Reader>)
+    {
+        // We know where the input ends, so we can skip a run of ASCII characters at once.
+        // Only non-ASCII characters need to go through the regular char class matching.
+        using matcher = ascii_set_matcher<lexyd::_cas<CharClass>>;
+        do
+        {
+            if (!is_constant_evaluated())
+            {
+                auto remaining = reader.remaining();
+                auto end       = matcher::template find_first_not_of<encoding>(remaining.begin(),
+                                                                               remaining.end());
+                reader.advance(std::size_t(end - remaining.begin()));
+            }
+        } while (lexy::try_match_token(CharClass{}, reader));
+    }
+    else
+    {
+        while (lexy::try_match_token(CharClass{}, reader))
+        {}
+    }
+}
+} // namespace lexy::_detail
+
 #define LEXY_CHAR_CLASS(Name, Rule)                                                                \
     [] {                                                                                           \
         static_assert(::lexy::is_char_class_rule<LEXY_DECAY_DECLTYPE(Rule)>);                      \
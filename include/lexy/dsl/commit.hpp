@@ -0,0 +1,38 @@
+// Copyright (C) 2020-2022 Jonathan Müller and lexy contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#ifndef LEXY_DSL_COMMIT_HPP_INCLUDED
+#define LEXY_DSL_COMMIT_HPP_INCLUDED
+
+#include <lexy/dsl/base.hpp>
+
+namespace lexy::_detail
+{
+template <typename Reader>
+using _detect_commit = decltype(LEXY_DECLVAL(Reader&).commit());
+} // namespace lexy::_detail
+
+namespace lexyd
+{
+struct _commit : rule_base
+{
+    template <typename NextParser>
+    struct p
+    {
+        template <typename Context, typename Reader, typename... Args>
+        LEXY_PARSER_FUNC static bool parse(Context& context, Reader& reader, Args&&... args)
+        {
+            // Only readers of streaming inputs can release the input before the position.
+            if constexpr (lexy::_detail::is_detected<lexy::_detail::_detect_commit, Reader>)
+                reader.commit();
+
+            return NextParser::parse(context, reader, LEXY_FWD(args)...);
+        }
+    };
+};
+
+/// Marks the current position as one that is never backtracked before.
+constexpr auto commit = _commit{};
+} // namespace lexyd
+
+#endif // LEXY_DSL_COMMIT_HPP_INCLUDED
@@ -143,19 +143,164 @@ struct _del_limit<void, Error>
     }
 };
 
+// The ASCII characters a rule can start with, if we know them.
+template <typename Rule, typename = void>
+struct _del_start
+{
+    static constexpr bool known = false;
+
+    static LEXY_CONSTEVAL void insert(lexy::_detail::ascii_set&) {}
+};
+template <typename CharClass>
+struct _del_start<CharClass, std::enable_if_t<lexy::is_char_class_rule<CharClass>>>
+{
+    static constexpr bool known = true;
+
+    static LEXY_CONSTEVAL void insert(lexy::_detail::ascii_set& set)
+    {
+        set.insert(CharClass::char_class_ascii());
+    }
+};
+template <typename CharT, CharT C, CharT... Cs>
+struct _del_start<_lit<CharT, C, Cs...>>
+{
+    static constexpr bool known = true;
+
+    static LEXY_CONSTEVAL void insert(lexy::_detail::ascii_set& set)
+    {
+        // A non-ASCII code unit is never skipped anyway.
+        if (std::make_unsigned_t<CharT>(C) < 0x80)
+            set.insert(int(C));
+    }
+};
+template <char32_t Cp, char32_t... Cps>
+struct _del_start<_lcp<Cp, Cps...>>
+{
+    static constexpr bool known = true;
+
+    static LEXY_CONSTEVAL void insert(lexy::_detail::ascii_set& set)
+    {
+        if (Cp < 0x80)
+            set.insert(int(Cp));
+    }
+};
+template <typename Token, typename Error>
+struct _del_start<_del_limit<Token, Error>> : _del_start<Token>
+{};
+template <typename Error>
+struct _del_start<_del_limit<void, Error>>
+{
+    // Only EOF, which is never skipped.
+    static constexpr bool known = true;
+
+    static LEXY_CONSTEVAL void insert(lexy::_detail::ascii_set&) {}
+};
+
 template <typename Close, typename Char, typename Limit, typename... Escapes>
 struct _del : rule_base
 {
     using _limit = std::conditional_t<std::is_void_v<Limit> || lexy::is_token_rule<Limit>,
                                       _del_limit<Limit>, Limit>;
 
+    // The ASCII characters that are always added to the current character sequence:
+    // they match Char but can't start the closing delimiter, limit, or an escape sequence.
+    struct _plain_chars
+    {
+        static constexpr bool known
+            = _del_start<Close>::known && _del_start<_limit>::known
+              && (_del_start<typename Escapes::escape_token>::known && ...);
+
+        static LEXY_CONSTEVAL auto char_class_ascii()
+        {
+            lexy::_detail::ascii_set excluded;
+            _del_start<Close>::insert(excluded);
+            _del_start<_limit>::insert(excluded);
+            (_del_start<typename Escapes::escape_token>::insert(excluded), ...);
+
+            auto result = Char::char_class_ascii();
+            result.remove(excluded);
+            return result;
+        }
+    };
+
+    template <typename Reader>
+    static constexpr void _skip_plain_chars(Reader& reader)
+    {
+        using encoding = typename Reader::encoding;
+        if constexpr (_plain_chars::known && lexy::_detail::is_byte_pointer_reader<Reader>)
+        {
+            if (lexy::_detail::is_constant_evaluated())
+                return;
+
+            using matcher  = lexy::_detail::ascii_set_matcher<_cas<_plain_chars>>;
+            auto remaining = reader.remaining();
+            auto end       = matcher::template find_first_not_of<encoding>(remaining.begin(),
+                                                                           remaining.end());
+            reader.advance(std::size_t(end - remaining.begin()));
+        }
+        else
+        {
+            (void)reader;
+        }
+    }
+
+    // The ASCII characters that can't start the closing delimiter.
+    struct _non_close_chars
+    {
+        static LEXY_CONSTEVAL auto char_class_ascii()
+        {
+            lexy::_detail::ascii_set close;
+            _del_start<Close>::insert(close);
+
+            lexy::_detail::ascii_set result;
+            result.insert(0x00, 0x7F);
+            result.remove(close);
+            return result;
+        }
+    };
+
+    // Gives the sink a lower bound for the size of the content:
+    // it can't end before the next character that could start the closing delimiter.
+    template <typename Reader, typename Sink>
+    static constexpr void _reserve(typename Reader::iterator del_begin, const Reader& reader,
+                                   Sink& sink)
+    {
+        using encoding = typename Reader::encoding;
+        if constexpr (_del_start<Close>::known && lexy::_detail::is_byte_pointer_reader<Reader>
+                      && lexy::_has_reserve<Sink>)
+        {
+            if (lexy::_detail::is_constant_evaluated())
+                return;
+
+            // We stop at the first non-ASCII character as well, it might start the delimiter.
+            using matcher  = lexy::_detail::ascii_set_matcher<_cas<_non_close_chars>>;
+            auto remaining = reader.remaining();
+            auto end       = matcher::template find_first_not_of<encoding>(remaining.begin(),
+                                                                           remaining.end());
+            sink.reserve(std::size_t(end - del_begin));
+        }
+        else
+        {
+            (void)del_begin;
+            (void)reader;
+            (void)sink;
+        }
+    }
+
     template <typename CloseParser, typename Context, typename Reader, typename Sink>
     static constexpr bool _loop(CloseParser& close, Context& context, Reader& reader, Sink& sink)
     {
         auto                     del_begin = reader.position();
         _del_chars<Char, Reader> cur_chars(reader);
-        while (!close.try_parse(context.control_block, reader))
+        auto                     reserved = false;
+        while (true)
         {
+            // Skip characters that would end up in the current sequence anyway.
+            // This doesn't change anything, as the sequence is only reported once it's finished.
+            _skip_plain_chars(reader);
+
+            if (close.try_parse(context.control_block, reader))
+                break;
             close.cancel(context);
 
             // Check for missing delimiter.
@@ -172,8 +317,16 @@ struct _del : rule_base
 
             // Check for escape sequences.
             if ((Escapes::_try_parse(context, reader, sink, cur_chars) || ...))
+            {
                 // We had an escape sequence, so do nothing in this iteration.
+                // As the content now consists of multiple pieces, it's worth reserving memory.
+                if (!reserved)
+                {
+                    _reserve(del_begin, reader, sink);
+                    reserved = true;
+                }
                 continue;
+            }
 
             // Parse the next character.
             cur_chars.parse(context, reader, sink);
@@ -300,6 +453,8 @@ namespace lexyd
 template <typename Escape, typename... Branches>
 struct _escape : _escape_base
 {
+    using escape_token = Escape;
+
     template <typename Context, typename Reader, typename Sink, typename Char>
     static constexpr bool _try_parse(Context& context, Reader& reader, Sink& sink,
                                      _del_chars<Char, Reader>& cur_chars)
@@ -4,6 +4,7 @@
 #ifndef LEXY_DSL_IDENTIFIER_HPP_INCLUDED
 #define LEXY_DSL_IDENTIFIER_HPP_INCLUDED
 
+#include <lexy/_detail/perfect_hash.hpp>
 #include <lexy/dsl/base.hpp>
 #include <lexy/dsl/char_class.hpp>
 #include <lexy/dsl/literal.hpp>
@@ -27,6 +28,8 @@ namespace lexyd
 {
 template <typename Id, typename CharT, CharT... C>
 struct _kw;
+template <typename Leading, typename Trailing, typename... ReservedPredicate>
+struct _id;
 
 template <typename Leading, typename Trailing>
 struct _idp : token_base<_idp<Leading, Trailing>>
@@ -45,8 +48,7 @@ struct _idp : token_base<_idp<Leading, Trailing>>
                 return false;
 
             // Match zero or more trailing characters.
-            while (lexy::try_match_token(Trailing{}, reader))
-            {}
+            lexy::_detail::skip_char_class_run(Trailing{}, reader);
 
             end = reader.position();
             return true;
@@ -60,15 +62,59 @@ struct _idp : token_base<_idp<Leading, Trailing>>
     };
 };
 
+template <typename Literal>
+struct _idrp_string // the string of a literal that can be hashed
+{
+    using type = void;
+};
+template <typename CharT, CharT... C>
+struct _idrp_string<_lit<CharT, C...>>
+{
+    using type = lexy::_detail::type_string<CharT, C...>;
+};
+
 template <typename Set>
 struct _idrp // reserve predicate
 {
+    template <typename... Literals>
+    static constexpr bool _can_hash(_lset<Literals...>)
+    {
+        return sizeof...(Literals) >= lexy::_detail::string_perfect_hash_min_key_count
+               && (!std::is_void_v<typename _idrp_string<Literals>::type> && ...);
+    }
+
+    template <typename Encoding, typename... Literals>
+    static LEXY_CONSTEVAL auto _build_hash(_lset<Literals...>)
+    {
+        using char_type = typename Encoding::char_type;
+        constexpr const char_type* strings[]
+            = {_idrp_string<Literals>::type::template c_str<char_type>...};
+        constexpr std::size_t lengths[] = {_idrp_string<Literals>::type::size...};
+        return lexy::_detail::string_perfect_hash<char_type, sizeof...(Literals)>(strings,
+                                                                                  lengths);
+    }
+    template <typename Encoding>
+    static constexpr auto _hash = _build_hash<Encoding>(typename Set::as_lset{});
+
     template <typename Input>
     static constexpr bool is_reserved(const Input& input)
     {
         auto reader = input.reader();
-        return lexy::try_match_token(Set{}, reader)
-               && reader.peek() == decltype(reader)::encoding::eof();
+        using reader_type = decltype(reader);
+        if constexpr (lexy::_detail::is_contiguous_reader<reader_type>
+                      && _can_hash(typename Set::as_lset{}))
+        {
+            // We know the entire identifier, so we can hash it instead of matching the trie.
+            using encoding = typename reader_type::encoding;
+
+            auto id = reader.remaining();
+            return _hash<encoding>.find(id.data(), id.size()) != _hash<encoding>.no_key;
+        }
+        else
+        {
+            return lexy::try_match_token(Set{}, reader)
+                   && reader.peek() == reader_type::encoding::eof();
+        }
     }
 };
 template <typename Set>
@@ -87,12 +133,18 @@ struct _idcp // reserve contains predicate
     template <typename Input>
     static constexpr bool is_reserved(const Input& input)
     {
+        using encoding = typename decltype(input.reader())::encoding;
+        using lset     = typename Set::as_lset;
+
         auto reader = input.reader();
         while (true)
         {
+            // We only need to try the set where one of its literals begins.
+            lexy::_detail::lit_trie_skip<lset::template _t<encoding>>(reader);
+
             if (lexy::try_match_token(Set{}, reader))
                 return true;
-            else if (reader.peek() == decltype(reader)::encoding::eof())
+            else if (reader.peek() == encoding::eof())
                 return false;
             else
                 reader.bump();
@@ -107,13 +159,17 @@ struct _idsp // reserve suffix predicate
     template <typename Input>
     static constexpr bool is_reserved(const Input& input)
     {
+        using encoding = typename decltype(input.reader())::encoding;
+        using lset     = typename Set::as_lset;
+
         auto reader = input.reader();
         while (true)
         {
-            if (lexy::try_match_token(Set{}, reader)
-                && reader.peek() == decltype(reader)::encoding::eof())
+            lexy::_detail::lit_trie_skip<lset::template _t<encoding>>(reader);
+
+            if (lexy::try_match_token(Set{}, reader) && reader.peek() == encoding::eof())
                 return true;
-            else if (reader.peek() == decltype(reader)::encoding::eof())
+            else if (reader.peek() == encoding::eof())
                 return false;
             else
                 reader.bump();
@@ -123,6 +179,28 @@ struct _idsp // reserve suffix predicate
     }
 };
 
+// Adds the predicate to the identifier, merging its set with the one of an existing predicate of
+// the same kind, so each kind only requires a single match.
+template <template <typename> typename Predicate, typename Set, typename Id, typename... Rest>
+struct _id_reserve;
+template <template <typename> typename Predicate, typename Set, typename L, typename T,
+          typename... Done>
+struct _id_reserve<Predicate, Set, _id<L, T, Done...>>
+{
+    using type = _id<L, T, Done..., Predicate<Set>>;
+};
+template <template <typename> typename Predicate, typename Set, typename L, typename T,
+          typename... Done, typename Old, typename... Rest>
+struct _id_reserve<Predicate, Set, _id<L, T, Done...>, Predicate<Old>, Rest...>
+{
+    using type = _id<L, T, Done..., Predicate<decltype(Old{} / Set{})>, Rest...>;
+};
+template <template <typename> typename Predicate, typename Set, typename L, typename T,
+          typename... Done, typename Head, typename... Rest>
+struct _id_reserve<Predicate, Set, _id<L, T, Done...>, Head, Rest...>
+: _id_reserve<Predicate, Set, _id<L, T, Done..., Head>, Rest...>
+{};
+
 template <typename Leading, typename Trailing, typename... ReservedPredicate>
 struct _id : branch_base
 {
@@ -212,7 +290,8 @@ struct _id : branch_base
     {
         static_assert(sizeof...(R) > 0);
         auto set = (lexyd::literal_set() / ... / _make_reserve(r));
-        return _id<Leading, Trailing, ReservedPredicate..., _idrp<decltype(set)>>{};
+        using id = _id<Leading, Trailing>;
+        return typename _id_reserve<_idrp, decltype(set), id, ReservedPredicate...>::type{};
     }
 
     /// Reserves everything starting with the given rule.
@@ -221,7 +300,8 @@ struct _id : branch_base
     {
         static_assert(sizeof...(R) > 0);
         auto set = (lexyd::literal_set() / ... / _make_reserve(r));
-        return _id<Leading, Trailing, ReservedPredicate..., _idpp<decltype(set)>>{};
+        using id = _id<Leading, Trailing>;
+        return typename _id_reserve<_idpp, decltype(set), id, ReservedPredicate...>::type{};
     }
 
     /// Reservers everything containing the given rule.
@@ -230,7 +310,8 @@ struct _id : branch_base
     {
         static_assert(sizeof...(R) > 0);
         auto set = (lexyd::literal_set() / ... / _make_reserve(r));
-        return _id<Leading, Trailing, ReservedPredicate..., _idcp<decltype(set)>>{};
+        using id = _id<Leading, Trailing>;
+        return typename _id_reserve<_idcp, decltype(set), id, ReservedPredicate...>::type{};
     }
 
     /// Reserves everything that ends with the given rule.
@@ -239,7 +320,8 @@ struct _id : branch_base
     {
         static_assert(sizeof...(R) > 0);
         auto set = (lexyd::literal_set() / ... / _make_reserve(r));
-        return _id<Leading, Trailing, ReservedPredicate..., _idsp<decltype(set)>>{};
+        using id = _id<Leading, Trailing>;
+        return typename _id_reserve<_idsp, decltype(set), id, ReservedPredicate...>::type{};
     }
 
     /// Matches every identifier, ignoring reserved ones.
@@ -4,10 +4,12 @@
 #ifndef LEXY_DSL_LITERAL_HPP_INCLUDED
 #define LEXY_DSL_LITERAL_HPP_INCLUDED
 
+#include <cstring>
 #include <lexy/_detail/code_point.hpp>
 #include <lexy/_detail/integer_sequence.hpp>
 #include <lexy/_detail/iterator.hpp>
 #include <lexy/_detail/nttp_string.hpp>
+#include <lexy/_detail/simd.hpp>
 #include <lexy/dsl/base.hpp>
 #include <lexy/dsl/token.hpp>
 
@@ -24,23 +26,28 @@ struct lit_trie
     static constexpr auto max_transition_count
         = max_node_count == 1 ? 1 : max_node_count - 1; // it is a tree
     static constexpr auto node_no_match = std::size_t(-1);
+    static constexpr auto no_transition = std::size_t(-1);
 
     std::size_t node_count;
     std::size_t node_value[max_node_count];
     // Index of a char class that must not match at the end.
     // This is used for keywords.
     std::size_t node_char_class[max_node_count];
+    // The transitions of a node form a linked list, in the order they were inserted.
+    // That way, neither insert() nor the matcher need to look at the transitions of other nodes.
+    std::size_t node_transition[max_node_count];
 
     char_type   transition_char[max_transition_count];
-    std::size_t transition_from[max_transition_count];
     std::size_t transition_to[max_transition_count];
+    std::size_t transition_next[max_transition_count];
 
     LEXY_CONSTEVAL lit_trie()
-    : node_count(1), node_value{}, node_char_class{}, transition_char{}, transition_from{},
-      transition_to{}
+    : node_count(1), node_value{}, node_char_class{}, node_transition{}, transition_char{},
+      transition_to{}, transition_next{}
     {
         node_value[0]      = node_no_match;
         node_char_class[0] = sizeof...(CharClasses);
+        node_transition[0] = no_transition;
     }
 
     template <typename CharT>
@@ -49,23 +56,28 @@ struct lit_trie
         auto c = transcode_char<char_type>(_c);
 
         // We need to find a transition.
-        // In a tree, we're always having node_count - 1 transitions, so that's the upper bound.
-        // Everytime we add a transition from a node, its transition index is >= its node index.
-        // As such, we start looking at the node index.
-        for (auto i = from; i != node_count - 1; ++i)
+        auto last = no_transition;
+        for (auto i = node_transition[from]; i != no_transition; i = transition_next[i])
         {
-            if (transition_from[i] == from && transition_char[i] == c)
+            if (transition_char[i] == c)
                 return transition_to[i];
+            last = i;
         }
 
         auto to             = node_count;
         node_value[to]      = node_no_match;
         node_char_class[to] = sizeof...(CharClasses);
+        node_transition[to] = no_transition;
 
+        // In a tree, we're always having node_count - 1 transitions.
         auto trans             = node_count - 1;
         transition_char[trans] = c;
-        transition_from[trans] = from; // trans >= from as from < node_count
         transition_to[trans]   = to;
+        transition_next[trans] = no_transition;
+        if (last == no_transition)
+            node_transition[from] = trans;
+        else
+            transition_next[last] = trans;
 
         ++node_count;
         return to;
@@ -76,6 +88,23 @@ struct lit_trie
     {
         return ((pos = insert(pos, C)), ...);
     }
+
+    LEXY_CONSTEVAL std::size_t transition_count(std::size_t node) const
+    {
+        auto count = std::size_t(0);
+        for (auto i = node_transition[node]; i != no_transition; i = transition_next[i])
+            ++count;
+        return count;
+    }
+
+    // Returns the index of the nth transition of the node.
+    LEXY_CONSTEVAL std::size_t transition(std::size_t node, std::size_t n) const
+    {
+        auto i = node_transition[node];
+        for (; n > 0; --n)
+            i = transition_next[i];
+        return i;
+    }
 };
 
 template <typename... CharClasses>
@@ -131,51 +160,95 @@ template <std::size_t CharClassIdx, typename... CharClasses>
 using _node_char_class
     = _node_char_class_impl<CharClassIdx, (CharClassIdx < sizeof...(CharClasses)), CharClasses...>;
 
+// Nodes with at least that many transitions dispatch using a jump table over the next code unit.
+// Below that, comparing against each transition is cheaper than the indirect call.
+constexpr std::size_t lit_trie_jump_table_min_transitions = 8;
+
+struct lit_trie_jump_table
+{
+    // Index of the transition in the list of the current node plus one, zero if there is none.
+    unsigned short index[256];
+};
+
 template <const auto& Trie, std::size_t CurNode,
-          // Same bounds as in the for loop of insert().
-          typename Indices = make_index_sequence<(Trie.node_count - 1) - CurNode>>
+          typename Indices = make_index_sequence<Trie.transition_count(CurNode)>>
 struct lit_trie_matcher;
 template <typename Encoding, std::size_t N, typename... CharClasses,
           const lit_trie<Encoding, N, CharClasses...>& Trie, std::size_t CurNode,
           std::size_t... Indices>
 struct lit_trie_matcher<Trie, CurNode, index_sequence<Indices...>>
 {
+    static constexpr auto _use_jump_table
+        = sizeof(typename Encoding::char_type) == 1
+          && sizeof...(Indices) >= lit_trie_jump_table_min_transitions;
+
+    static LEXY_CONSTEVAL auto _make_jump_table()
+    {
+        lit_trie_jump_table result{};
+        for (auto idx = std::size_t(0); idx != sizeof...(Indices); ++idx)
+        {
+            auto trans_idx  = Trie.transition(CurNode, idx);
+            auto c          = static_cast<unsigned char>(Trie.transition_char[trans_idx]);
+            result.index[c] = static_cast<unsigned short>(idx + 1);
+        }
+        return result;
+    }
+    static constexpr lit_trie_jump_table _jump_table = _make_jump_table();
+
+    template <typename Reader>
+    using _child_fn = std::size_t (*)(Reader&);
+
+    template <std::size_t Idx, typename Reader>
+    static constexpr _child_fn<Reader> _child()
+    {
+        constexpr auto trans_idx = Trie.transition(CurNode, Idx);
+        using child              = lit_trie_matcher<Trie, Trie.transition_to[trans_idx]>;
+        return &child::template try_match<Reader>;
+    }
+    template <typename Reader>
+    static constexpr _child_fn<Reader> _children[] = {_child<Indices, Reader>()...};
+
     template <std::size_t Idx, typename Reader, typename IntT>
     LEXY_FORCE_INLINE static constexpr bool _try_transition(std::size_t& result, Reader& reader,
                                                             IntT cur)
     {
-        constexpr auto trans_idx = CurNode + Idx;
-        if constexpr (Trie.transition_from[trans_idx] == CurNode)
-        {
-            using encoding            = typename Reader::encoding;
-            constexpr auto trans_char = Trie.transition_char[trans_idx];
-            if (cur != encoding::to_int_type(trans_char))
-                return false;
-
-            reader.bump();
-            result = lit_trie_matcher<Trie, Trie.transition_to[trans_idx]>::try_match(reader);
-            return true;
-        }
-        else
-        {
-            (void)result;
-            (void)reader;
-            (void)cur;
+        constexpr auto trans_idx = Trie.transition(CurNode, Idx);
+
+        using encoding            = typename Reader::encoding;
+        constexpr auto trans_char = Trie.transition_char[trans_idx];
+        if (cur != encoding::to_int_type(trans_char))
             return false;
-        }
+
+        reader.bump();
+        result = lit_trie_matcher<Trie, Trie.transition_to[trans_idx]>::try_match(reader);
+        return true;
     }
 
     template <typename Reader>
     LEXY_FORCE_INLINE static constexpr std::size_t try_match(Reader& reader)
     {
         constexpr auto cur_value = Trie.node_value[CurNode];
-        if constexpr (((Trie.transition_from[CurNode + Indices] == CurNode) || ...))
+        if constexpr (sizeof...(Indices) > 0)
         {
             auto                  cur_pos  = reader.position();
             [[maybe_unused]] auto cur_char = reader.peek();
 
             auto next_value = Trie.node_no_match;
-            (void)(_try_transition<Indices>(next_value, reader, cur_char) || ...);
+            if constexpr (_use_jump_table)
+            {
+                if (cur_char != Reader::encoding::eof())
+                {
+                    if (auto idx = _jump_table.index[static_cast<unsigned char>(cur_char)])
+                    {
+                        reader.bump();
+                        next_value = _children<Reader>[idx - 1](reader);
+                    }
+                }
+            }
+            else
+            {
+                (void)(_try_transition<Indices>(next_value, reader, cur_char) || ...);
+            }
             if (next_value != Trie.node_no_match)
                 // We prefer a longer match.
                 return next_value;
@@ -204,6 +277,146 @@ struct lit_trie_matcher<Trie, CurNode, index_sequence<Indices...>>
         }
     }
 };
+
+//=== lit_trie_scanner ===//
+template <typename CharT, std::size_t MaxCount>
+struct _lit_trie_start
+{
+    CharT       chars[MaxCount];
+    std::size_t count;
+};
+
+// Collects the first code unit of every literal, i.e. the characters of transitions from the root.
+template <const auto& Trie>
+LEXY_CONSTEVAL auto _make_lit_trie_start()
+{
+    using trie_type = LEXY_DECAY_DECLTYPE(Trie);
+
+    _lit_trie_start<typename trie_type::char_type, trie_type::max_transition_count> result{};
+    for (auto i = Trie.node_transition[0]; i != Trie.no_transition; i = Trie.transition_next[i])
+        result.chars[result.count++] = Trie.transition_char[i];
+    return result;
+}
+template <const auto& Trie>
+constexpr auto _lit_trie_start_chars = _make_lit_trie_start<Trie>();
+
+template <const auto& Trie,
+          typename Indices = make_index_sequence<_lit_trie_start_chars<Trie>.count>>
+struct lit_trie_scanner;
+template <const auto& Trie, std::size_t... Idx>
+struct lit_trie_scanner<Trie, index_sequence<Idx...>>
+{
+    static constexpr auto& _start = _lit_trie_start_chars<Trie>;
+
+    // Every match begins with one of the start characters, unless the trie matches the empty
+    // string.
+    static constexpr bool can_skip
+        = Trie.node_value[0] == Trie.node_no_match && sizeof...(Idx) > 0;
+
+    template <typename CharT>
+    LEXY_FORCE_INLINE static constexpr bool _is_start(CharT c)
+    {
+        return ((c == _start.chars[Idx]) || ...);
+    }
+
+#if LEXY_HAS_SSE2
+    static unsigned _sse2_match(__m128i chunk)
+    {
+        auto result = _mm_setzero_si128();
+        ((result = _mm_or_si128(result,
+                                _mm_cmpeq_epi8(chunk, _mm_set1_epi8(char(_start.chars[Idx]))))),
+         ...);
+        return static_cast<unsigned>(_mm_movemask_epi8(result));
+    }
+#endif
+
+#if LEXY_HAS_AVX2
+    static unsigned _avx2_match(__m256i chunk)
+    {
+        auto result = _mm256_setzero_si256();
+        ((result = _mm256_or_si256(result, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(char(
+                                                                        _start.chars[Idx]))))),
+         ...);
+        return static_cast<unsigned>(_mm256_movemask_epi8(result));
+    }
+#endif
+
+    // Returns the first position in [cur, end) where a match could begin, or end.
+    template <typename CharT>
+    static constexpr const CharT* find(const CharT* cur, const CharT* end)
+    {
+        if constexpr (sizeof(CharT) == 1)
+        {
+            if (!is_constant_evaluated())
+            {
+                if constexpr (sizeof...(Idx) == 1)
+                {
+                    auto size = std::size_t(end - cur);
+                    auto ptr  = std::memchr(cur, static_cast<unsigned char>(_start.chars[0]), size);
+                    return ptr == nullptr ? end : static_cast<const CharT*>(ptr);
+                }
+                else if constexpr (sizeof...(Idx) <= 8)
+                {
+                    // Beyond that, the comparisons get more expensive than the scalar loop.
+#if LEXY_HAS_AVX2
+                    for (; end - cur >= 32; cur += 32)
+                    {
+                        auto chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cur));
+                        if (auto mask = _avx2_match(chunk))
+                            return cur + countr_zero(mask);
+                    }
+#endif
+#if LEXY_HAS_SSE2
+                    for (; end - cur >= 16; cur += 16)
+                    {
+                        auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur));
+                        if (auto mask = _sse2_match(chunk))
+                            return cur + countr_zero(mask);
+                    }
+#endif
+                }
+            }
+        }
+
+        while (cur != end && !_is_start(*cur))
+            ++cur;
+        return cur;
+    }
+};
+
+// Advances the reader to the next position where a literal of the trie could begin, or EOF.
+// Does nothing if the reader isn't contiguous.
+template <const auto& Trie, typename Reader>
+constexpr void lit_trie_skip(Reader& reader)
+{
+    using scanner = lit_trie_scanner<Trie>;
+    if constexpr (is_contiguous_reader<Reader> && scanner::can_skip)
+    {
+        auto remaining = reader.remaining();
+        auto pos       = scanner::find(remaining.begin(), remaining.end());
+        reader.advance(std::size_t(pos - remaining.begin()));
+    }
+    else
+    {
+        (void)reader;
+    }
+}
+
+// Matches as many code units of the string as possible against the remaining input.
+// Returns the number of code units that matched; the reader is advanced past them.
+template <typename Reader, typename CharT>
+constexpr std::size_t match_remaining(Reader& reader, const CharT* str, std::size_t length)
+{
+    auto remaining = reader.remaining();
+    auto max_count = remaining.size() < length ? remaining.size() : length;
+
+    auto count = std::size_t(0);
+    while (count != max_count && remaining[count] == str[count])
+        ++count;
+
+    reader.advance(count);
+    return count;
+}
 } // namespace lexy::_detail
 
 //=== lit ===//
@@ -238,6 +451,17 @@ struct _lit
                 end = reader.position();
                 return std::true_type{};
             }
+            else if constexpr (lexy::_detail::is_contiguous_reader<Reader>)
+            {
+                using char_type = typename Reader::encoding::char_type;
+                constexpr auto str
+                    = lexy::_detail::type_string<CharT, C...>::template c_str<char_type>;
+
+                // We only need to check for EOF once instead of after every code unit.
+                auto count = lexy::_detail::match_remaining(reader, str, sizeof...(C));
+                end        = reader.position();
+                return count == sizeof...(C);
+            }
             else
             {
                 auto result
@@ -336,6 +560,14 @@ struct _lcp : token_base<_lcp<Cp...>>, _lit_base
         {
             using encoding = typename Reader::encoding;
 
+            if constexpr (lexy::_detail::is_contiguous_reader<Reader>)
+            {
+                constexpr auto& str   = _string<encoding>;
+                auto            count = lexy::_detail::match_remaining(reader, str.data, str.length);
+                end                   = reader.position();
+                return count == str.length;
+            }
+
             auto result
                 // Compare each code unit, bump on success, cancel on failure.
                 = ((reader.peek() == encoding::to_int_type(_string<encoding>.data[Idx])
@@ -58,11 +58,14 @@ struct _look : branch_base
             begin = reader.position();
 
             auto result = [&] {
-                using matcher = lexy::_detail::lit_trie_matcher<
-                    _look_trie<typename Reader::encoding, Needle, End>, 0>;
+                constexpr const auto& trie = _look_trie<typename Reader::encoding, Needle, End>;
+                using matcher              = lexy::_detail::lit_trie_matcher<trie, 0>;
 
                 while (true)
                 {
+                    // Skip everything where neither Needle nor End can begin.
+                    lexy::_detail::lit_trie_skip<trie>(reader);
+
                     auto result = matcher::try_match(reader);
                     if (result == 0)
                         // We've found the needle.
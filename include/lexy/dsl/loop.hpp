@@ -66,17 +66,51 @@ constexpr auto loop(Rule)
 }
 } // namespace lexyd
 
+namespace lexy::_detail
+{
+// Defined in char_class.hpp.
+template <typename CharClass, typename Reader>
+constexpr void skip_char_class_run(CharClass, Reader& reader);
+} // namespace lexy::_detail
+
 namespace lexyd
 {
 template <typename Branch>
 struct _whl : rule_base
 {
+    template <typename Context, typename Reader>
+    static constexpr bool _is_char_run()
+    {
+        if constexpr (!lexy::is_char_class_rule<Branch>)
+            return false;
+        else
+            // Every iteration needs to match a single code unit without whitespace in-between.
+            return std::is_same_v<decltype(Branch::char_class_match_cp(char32_t())),
+                                  std::false_type>
+                   && sizeof(typename Reader::encoding::char_type) == 1
+                   && std::is_pointer_v<typename Reader::iterator>
+                   && std::is_void_v<
+                       lexy::production_whitespace<typename Context::production,
+                                                   typename Context::whitespace_production>>;
+    }
+
     template <typename NextParser>
     struct p
     {
         template <typename Context, typename Reader, typename... Args>
         LEXY_PARSER_FUNC static bool parse(Context& context, Reader& reader, Args&&... args)
         {
+            if constexpr (_is_char_run<Context, Reader>())
+            {
+                // We can match all characters at once and report the individual tokens after.
+                auto begin = reader.position();
+                lexy::_detail::skip_char_class_run(Branch{}, reader);
+                for (auto end = reader.position(); begin != end; ++begin)
+                    context.on(_ev::token{}, Branch{}, begin, begin + 1);
+
+                return NextParser::parse(context, reader, LEXY_FWD(args)...);
+            }
+
             lexy::branch_parser_for<Branch, Reader> branch{};
             while (branch.try_parse(context.control_block, reader))
             {
@@ -4,7 +4,10 @@
 #ifndef LEXY_DSL_PRODUCTION_HPP_INCLUDED
 #define LEXY_DSL_PRODUCTION_HPP_INCLUDED
 
+#include <lexy/_detail/memo_table.hpp>
+#include <lexy/_detail/stack_segment.hpp>
 #include <lexy/action/base.hpp>
+#include <lexy/action/match.hpp>
 #include <lexy/dsl/base.hpp>
 #include <lexy/dsl/branch.hpp>
 #include <lexy/error.hpp>
@@ -42,6 +45,22 @@ struct _prd
     {
         template <typename Context, typename Reader, typename... Args>
         LEXY_PARSER_FUNC static bool parse(Context& context, Reader& reader, Args&&... args)
+        {
+            if constexpr (lexy::is_memoized_production<Production>)
+            {
+                // The cache can't be used during constant evaluation.
+                if (lexy::_detail::is_constant_evaluated())
+                    return _parse(context, reader, LEXY_FWD(args)...);
+                return _parse_memoized<NextParser>(context, reader, LEXY_FWD(args)...);
+            }
+            else
+            {
+                return _parse(context, reader, LEXY_FWD(args)...);
+            }
+        }
+
+        template <typename Context, typename Reader, typename... Args>
+        LEXY_PARSER_FUNC static bool _parse(Context& context, Reader& reader, Args&&... args)
         {
             // Create a context for the production and parse the context there.
             auto sub_context = context.sub_context(Production{});
@@ -74,6 +93,89 @@ struct _prd
         }
     };
 
+    template <typename NextParser, typename Context, typename Reader, typename... Args>
+    static bool _parse_memoized(Context& context, Reader& reader, Args&&... args)
+    {
+        using handler_t = LEXY_DECAY_DECLTYPE(context.control_block->parse_handler);
+        using iterator  = typename Reader::iterator;
+        if constexpr (!std::is_same_v<handler_t, lexy::match_handler> //
+                      || !std::is_pointer_v<iterator>)
+        {
+            // Outside of lookahead, the production needs to produce its events and values each
+            // time, so we can't use the cache.
+            // We also need to hash the position, which we can only do for pointers.
+            return p<NextParser>::_parse(context, reader, LEXY_FWD(args)...);
+        }
+        else
+        {
+            // The result might depend on context variables, which aren't part of the key.
+            if (context.control_block->has_vars())
+                return p<NextParser>::_parse(context, reader, LEXY_FWD(args)...);
+
+            auto& table = lexy::_detail::memo_table::get();
+            table.reserve(lexy::memoization_capacity<Production>());
+            if (table.active())
+                return _parse_cached<NextParser>(table, context, reader, LEXY_FWD(args)...);
+
+            // If the action couldn't open a scope, we need to open one for the production.
+            return lexy::_detail::memo_table::scoped([&] {
+                return _parse_cached<NextParser>(table, context, reader, LEXY_FWD(args)...);
+            });
+        }
+    }
+    template <typename NextParser, typename Context, typename Reader, typename... Args>
+    static bool _parse_cached(lexy::_detail::memo_table& table, Context& context, Reader& reader,
+                              Args&&... args)
+    {
+        using iterator = typename Reader::iterator;
+
+        auto& handler     = context.control_block->parse_handler;
+        auto  sub_context = context.sub_context(Production{});
+        auto  begin       = reader.position();
+        sub_context.on(_ev::production_start{}, begin);
+
+        auto key        = &lexy::_detail::memo_key<decltype(sub_context)>;
+        auto whitespace = context.control_block->enable_whitespace_skipping;
+        auto success    = false;
+        if (auto entry = table.lookup(key, begin, whitespace))
+        {
+            reader.set_position(static_cast<iterator>(entry->end));
+            success = entry->success;
+            handler._failed |= entry->errors;
+        }
+        else
+        {
+            // We parse with a clean error flag, so we know whether the production raised any.
+            auto failed     = handler._failed;
+            handler._failed = false;
+
+            if constexpr (lexy::_production_defines_whitespace<Production>)
+                success = lexy::whitespace_parser<decltype(sub_context),
+                                                  lexy::pattern_parser<>>::parse(sub_context,
+                                                                                 reader)
+                          && _parse_production<Production>(sub_context, reader);
+            else
+                success = _parse_production<Production>(sub_context, reader);
+
+            table.insert({key, begin, reader.position(), 0, whitespace, success,
+                          handler._failed});
+            handler._failed |= failed;
+        }
+
+        if (success)
+        {
+            sub_context.on(_ev::production_finish{}, reader.position());
+
+            using continuation = lexy::_detail::context_finish_parser<NextParser>;
+            return continuation::parse(context, reader, sub_context, LEXY_FWD(args)...);
+        }
+        else
+        {
+            sub_context.on(_ev::production_cancel{}, reader.position());
+            return false;
+        }
+    }
+
     template <typename Reader>
     struct bp
     {
@@ -169,6 +271,28 @@ struct _recb : branch_base
             return true;
         }
 
+        // Invokes the parser of the production, on a new stack segment if necessary.
+        template <typename Context, typename Reader, typename Fn>
+        static constexpr bool recurse(Context& context, const Reader& reader, Fn fn)
+        {
+#if LEXY_HAS_STACK_SEGMENTS
+            if (auto size = context.control_block->stack_segment_size; size > 0)
+                return lexy::_detail::stack_segments::get()
+                    .call(context.control_block->stack_watermark, size, fn, [&] {
+                        // Without a new segment, we can't recurse any deeper.
+                        using tag = lexy::_detail::type_or<DepthError, //
+                                                           lexy::max_recursion_depth_exceeded>;
+                        auto err  = lexy::error<Reader, tag>(reader.position());
+                        context.on(_ev::error{}, err);
+                        return false;
+                    });
+#else
+            (void)context;
+            (void)reader;
+#endif
+            return fn();
+        }
+
         template <typename Context, typename Reader, typename... Args>
         LEXY_PARSER_FUNC static bool parse(Context& context, Reader& reader, Args&&... args)
         {
@@ -204,7 +328,9 @@ struct _recb : branch_base
             using depth = _depth_handler<NextParser>;
             if (!depth::increment_depth(context, reader))
                 return false;
-            return _impl.template finish<depth>(context, reader, LEXY_FWD(args)...);
+            return depth::recurse(context, reader, [&] {
+                return _impl.template finish<depth>(context, reader, LEXY_FWD(args)...);
+            });
         }
     };
 
@@ -218,8 +344,10 @@ struct _recb : branch_base
             if (!depth::increment_depth(context, reader))
                 return false;
 
-            return lexy::parser_for<_prd<Production>, depth>::parse(context, reader,
-                                                                    LEXY_FWD(args)...);
+            return depth::recurse(context, reader, [&] {
+                return lexy::parser_for<_prd<Production>, depth>::parse(context, reader,
+                                                                        LEXY_FWD(args)...);
+            });
         }
     };
 
@@ -73,6 +73,9 @@ struct _find : _recovery_base
             context.on(_ev::recovery_start{}, begin);
             while (true)
             {
+                // Skip everything where neither Token nor Limit can begin.
+                lexy::_detail::lit_trie_skip<trie>(reader);
+
                 auto end    = reader.position(); // *before* we've consumed Token/Limit
                 auto result = matcher::try_match(reader);
                 if (result == 0)
@@ -4,6 +4,7 @@
 #ifndef LEXY_DSL_SYMBOL_HPP_INCLUDED
 #define LEXY_DSL_SYMBOL_HPP_INCLUDED
 
+#include <lexy/_detail/perfect_hash.hpp>
 #include <lexy/dsl/base.hpp>
 #include <lexy/dsl/capture.hpp>
 #include <lexy/dsl/literal.hpp>
@@ -176,15 +177,33 @@ public:
             return key_index(result);
     }
 
+    // Whether parse() computes the hash of contiguous input instead of matching the trie.
+    static constexpr auto _use_hash = size() >= lexy::_detail::string_perfect_hash_min_key_count;
+
     template <typename Input>
     constexpr key_index parse(const Input& input) const
     {
         auto reader = input.reader();
-        auto result = try_parse(reader);
-        if (reader.peek() == decltype(reader)::encoding::eof())
-            return result;
+        if constexpr (lexy::_detail::is_contiguous_reader<decltype(reader)> && _use_hash)
+        {
+            // We know the entire symbol, so we can hash it instead of matching it char by char.
+            using encoding = typename decltype(reader)::encoding;
+
+            auto symbol = reader.remaining();
+            auto result = _hash<encoding>.find(symbol.data(), symbol.size());
+            if (result == _hash<encoding>.no_key)
+                return key_index();
+            else
+                return key_index(result);
+        }
         else
-            return key_index();
+        {
+            auto result = try_parse(reader);
+            if (reader.peek() == decltype(reader)::encoding::eof())
+                return result;
+            else
+                return key_index();
+        }
     }
 
     constexpr const T& operator[](key_index idx) const noexcept
@@ -210,6 +229,18 @@ private:
     static constexpr lexy::_detail::lit_trie<Encoding, _max_char_count> _trie
         = _build_trie<Encoding>();
 
+    template <typename Encoding>
+    static LEXY_CONSTEVAL auto _build_hash()
+    {
+        using char_type = typename Encoding::char_type;
+        constexpr const char_type* strings[] = {Strings::template c_str<char_type>...};
+        constexpr std::size_t      lengths[] = {Strings::size...};
+        return lexy::_detail::string_perfect_hash<char_type, size()>(strings, lengths);
+    }
+    template <typename Encoding>
+    static constexpr lexy::_detail::string_perfect_hash<typename Encoding::char_type, size()> _hash
+        = _build_hash<Encoding>();
+
     template <std::size_t... Idx, typename... Args>
     constexpr explicit _symbol_table(lexy::_detail::index_sequence<Idx...>, const T* data,
                                      Args&&... args)
@@ -332,6 +363,7 @@ struct _sym : branch_base
 // Optimization for identifiers: instead of parsing an entire identifier (which requires checking
 // every character against the char class), parse a symbol and check whether the next character
 // would continue the identifier. This is the same optimization that is done for keywords.
+// For big tables, we parse the identifier and hash it instead, which is cheaper than the trie.
 template <const auto& Table, typename L, typename T, typename Tag>
 struct _sym<Table, _idp<L, T>, Tag> : branch_base
 {
@@ -343,14 +375,29 @@ struct _sym<Table, _idp<L, T>, Tag> : branch_base
 
         constexpr bool try_parse(const void*, Reader reader)
         {
-            // Try to parse a symbol.
-            symbol = Table.try_parse(reader);
-            if (!symbol)
-                return false;
-            end = reader.position();
+            if constexpr (LEXY_DECAY_DECLTYPE(Table)::_use_hash
+                          && lexy::_detail::is_contiguous_reader<Reader>)
+            {
+                // The table is big, so it's cheaper to parse the identifier and hash it.
+                lexy::token_parser_for<_idp<L, T>, Reader> parser(reader);
+                if (!parser.try_parse(reader))
+                    return false;
+                end = parser.end;
+
+                symbol = Table.parse(lexy::partial_input(reader, end));
+                return static_cast<bool>(symbol);
+            }
+            else
+            {
+                // Try to parse a symbol.
+                symbol = Table.try_parse(reader);
+                if (!symbol)
+                    return false;
+                end = reader.position();
 
-            // We had a symbol, but it must not be the prefix of a valid identifier.
-            return !lexy::try_match_token(T{}, reader);
+                // We had a symbol, but it must not be the prefix of a valid identifier.
+                return !lexy::try_match_token(T{}, reader);
+            }
         }
 
         template <typename Context>
@@ -376,38 +423,27 @@ struct _sym<Table, _idp<L, T>, Tag> : branch_base
         template <typename Context, typename Reader, typename... Args>
         LEXY_PARSER_FUNC static bool parse(Context& context, Reader& reader, Args&&... args)
         {
-            auto begin = reader.position();
-
             // Try to parse a symbol that is not the prefix of an identifier.
-            auto symbol_reader = reader;
-            auto symbol        = Table.try_parse(symbol_reader);
-            if (!symbol || lexy::try_match_token(T{}, symbol_reader))
-            {
-                // Unknown symbol or not an identifier.
-                // Parse the identifier pattern normally, and see if that fails.
-                using id_parser = lexy::parser_for<_idp<L, T>, lexy::pattern_parser<>>;
-                if (!id_parser::parse(context, reader))
-                    // It did fail, so it reported an error and we're done here.
-                    return false;
+            bp<Reader> impl{};
+            if (impl.try_parse(context.control_block, reader))
+                return impl.template finish<NextParser>(context, reader, LEXY_FWD(args)...);
+            impl.cancel(context);
 
-                // We're having a valid identifier but unknown symbol.
-                using tag = lexy::_detail::type_or<Tag, lexy::unknown_symbol>;
-                auto err  = lexy::error<Reader, tag>(begin, reader.position());
-                context.on(_ev::error{}, err);
+            // Unknown symbol or not an identifier.
+            // Parse the identifier pattern normally, and see if that fails.
+            auto begin = reader.position();
 
+            using id_parser = lexy::parser_for<_idp<L, T>, lexy::pattern_parser<>>;
+            if (!id_parser::parse(context, reader))
+                // It did fail, so it reported an error and we're done here.
                 return false;
-            }
-            else
-            {
-                // We need to consume and report the identifier pattern.
-                auto end = symbol_reader.position();
-                context.on(_ev::token{}, _idp<L, T>{}, begin, end);
-                reader.set_position(end);
-
-                // And continue parsing with the symbol value after whitespace skipping.
-                using continuation = lexy::whitespace_parser<Context, NextParser>;
-                return continuation::parse(context, reader, LEXY_FWD(args)..., Table[symbol]);
-            }
+
+            // We're having a valid identifier but unknown symbol.
+            using tag = lexy::_detail::type_or<Tag, lexy::unknown_symbol>;
+            auto err  = lexy::error<Reader, tag>(begin, reader.position());
+            context.on(_ev::error{}, err);
+
+            return false;
         }
     };
 
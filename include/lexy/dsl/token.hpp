@@ -177,8 +177,10 @@ struct _token : token_base<_token<Rule>>
         constexpr bool try_parse(Reader reader)
         {
             // We match a dummy production that only consists of the rule.
-            auto success
-                = lexy::do_action<_production>(lexy::match_handler(), lexy::no_parse_state, reader);
+            // It's part of the current action, so memoized productions share its cache.
+            auto success = lexy::_do_action<_production, void>(
+                lexy::match_handler(), lexy::no_parse_state, reader,
+                lexy::max_recursion_depth<_production>());
             end = reader.position();
             return success;
         }
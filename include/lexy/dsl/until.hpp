@@ -5,10 +5,27 @@
 #define LEXY_DSL_UNTIL_HPP_INCLUDED
 
 #include <lexy/dsl/base.hpp>
+#include <lexy/dsl/literal.hpp>
 #include <lexy/dsl/token.hpp>
 
 namespace lexyd
 {
+// Skips to the next position where the condition could match.
+template <typename Condition, typename Reader>
+constexpr void _until_skip(Reader& reader)
+{
+    if constexpr (lexy::is_literal_rule<Condition> || lexy::is_literal_set_rule<Condition>)
+    {
+        // We only need to try the condition where one of its literals begins.
+        using lset = decltype(literal_set() / Condition{});
+        lexy::_detail::lit_trie_skip<lset::template _t<typename Reader::encoding>>(reader);
+    }
+    else
+    {
+        (void)reader;
+    }
+}
+
 template <typename Condition>
 struct _until_eof : token_base<_until_eof<Condition>, unconditional_branch_base>
 {
@@ -21,6 +38,21 @@ struct _until_eof : token_base<_until_eof<Condition>, unconditional_branch_base>
 
         constexpr std::true_type try_parse(Reader reader)
         {
+            if constexpr (lexy::_detail::is_contiguous_reader<Reader>)
+            {
+                while (true)
+                {
+                    _until_skip<Condition>(reader);
+                    if (reader.remaining().empty() || lexy::try_match_token(Condition{}, reader))
+                        break;
+
+                    reader.advance(1);
+                }
+
+                end = reader.position();
+                return {};
+            }
+
             while (true)
             {
                 // Check whether we've reached the end of the input or the condition.
@@ -56,6 +88,28 @@ struct _until : token_base<_until<Condition>>
 
         constexpr bool try_parse(Reader reader)
         {
+            if constexpr (lexy::_detail::is_contiguous_reader<Reader>)
+            {
+                while (true)
+                {
+                    _until_skip<Condition>(reader);
+                    if (lexy::try_match_token(Condition{}, reader))
+                    {
+                        end = reader.position();
+                        return true;
+                    }
+                    else if (reader.remaining().empty())
+                    {
+                        end = reader.position();
+                        return false;
+                    }
+
+                    reader.advance(1);
+                }
+
+                return false; // unreachable
+            }
+
             while (true)
             {
                 // Try to parse the condition.
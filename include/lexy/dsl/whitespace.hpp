@@ -79,7 +79,12 @@ struct manual_ws_parser
     {
         auto result = true;
         auto begin  = reader.position();
-        if constexpr (lexy::is_token_rule<Rule>)
+        if constexpr (lexy::is_char_class_rule<Rule>)
+        {
+            // Skip the entire run of whitespace characters at once.
+            lexy::_detail::skip_char_class_run(Rule{}, reader);
+        }
+        else if constexpr (lexy::is_token_rule<Rule>)
         {
             // Parsing a token repeatedly cannot fail, so we can optimize it.
             while (lexy::try_match_token(Rule{}, reader))
@@ -89,8 +94,10 @@ struct manual_ws_parser
         {
             // Parse the rule using a special handler that only forwards errors.
             using production = ws_production<Rule>;
-            result = lexy::do_action<production>(whitespace_handler(context), lexy::no_parse_state,
-                                                 reader);
+            // It's part of the current action, so memoized productions share its cache.
+            result = lexy::_do_action<production, void>(
+                whitespace_handler(context), lexy::no_parse_state, reader,
+                lexy::max_recursion_depth<production>());
         }
         auto end = reader.position();
 
@@ -4,6 +4,7 @@
 #ifndef LEXY_GRAMMAR_HPP_INCLUDED
 #define LEXY_GRAMMAR_HPP_INCLUDED
 
+#include <climits>
 #include <cstdint>
 #include <lexy/_detail/config.hpp>
 #include <lexy/_detail/detect.hpp>
@@ -148,6 +149,23 @@ struct transparent_production
 template <typename Production>
 constexpr bool is_transparent_production = std::is_base_of_v<transparent_production, Production>;
 
+/// Base class to indicate that the results of this production are cached during lookahead.
+/// If it is matched again at the same position, it is not parsed again.
+struct memoized_production
+{};
+
+template <typename Production>
+constexpr bool is_memoized_production = std::is_base_of_v<memoized_production, Production>;
+
+/// Base class to indicate that recursion inside this entry production continues on heap allocated
+/// stack segments, so its depth is only limited by memory.
+struct segmented_stack_production
+{};
+
+template <typename Production>
+constexpr bool is_segmented_stack_production
+    = std::is_base_of_v<segmented_stack_production, Production>;
+
 template <typename Production>
 LEXY_CONSTEVAL const char* production_name()
 {
@@ -162,9 +180,37 @@ LEXY_CONSTEVAL std::size_t max_recursion_depth()
 {
     if constexpr (_detail::is_detected<_detect_max_recursion_depth, EntryProduction>)
         return EntryProduction::max_recursion_depth;
+    else if constexpr (LEXY_HAS_STACK_SEGMENTS && is_segmented_stack_production<EntryProduction>)
+        return INT_MAX; // Only limited by memory.
     else
         return 1024; // Arbitrary power of two.
 }
+
+template <typename Production>
+using _detect_stack_segment_size = decltype(Production::stack_segment_size);
+
+template <typename EntryProduction>
+LEXY_CONSTEVAL std::size_t stack_segment_size()
+{
+    if constexpr (!is_segmented_stack_production<EntryProduction>)
+        return 0;
+    else if constexpr (_detail::is_detected<_detect_stack_segment_size, EntryProduction>)
+        return EntryProduction::stack_segment_size;
+    else
+        return std::size_t(1) << 20; // 1 MiB
+}
+
+template <typename Production>
+using _detect_memoization_capacity = decltype(Production::memoization_capacity);
+
+template <typename Production>
+LEXY_CONSTEVAL std::size_t memoization_capacity()
+{
+    if constexpr (_detail::is_detected<_detect_memoization_capacity, Production>)
+        return Production::memoization_capacity;
+    else
+        return 4096; // Arbitrary power of two.
+}
 } // namespace lexy
 
 namespace lexy
@@ -194,6 +240,98 @@ auto _production_whitespace()
 }
 template <typename Production, typename WhitespaceProduction>
 using production_whitespace = decltype(_production_whitespace<Production, WhitespaceProduction>());
+
+template <typename... T>
+struct _grammar_types
+{};
+
+template <typename T, typename Types>
+constexpr bool _grammar_contains = false;
+template <typename T, typename... Types>
+constexpr bool _grammar_contains<T, _grammar_types<Types...>> = (std::is_same_v<T, Types> || ...);
+
+template <typename T>
+using _detect_complete = decltype(sizeof(T));
+
+template <typename Production>
+using _grammar_rule = _grammar_types<production_rule<Production>>;
+template <typename Production>
+using _grammar_whitespace = _grammar_types<LEXY_DECAY_DECLTYPE(Production::whitespace)>;
+
+template <typename... Types>
+struct _grammar_concat;
+template <typename... A, typename... B, typename... C>
+struct _grammar_concat<_grammar_types<A...>, _grammar_types<B...>, _grammar_types<C...>>
+{
+    using type = _grammar_types<A..., B..., C...>;
+};
+
+// The types a type refers to: its template arguments, and the rule and whitespace of productions.
+// Incomplete types, e.g. tags, don't refer to anything.
+template <typename T, bool = _detail::is_detected<_detect_complete, T>>
+struct _grammar_refs
+{
+    static constexpr bool memoized = false;
+    using type                     = _grammar_types<>;
+};
+template <typename T>
+struct _grammar_refs<T, true>
+{
+    template <typename U>
+    struct args
+    {
+        using type = _grammar_types<>;
+    };
+    template <template <typename...> typename Templ, typename... Args>
+    struct args<Templ<Args...>>
+    {
+        using type = _grammar_types<Args...>;
+    };
+
+    static constexpr bool memoized = std::is_base_of_v<memoized_production, T>;
+    using type                     = typename _grammar_concat<
+        typename args<T>::type, _detail::detected_or<_grammar_types<>, _grammar_rule, T>,
+        _detail::detected_or<_grammar_types<>, _grammar_whitespace, T>>::type;
+};
+
+// Searches the types reachable from T that haven't been seen yet for a memoized production.
+// The set of seen types is threaded through the search, so each type is only visited once.
+template <typename Seen, typename T, bool = _grammar_contains<T, Seen>>
+struct _memo_search
+{
+    static constexpr bool value = false;
+    using seen                  = Seen;
+};
+template <typename Seen, typename Types>
+struct _memo_search_all;
+
+struct _memo_found
+{
+    static constexpr bool value = true;
+    using seen                  = _grammar_types<>;
+};
+template <typename... Seen, typename T>
+struct _memo_search<_grammar_types<Seen...>, T, false>
+: std::conditional_t<_grammar_refs<T>::memoized, _memo_found,
+                     _memo_search_all<_grammar_types<Seen..., T>, typename _grammar_refs<T>::type>>
+{};
+
+template <typename Seen>
+struct _memo_search_all<Seen, _grammar_types<>>
+{
+    static constexpr bool value = false;
+    using seen                  = Seen;
+};
+template <typename Seen, typename Head, typename... Tail>
+struct _memo_search_all<Seen, _grammar_types<Head, Tail...>>
+: std::conditional_t<_memo_search<Seen, Head>::value, _memo_found,
+                     _memo_search_all<typename _memo_search<Seen, Head>::seen,
+                                      _grammar_types<Tail...>>>
+{};
+
+// Whether the grammar of the production can reach a memoized production.
+template <typename Production>
+constexpr bool _has_memoized_production = _memo_search<_grammar_types<>, Production>::value;
 } // namespace lexy
 
 namespace lexy
@@ -6,6 +6,7 @@
 
 #include <lexy/_detail/config.hpp>
 #include <lexy/_detail/iterator.hpp>
+#include <lexy/_detail/string_view.hpp>
 #include <lexy/encoding.hpp>
 
 #if 0
@@ -42,6 +43,21 @@ public:
     void set_position(iterator new_pos);
 };
 
+/// A reader over contiguous memory can optionally provide the following as well.
+/// Rules detect it and process the remaining input at once instead of one code unit at a time.
+/// Its iterator must be `const Encoding::char_type*`.
+class ContiguousReader : Reader
+{
+public:
+    /// Returns the characters in the range `[position(), end of input)`.
+    /// `peek()` returns `Encoding::eof()` if and only if it is empty.
+    lexy::_detail::basic_string_view<typename Encoding::char_type> remaining() const;
+
+    /// Advances by `n` characters; equivalent to calling `bump()` `n` times.
+    /// `n` must not be greater than `remaining().size()`.
+    void advance(std::size_t n);
+};
+
 /// An Input produces a reader.
 class Input
 {
@@ -57,6 +73,10 @@ namespace lexy
 template <typename Encoding, typename Iterator, typename Sentinel = Iterator>
 class _rr
 {
+    static constexpr auto _is_contiguous
+        = std::is_same_v<Iterator, const typename Encoding::char_type*>
+          && std::is_same_v<Iterator, Sentinel>;
+
 public:
     using encoding = Encoding;
     using iterator = Iterator;
@@ -91,6 +111,20 @@ public:
         _cur = new_pos;
     }
 
+    // Only available if we're reading from contiguous memory.
+    template <bool Contiguous = _is_contiguous, typename = std::enable_if_t<Contiguous>>
+    constexpr auto remaining() const noexcept
+    {
+        return lexy::_detail::basic_string_view<typename Encoding::char_type>(_cur, _end);
+    }
+
+    template <bool Contiguous = _is_contiguous, typename = std::enable_if_t<Contiguous>>
+    constexpr void advance(std::size_t n) noexcept
+    {
+        LEXY_PRECONDITION(n <= std::size_t(_end - _cur));
+        _cur += n;
+    }
+
 private:
     Iterator                   _cur;
     LEXY_EMPTY_MEMBER Sentinel _end;
@@ -126,6 +160,19 @@ constexpr auto _range_reader(Iterator begin, Sentinel end)
 }
 } // namespace lexy
 
+namespace lexy::_detail
+{
+template <typename Reader>
+using _detect_remaining = decltype(LEXY_DECLVAL(const Reader&).remaining());
+template <typename Reader>
+using _detect_advance = decltype(LEXY_DECLVAL(Reader&).advance(std::size_t(0)));
+
+// Whether the reader satisfies the ContiguousReader concept.
+template <typename Reader>
+constexpr bool is_contiguous_reader
+    = is_detected<_detect_remaining, Reader> && is_detected<_detect_advance, Reader>;
+} // namespace lexy::_detail
+
 namespace lexy
 {
 template <typename Input>
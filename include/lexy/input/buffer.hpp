@@ -5,7 +5,9 @@
 #define LEXY_INPUT_BUFFER_HPP_INCLUDED
 
 #include <cstring>
+#include <lexy/_detail/code_point.hpp>
 #include <lexy/_detail/memory_resource.hpp>
+#include <lexy/_detail/simd.hpp>
 #include <lexy/error.hpp>
 #include <lexy/input/base.hpp>
 #include <lexy/lexeme.hpp>
@@ -20,7 +22,7 @@ public:
     using encoding = Encoding;
     using iterator = const typename Encoding::char_type*;
 
-    explicit _br(iterator begin) noexcept : _cur(begin) {}
+    explicit _br(iterator begin, iterator end) noexcept : _cur(begin), _end(end) {}
 
     auto peek() const noexcept
     {
@@ -43,8 +45,21 @@ public:
         _cur = new_pos;
     }
 
+    auto remaining() const noexcept
+    {
+        return lexy::_detail::basic_string_view<typename Encoding::char_type>(_cur, _end);
+    }
+
+    void advance(std::size_t n) noexcept
+    {
+        LEXY_PRECONDITION(n <= std::size_t(_end - _cur));
+        _cur += n;
+    }
+
 private:
     iterator _cur;
+    // Not needed for peek(), as the sentinel marks the end.
+    iterator _end;
 };
 
 // We use aliases for the three encodings that can actually use it.
@@ -53,18 +68,28 @@ LEXY_INSTANTIATION_NEWTYPE(_bra, _br, lexy::ascii_encoding);
 LEXY_INSTANTIATION_NEWTYPE(_br8, _br, lexy::utf8_encoding);
 LEXY_INSTANTIATION_NEWTYPE(_br32, _br, lexy::utf32_encoding);
 
+// The reader of a validated_utf8_buffer.
+struct _br8v : _br<lexy::utf8_encoding>
+{
+    using _br<lexy::utf8_encoding>::_br;
+
+    // The input is well-formed UTF-8, see _detail::parse_code_point().
+    static constexpr bool validated_utf8 = true;
+};
+
 // Create the appropriate buffer reader.
 template <typename Encoding>
-constexpr auto _buffer_reader(const typename Encoding::char_type* data)
+constexpr auto _buffer_reader(const typename Encoding::char_type* data,
+                              const typename Encoding::char_type* end)
 {
     if constexpr (std::is_same_v<Encoding, lexy::ascii_encoding>)
-        return _bra(data);
+        return _bra(data, end);
     else if constexpr (std::is_same_v<Encoding, lexy::utf8_encoding>)
-        return _br8(data);
+        return _br8(data, end);
     else if constexpr (std::is_same_v<Encoding, lexy::utf32_encoding>)
-        return _br32(data);
+        return _br32(data, end);
     else
-        return _br<Encoding>(data);
+        return _br<Encoding>(data, end);
 }
 } // namespace lexy
 
@@ -224,7 +249,7 @@ public:
     auto reader() const& noexcept
     {
         if constexpr (_has_sentinel)
-            return _buffer_reader<encoding>(_data);
+            return _buffer_reader<encoding>(_data, _data + _size);
         else
             return _range_reader<encoding>(_data, _data + _size);
     }
@@ -292,26 +317,9 @@ struct _make_buffer
             typename buffer<Encoding, MemoryResource>::builder builder(size / sizeof(char_type),
                                                                        resource);
 
-            const auto end = memory + size;
-            for (auto dest = builder.data(); memory != end; memory += sizeof(char_type))
-            {
-                constexpr auto is_char16 = std::is_same_v<char_type, char16_t>;
-                constexpr auto is_char32 = std::is_same_v<char_type, char32_t>;
-
-                // We convert each group of bytes to the appropriate value.
-                if constexpr (is_char16 && Endian == encoding_endianness::little)
-                    *dest++ = static_cast<char_type>((memory[0] << 0) | (memory[1] << 8));
-                else if constexpr (is_char32 && Endian == encoding_endianness::little)
-                    *dest++ = static_cast<char_type>((memory[0] << 0) | (memory[1] << 8)
-                                                     | (memory[2] << 16) | (memory[3] << 24));
-                else if constexpr (is_char16 && Endian == encoding_endianness::big)
-                    *dest++ = static_cast<char_type>((memory[0] << 8) | (memory[1] << 0));
-                else if constexpr (is_char32 && Endian == encoding_endianness::big)
-                    *dest++ = static_cast<char_type>((memory[0] << 24) | (memory[1] << 16)
-                                                     | (memory[2] << 8) | (memory[3] << 0));
-                else
-                    static_assert(_detail::error<Encoding>, "unhandled encoding/endianness");
-            }
+            // As the endianness isn't native, we need to reverse the bytes of each code unit.
+            _detail::byte_swap_copy<sizeof(char_type)>(builder.data(), memory,
+                                                       size / sizeof(char_type));
 
             return LEXY_MOV(builder).finish();
         }
@@ -384,6 +392,114 @@ struct _make_buffer<utf32_encoding, encoding_endianness::bom>
 template <typename Encoding, encoding_endianness Endianness>
 constexpr auto make_buffer_from_raw = _make_buffer<Encoding, Endianness>{};
 
+//=== validate_utf8 ===//
+/// A UTF-8 buffer whose contents are known to be well-formed.
+/// Rules that decode code points don't need to check them again.
+template <typename MemoryResource = void>
+class validated_utf8_buffer
+{
+public:
+    using encoding  = utf8_encoding;
+    using char_type = typename encoding::char_type;
+
+    //=== access ===//
+    const char_type* data() const noexcept
+    {
+        return _buffer.data();
+    }
+
+    std::size_t size() const noexcept
+    {
+        return _buffer.size();
+    }
+
+    /// The underlying buffer without the guarantee.
+    const lexy::buffer<utf8_encoding, MemoryResource>& buffer() const& noexcept
+    {
+        return _buffer;
+    }
+    lexy::buffer<utf8_encoding, MemoryResource>&& buffer() && noexcept
+    {
+        return LEXY_MOV(_buffer);
+    }
+
+    //=== input ===//
+    auto reader() const& noexcept
+    {
+        return _br8v(_buffer.data(), _buffer.data() + _buffer.size());
+    }
+
+private:
+    explicit validated_utf8_buffer(lexy::buffer<utf8_encoding, MemoryResource>&& buffer) noexcept
+    : _buffer(LEXY_MOV(buffer))
+    {}
+
+    lexy::buffer<utf8_encoding, MemoryResource> _buffer;
+
+    template <typename>
+    friend class validate_utf8_result;
+};
+
+template <typename MemoryResource>
+class validate_utf8_result
+{
+public:
+    using encoding  = utf8_encoding;
+    using char_type = typename encoding::char_type;
+
+    explicit operator bool() const noexcept
+    {
+        return _error == nullptr;
+    }
+
+    /// The position of the first ill-formed code unit sequence.
+    const char_type* error_position() const noexcept
+    {
+        LEXY_PRECONDITION(!*this);
+        return _error;
+    }
+
+    const validated_utf8_buffer<MemoryResource>& buffer() const& noexcept
+    {
+        LEXY_PRECONDITION(*this);
+        return _buffer;
+    }
+    validated_utf8_buffer<MemoryResource>&& buffer() && noexcept
+    {
+        LEXY_PRECONDITION(*this);
+        return LEXY_MOV(_buffer);
+    }
+
+    /// The buffer that was passed to validate_utf8(), regardless of success.
+    lexy::buffer<utf8_encoding, MemoryResource>&& unvalidated_buffer() && noexcept
+    {
+        return LEXY_MOV(_buffer._buffer);
+    }
+
+    //=== internals ===//
+    // Pretend this doesn't exist.
+    explicit validate_utf8_result(lexy::buffer<utf8_encoding, MemoryResource>&& buffer) noexcept
+    : _buffer(LEXY_MOV(buffer)), _error(nullptr)
+    {
+        auto begin = _buffer.data();
+        auto end   = begin + _buffer.size();
+        if (auto pos = _detail::find_invalid_utf8(begin, end); pos != end)
+            _error = pos;
+    }
+
+private:
+    validated_utf8_buffer<MemoryResource> _buffer;
+    const char_type*                      _error;
+};
+
+/// Checks whether the buffer contains well-formed UTF-8.
+/// If so, the result contains a buffer whose type records that.
+template <typename MemoryResource>
+auto validate_utf8(buffer<utf8_encoding, MemoryResource>&& buffer)
+{
+    return validate_utf8_result<MemoryResource>(LEXY_MOV(buffer));
+}
+
 //=== convenience typedefs ===//
 template <typename Encoding = default_encoding, typename MemoryResource = void>
 using buffer_lexeme = lexeme_for<buffer<Encoding, MemoryResource>>;
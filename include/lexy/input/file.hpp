@@ -32,6 +32,19 @@ enum class file_error
     /// The file cannot be opened.
     permission_denied,
 };
+
+/// How the memory of a mapped file is going to be accessed.
+enum class mapped_file_advice
+{
+    /// No special treatment.
+    normal,
+    /// Pages are accessed in order, so aggressive read-ahead is beneficial.
+    sequential,
+    /// Pages are accessed in random order, so read-ahead is wasteful.
+    random,
+    /// The entire file is going to be needed soon, so it is read eagerly.
+    willneed,
+};
 } // namespace lexy
 
 namespace lexy::_detail
@@ -47,6 +60,18 @@ file_error read_file(const char* path, file_callback cb, void* user_data);
 
 // Same as above, but reads from stdin.
 file_error read_stdin(file_callback cb, void* user_data);
+
+// Maps the entire contents of the specified file into memory.
+// On success, stores the memory and must be released by calling unmap_file() later.
+// On error, returns the error without modifying the output parameters.
+// On platforms without memory mapping, the file is read into heap memory instead.
+//
+// Do not change ABI, especially with different build configurations!
+file_error map_file(const char* path, mapped_file_advice advice, const char** memory,
+                    std::size_t* size);
+
+// Releases memory previously obtained by map_file().
+void unmap_file(const char* memory, std::size_t size) noexcept;
 } // namespace lexy::_detail
 
 namespace lexy
@@ -158,5 +183,159 @@ auto read_stdin(MemoryResource* resource = _detail::get_memory_resource<MemoryRe
 }
 } // namespace lexy
 
+namespace lexy
+{
+/// An input that owns a read-only memory mapping of a file.
+/// Unlike a buffer, the contents are never copied; lexemes point directly into the mapping.
+template <typename Encoding = default_encoding>
+class mapped_file
+{
+public:
+    using encoding  = Encoding;
+    using char_type = typename encoding::char_type;
+    static_assert(std::is_trivial_v<char_type>);
+
+    //=== constructors ===//
+    constexpr mapped_file() noexcept : _memory(nullptr), _memory_size(0), _data(nullptr), _size(0)
+    {}
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    mapped_file(mapped_file&& other) noexcept
+    : _memory(other._memory), _memory_size(other._memory_size), _data(other._data),
+      _size(other._size)
+    {
+        other._memory      = nullptr;
+        other._memory_size = 0;
+        other._data        = nullptr;
+        other._size        = 0;
+    }
+
+    ~mapped_file() noexcept
+    {
+        if (_memory)
+            _detail::unmap_file(_memory, _memory_size);
+    }
+
+    mapped_file& operator=(mapped_file&& other) noexcept
+    {
+        // Swap, so other will release our mapping.
+        _detail::swap(_memory, other._memory);
+        _detail::swap(_memory_size, other._memory_size);
+        _detail::swap(_data, other._data);
+        _detail::swap(_size, other._size);
+        return *this;
+    }
+
+    //=== access ===//
+    const char_type* data() const noexcept
+    {
+        return _data;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return _size;
+    }
+
+    //=== input ===//
+    auto reader() const& noexcept
+    {
+        return _range_reader<encoding>(_data, _data + _size);
+    }
+
+public:
+    // Pretend this doesn't exist.
+    explicit mapped_file(const char* memory, std::size_t memory_size, std::size_t offset) noexcept
+    : _memory(memory), _memory_size(memory_size),
+      // The reinterpret_cast is technically UB, as we didn't create objects in memory,
+      // but until std::start_lifetime_as is added, there is nothing we can do.
+      _data(reinterpret_cast<const char_type*>(memory + offset)),
+      _size((memory_size - offset) / sizeof(char_type))
+    {}
+
+private:
+    const char*      _memory;
+    std::size_t      _memory_size;
+    const char_type* _data;
+    std::size_t      _size;
+};
+
+template <typename Encoding = default_encoding>
+class map_file_result
+{
+public:
+    using encoding  = Encoding;
+    using char_type = typename encoding::char_type;
+
+    explicit operator bool() const noexcept
+    {
+        return _ec == file_error::_success;
+    }
+
+    const lexy::mapped_file<Encoding>& file() const& noexcept
+    {
+        LEXY_PRECONDITION(*this);
+        return _file;
+    }
+    lexy::mapped_file<Encoding>&& file() && noexcept
+    {
+        LEXY_PRECONDITION(*this);
+        return LEXY_MOV(_file);
+    }
+
+    file_error error() const noexcept
+    {
+        LEXY_PRECONDITION(!*this);
+        return _ec;
+    }
+
+public:
+    // Pretend these two don't exist.
+    explicit map_file_result(lexy::mapped_file<Encoding>&& file) noexcept
+    : _file(LEXY_MOV(file)), _ec(file_error::_success)
+    {}
+    explicit map_file_result(file_error ec) noexcept : _file(), _ec(ec)
+    {
+        LEXY_PRECONDITION(!*this);
+    }
+
+private:
+    lexy::mapped_file<Encoding> _file;
+    file_error                  _ec;
+};
+
+/// Maps the file at the specified path into memory without copying it.
+template <typename Encoding          = default_encoding,
+          encoding_endianness Endian = encoding_endianness::bom>
+auto map_file(const char* path, mapped_file_advice advice = mapped_file_advice::sequential)
+    -> map_file_result<Encoding>
+{
+    using char_type = typename Encoding::char_type;
+    constexpr auto native_endianness
+        = LEXY_IS_LITTLE_ENDIAN ? encoding_endianness::little : encoding_endianness::big;
+    static_assert(sizeof(char_type) == 1 || Endian == native_endianness,
+                  "a mapped file cannot be converted to native endianness; use read_file() instead");
+
+    const char* memory = nullptr;
+    std::size_t size   = 0;
+    auto        ec     = _detail::map_file(path, advice, &memory, &size);
+    if (ec != file_error::_success)
+        return map_file_result<Encoding>(ec);
+
+    auto offset = std::size_t(0);
+    if constexpr (std::is_same_v<Encoding, utf8_encoding> && Endian == encoding_endianness::bom)
+    {
+        // We just skip over the BOM if there is one, it doesn't matter.
+        auto bytes = reinterpret_cast<const unsigned char*>(memory);
+        if (size >= 3 && bytes[0] == 0xEF && bytes[1] == 0xBB && bytes[2] == 0xBF)
+            offset = 3;
+    }
+
+    return map_file_result<Encoding>(mapped_file<Encoding>(memory, size, offset));
+}
+} // namespace lexy
+
 #endif // LEXY_INPUT_FILE_HPP_INCLUDED
 
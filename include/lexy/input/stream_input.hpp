@@ -0,0 +1,383 @@
+// Copyright (C) 2020-2022 Jonathan Müller and lexy contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#ifndef LEXY_INPUT_STREAM_INPUT_HPP_INCLUDED
+#define LEXY_INPUT_STREAM_INPUT_HPP_INCLUDED
+
+#include <cstdio>
+#include <lexy/_detail/assert.hpp>
+#include <lexy/_detail/iterator.hpp>
+#include <lexy/_detail/memory_resource.hpp>
+#include <lexy/input/base.hpp>
+
+namespace lexy
+{
+#if 0
+/// Produces the characters of a stream.
+class Source
+{
+public:
+    /// Reads at most `size` characters into the `buffer`.
+    /// Returns the number of characters read; it returns zero only at the end of the stream.
+    std::size_t operator()(char_type* buffer, std::size_t size);
+};
+#endif
+
+/// Reads from a FILE, e.g. stdin or a pipe.
+/// The characters are read in native endianness; read errors are treated as the end of the stream.
+struct stream_file_source
+{
+    std::FILE* file;
+
+    template <typename CharT>
+    std::size_t operator()(CharT* buffer, std::size_t size) const noexcept
+    {
+        return std::fread(buffer, sizeof(CharT), size, file);
+    }
+};
+
+/// An input that reads a stream on demand into a ring of fixed-size chunks.
+/// Chunks before a committed position are released again.
+template <typename Encoding = default_encoding, typename Source = stream_file_source,
+          typename MemoryResource = void>
+class stream_input
+{
+    using resource_ptr = _detail::memory_resource_ptr<MemoryResource>;
+
+public:
+    using encoding  = Encoding;
+    using char_type = typename encoding::char_type;
+
+    static constexpr std::size_t default_chunk_size = 4 * 1024;
+
+    //=== iterator ===//
+    // We identify a position by its index in the stream, which stays valid when chunks move.
+    class iterator : public _detail::forward_iterator_base<iterator, const char_type>
+    {
+    public:
+        constexpr iterator() = default;
+
+        explicit constexpr iterator(const stream_input& input, std::size_t idx) noexcept
+        : _input(&input), _idx(idx)
+        {}
+
+        const char_type& deref() const noexcept
+        {
+            return _input->_chunk(_idx / _input->_chunk_size)[_idx % _input->_chunk_size];
+        }
+
+        constexpr void increment() noexcept
+        {
+            ++_idx;
+        }
+
+        constexpr bool equal(iterator rhs) const noexcept
+        {
+            LEXY_PRECONDITION(_input == rhs._input);
+            return _idx == rhs._idx;
+        }
+
+        constexpr std::size_t index() const noexcept
+        {
+            return _idx;
+        }
+
+    private:
+        const stream_input* _input = nullptr;
+        std::size_t         _idx   = 0;
+    };
+
+    //=== reader ===//
+    class reader_type
+    {
+    public:
+        using encoding = Encoding;
+        using iterator = typename stream_input::iterator;
+
+        auto peek() const noexcept
+        {
+            if (_cur == _end)
+                return encoding::eof();
+            else
+                return encoding::to_int_type(*_cur);
+        }
+
+        void bump()
+        {
+            LEXY_PRECONDITION(_cur != _end);
+            ++_cur;
+            // We immediately switch to the next chunk, so peek() doesn't need to.
+            if (_cur == _end && _input->_load(_chunk + 1))
+                _set_chunk(_chunk + 1, 0);
+        }
+
+        iterator position() const noexcept
+        {
+            return iterator(*_input, _chunk * _input->_chunk_size + std::size_t(_cur - _begin));
+        }
+
+        void set_position(iterator new_pos) noexcept
+        {
+            auto chunk  = new_pos.index() / _input->_chunk_size;
+            auto offset = new_pos.index() % _input->_chunk_size;
+            if (chunk < _input->_last)
+                _set_chunk(chunk, offset);
+            else if (chunk > 0)
+                // The end of a stream that ends at a chunk boundary.
+                _set_chunk(chunk - 1, _input->_chunk_size);
+            else
+                // The end of an empty stream, where we don't have any chunk.
+                LEXY_PRECONDITION(offset == 0);
+        }
+
+        /// Releases all chunks before the line of the current position.
+        /// Afterwards, it must not backtrack before the current position.
+        void commit() noexcept
+        {
+            _input->_commit(_chunk, position().index());
+        }
+
+    private:
+        explicit reader_type(const stream_input& input) noexcept
+        : _input(&input), _begin(nullptr), _cur(nullptr), _end(nullptr), _chunk(0)
+        {
+            if (_input->_load(_input->_first))
+                set_position(iterator(input, _input->_anchor_idx));
+        }
+
+        void _set_chunk(std::size_t chunk, std::size_t offset) noexcept
+        {
+            _chunk = chunk;
+            _begin = _input->_chunk(chunk);
+            _end   = _begin + _input->_size(chunk);
+            _cur   = _begin + offset;
+            LEXY_PRECONDITION(_cur <= _end);
+        }
+
+        const stream_input* _input;
+        const char_type*    _begin;
+        const char_type*    _cur;
+        const char_type*    _end;
+        std::size_t         _chunk;
+
+        friend stream_input;
+    };
+
+    //=== constructors ===//
+    explicit stream_input(Source source, std::size_t chunk_size = default_chunk_size,
+                          MemoryResource* resource
+                          = _detail::get_memory_resource<MemoryResource>())
+    : _source(LEXY_MOV(source)), _resource(resource), _chunk_size(chunk_size), _ring(nullptr),
+      _ring_capacity(0), _spare(nullptr), _first(0), _last(0), _last_size(0), _max_live(0),
+      _eof(false), _anchor_idx(0), _anchor_line(1), _scanned(0)
+    {
+        LEXY_PRECONDITION(chunk_size > 0);
+    }
+    template <typename S = Source,
+              typename   = std::enable_if_t<std::is_same_v<S, stream_file_source>>>
+    explicit stream_input(std::FILE* file, std::size_t chunk_size = default_chunk_size,
+                          MemoryResource* resource
+                          = _detail::get_memory_resource<MemoryResource>())
+    : stream_input(stream_file_source{file}, chunk_size, resource)
+    {}
+
+    stream_input(const stream_input&) = delete;
+    stream_input& operator=(const stream_input&) = delete;
+
+    ~stream_input() noexcept
+    {
+        _release(_last);
+        _deallocate_chunk(_spare);
+        if (_ring_capacity > 0)
+            _resource->deallocate(_ring, _ring_capacity * sizeof(char_type*), alignof(char_type*));
+    }
+
+    //=== access ===//
+    /// The input can only be parsed once.
+    /// The reader starts at the beginning of the stream, or the line of the last commit.
+    reader_type reader() const&
+    {
+        return reader_type(*this);
+    }
+
+    std::size_t chunk_size() const noexcept
+    {
+        return _chunk_size;
+    }
+
+    /// The number of chunks that are currently in memory.
+    std::size_t live_chunks() const noexcept
+    {
+        return _last - _first;
+    }
+    /// The maximal number of chunks that have been in memory at the same time.
+    std::size_t max_live_chunks() const noexcept
+    {
+        return _max_live;
+    }
+
+    // implementation detail: used by input_location_anchor, as the lines before are released
+    struct _location_anchor_t
+    {
+        iterator line_begin;
+        unsigned line_nr;
+    };
+    _location_anchor_t _location_anchor() const noexcept
+    {
+        return {iterator(*this, _anchor_idx), _anchor_line};
+    }
+
+private:
+    const char_type* _chunk(std::size_t chunk) const noexcept
+    {
+        LEXY_PRECONDITION(_first <= chunk && chunk < _last);
+        return _ring[chunk & (_ring_capacity - 1)];
+    }
+
+    std::size_t _size(std::size_t chunk) const noexcept
+    {
+        return chunk + 1 == _last ? _last_size : _chunk_size;
+    }
+
+    // Ensures that the chunk is in memory; returns false if the stream ends before it.
+    bool _load(std::size_t chunk) const
+    {
+        LEXY_PRECONDITION(chunk <= _last);
+        if (chunk < _last)
+            return true;
+        else if (_eof)
+            return false;
+
+        auto memory = _spare != nullptr ? _spare : _allocate_chunk();
+        _spare      = nullptr;
+
+        auto size = std::size_t(0);
+        while (size < _chunk_size)
+        {
+            auto read = _source(memory + size, _chunk_size - size);
+            if (read == 0)
+            {
+                _eof = true;
+                break;
+            }
+            size += read;
+        }
+
+        if (size == 0)
+        {
+            _spare = memory;
+            return false;
+        }
+
+        if (_last - _first == _ring_capacity)
+            _grow_ring();
+        _ring[_last & (_ring_capacity - 1)] = memory;
+        ++_last;
+        _last_size = size;
+
+        if (_last - _first > _max_live)
+            _max_live = _last - _first;
+        return true;
+    }
+
+    // Releases the chunks before the line of the position, which is in the given chunk.
+    // We keep that line, so the location of positions after the commit can still be computed.
+    void _commit(std::size_t chunk, std::size_t idx) const noexcept
+    {
+        if constexpr (std::is_same_v<encoding, byte_encoding>)
+        {
+            // Binary input is split into lines of a fixed width instead.
+            constexpr auto line_width = std::size_t(16);
+            _anchor_idx               = idx / line_width * line_width;
+            _anchor_line              = unsigned(idx / line_width + 1);
+        }
+        else
+        {
+            while (_scanned < idx)
+            {
+                auto cur_chunk = _scanned / _chunk_size;
+                auto data      = _chunk(cur_chunk);
+                auto offset    = cur_chunk * _chunk_size;
+                auto end       = idx < offset + _chunk_size ? idx : offset + _chunk_size;
+                for (; _scanned != end; ++_scanned)
+                    if (data[_scanned - offset] == char_type('\n'))
+                    {
+                        _anchor_idx = _scanned + 1;
+                        ++_anchor_line;
+                    }
+            }
+        }
+
+        auto anchor_chunk = _anchor_idx / _chunk_size;
+        _release(anchor_chunk < chunk ? anchor_chunk : chunk);
+    }
+
+    // Releases all chunks before the given one.
+    void _release(std::size_t chunk) const noexcept
+    {
+        for (; _first < chunk; ++_first)
+        {
+            auto& memory = _ring[_first & (_ring_capacity - 1)];
+            if (_spare == nullptr)
+                _spare = memory;
+            else
+                _deallocate_chunk(memory);
+            memory = nullptr;
+        }
+    }
+
+    void _grow_ring() const
+    {
+        auto new_capacity = _ring_capacity == 0 ? std::size_t(8) : 2 * _ring_capacity;
+        auto new_ring     = static_cast<char_type**>(
+            _resource->allocate(new_capacity * sizeof(char_type*), alignof(char_type*)));
+
+        for (auto chunk = _first; chunk != _last; ++chunk)
+            new_ring[chunk & (new_capacity - 1)] = _ring[chunk & (_ring_capacity - 1)];
+        if (_ring_capacity > 0)
+            _resource->deallocate(_ring, _ring_capacity * sizeof(char_type*), alignof(char_type*));
+
+        _ring          = new_ring;
+        _ring_capacity = new_capacity;
+    }
+
+    char_type* _allocate_chunk() const
+    {
+        return static_cast<char_type*>(
+            _resource->allocate(_chunk_size * sizeof(char_type), alignof(char_type)));
+    }
+    void _deallocate_chunk(char_type* memory) const noexcept
+    {
+        if (memory != nullptr)
+            _resource->deallocate(memory, _chunk_size * sizeof(char_type), alignof(char_type));
+    }
+
+    // Reading only makes characters available that were conceptually there all along,
+    // so the input is logically const.
+    mutable Source                 _source;
+    LEXY_EMPTY_MEMBER resource_ptr _resource;
+    std::size_t                    _chunk_size;
+
+    // Chunk i is stored at _ring[i % _ring_capacity] for all _first <= i < _last.
+    mutable char_type** _ring;
+    mutable std::size_t _ring_capacity;
+    mutable char_type*  _spare;
+    mutable std::size_t _first, _last, _last_size, _max_live;
+    mutable bool        _eof;
+
+    // The beginning of the line of the last commit, its line number,
+    // and the position until which we've counted the lines.
+    mutable std::size_t _anchor_idx;
+    mutable unsigned    _anchor_line;
+    mutable std::size_t _scanned;
+};
+
+template <typename Source>
+stream_input(Source) -> stream_input<default_encoding, Source>;
+template <typename Source>
+stream_input(Source, std::size_t) -> stream_input<default_encoding, Source>;
+stream_input(std::FILE*)->stream_input<default_encoding, stream_file_source>;
+stream_input(std::FILE*, std::size_t)->stream_input<default_encoding, stream_file_source>;
+} // namespace lexy
+
+#endif // LEXY_INPUT_STREAM_INPUT_HPP_INCLUDED
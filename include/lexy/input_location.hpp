@@ -4,12 +4,21 @@
 #ifndef LEXY_INPUT_LOCATION_HPP_INCLUDED
 #define LEXY_INPUT_LOCATION_HPP_INCLUDED
 
+#include <cstring>
+#include <lexy/_detail/memory_resource.hpp>
+#include <lexy/_detail/simd.hpp>
 #include <lexy/dsl/code_point.hpp>
 #include <lexy/dsl/newline.hpp>
 #include <lexy/input/base.hpp>
 #include <lexy/lexeme.hpp>
 
 //=== input_location_anchor ===//
+namespace lexy::_detail
+{
+template <typename Input>
+using _detect_location_anchor = decltype(LEXY_DECLVAL(const Input&)._location_anchor());
+} // namespace lexy::_detail
+
 namespace lexy
 {
 /// Anchor for the location search.
@@ -20,7 +29,15 @@ struct input_location_anchor
 
     constexpr explicit input_location_anchor(const Input& input)
     : _line_begin(input.reader().position()), _line_nr(1)
-    {}
+    {
+        if constexpr (_detail::is_detected<_detail::_detect_location_anchor, Input>)
+        {
+            // A streaming input that has released the lines before this one.
+            auto anchor = input._location_anchor();
+            _line_begin = anchor.line_begin;
+            _line_nr    = anchor.line_nr;
+        }
+    }
 
     // implementation detail
     constexpr explicit input_location_anchor(iterator line_begin, unsigned line_nr)
@@ -273,6 +290,209 @@ constexpr auto get_input_location(const Input&                                 i
 }
 } // namespace lexy
 
+//=== line_index ===//
+namespace lexy::_detail
+{
+// Calls fn(ptr) for every pointer to a '\n' code unit in [begin, end), in order.
+template <typename CharT, typename Fn>
+void for_each_newline(const CharT* begin, const CharT* end, Fn fn)
+{
+    auto cur = begin;
+    if constexpr (sizeof(CharT) == 1)
+    {
+#if LEXY_HAS_AVX2
+        {
+            const auto newline = _mm256_set1_epi8('\n');
+            for (; end - cur >= 32; cur += 32)
+            {
+                auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cur));
+                auto mask  = unsigned(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, newline)));
+                for (; mask != 0; mask &= mask - 1)
+                    fn(cur + countr_zero(mask));
+            }
+        }
+#endif
+#if LEXY_HAS_SSE2
+        {
+            const auto newline = _mm_set1_epi8('\n');
+            for (; end - cur >= 16; cur += 16)
+            {
+                auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur));
+                auto mask  = unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(block, newline)));
+                for (; mask != 0; mask &= mask - 1)
+                    fn(cur + countr_zero(mask));
+            }
+        }
+#endif
+    }
+
+    for (; cur != end; ++cur)
+        if (*cur == CharT('\n'))
+            fn(cur);
+}
+
+template <typename Input>
+using _detect_input_data = decltype(LEXY_DECLVAL(const Input&).data(),
+                                    LEXY_DECLVAL(const Input&).size());
+} // namespace lexy::_detail
+
+namespace lexy
+{
+/// Stores the beginning of every line of the input, so locations can be found quickly.
+template <typename Input, typename MemoryResource = void>
+class line_index
+{
+    using iterator     = typename lexy::input_reader<Input>::iterator;
+    using encoding     = typename lexy::input_reader<Input>::encoding;
+    using resource_ptr = _detail::memory_resource_ptr<MemoryResource>;
+
+    static_assert(_detail::is_random_access_iterator<iterator>,
+                  "line_index requires random access iterators");
+    static_assert(!std::is_same_v<encoding, lexy::byte_encoding>,
+                  "line_index requires text input with newlines");
+
+    static constexpr std::size_t initial_capacity = 256;
+
+public:
+    //=== constructors/destructors/assignment ===//
+    explicit line_index(const Input&    input,
+                        MemoryResource* resource = _detail::get_memory_resource<MemoryResource>())
+    : _input(&input), _resource(resource), _offsets(nullptr), _count(0), _capacity(0)
+    {
+        _push(0);
+
+        auto reader = input.reader();
+        auto begin  = reader.position();
+        if constexpr (_detail::is_detected<_detail::_detect_input_data, Input> //
+                      && std::is_pointer_v<iterator>)
+        {
+            // The input is contiguous, so we can search for the newlines directly.
+            auto data = input.data();
+            _detail::for_each_newline(data, data + input.size(), [&](auto newline) {
+                _push(std::size_t(newline + 1 - begin));
+            });
+        }
+        else
+        {
+            while (true)
+            {
+                auto c = reader.peek();
+                if (c == encoding::eof())
+                    break;
+
+                reader.bump();
+                if (c == encoding::to_int_type('\n'))
+                    _push(std::size_t(reader.position() - begin));
+            }
+        }
+    }
+
+    line_index(line_index&& other) noexcept
+    : _input(other._input), _resource(other._resource), _offsets(other._offsets),
+      _count(other._count), _capacity(other._capacity)
+    {
+        other._offsets  = nullptr;
+        other._count    = 0;
+        other._capacity = 0;
+    }
+
+    ~line_index() noexcept
+    {
+        if (_capacity > 0)
+            _resource->deallocate(_offsets, _capacity * sizeof(std::size_t),
+                                  alignof(std::size_t));
+    }
+
+    line_index& operator=(line_index&& other) noexcept
+    {
+        lexy::_detail::swap(_input, other._input);
+        lexy::_detail::swap(_resource, other._resource);
+        lexy::_detail::swap(_offsets, other._offsets);
+        lexy::_detail::swap(_count, other._count);
+        lexy::_detail::swap(_capacity, other._capacity);
+        return *this;
+    }
+
+    //=== access ===//
+    const Input& input() const noexcept
+    {
+        return *_input;
+    }
+
+    /// The number of lines, which is one more than the number of newlines.
+    std::size_t line_count() const noexcept
+    {
+        return _count;
+    }
+
+    /// The anchor at the beginning of the line that contains the position.
+    input_location_anchor<Input> anchor(iterator position) const noexcept
+    {
+        auto begin  = _input->reader().position();
+        auto offset = std::size_t(position - begin);
+
+        // Find the last line that begins at or before the position.
+        // The first line begins at offset zero, so there always is one.
+        auto first = std::size_t(0);
+        auto count = _count;
+        while (count > 1)
+        {
+            auto half = count / 2;
+            if (_offsets[first + half] <= offset)
+                first += half;
+            count -= half;
+        }
+
+        return input_location_anchor<Input>(begin + _offsets[first], unsigned(first + 1));
+    }
+
+private:
+    void _push(std::size_t offset)
+    {
+        if (_count == _capacity)
+            _grow();
+        _offsets[_count++] = offset;
+    }
+
+    void _grow()
+    {
+        auto new_capacity = _capacity == 0 ? initial_capacity : 2 * _capacity;
+        auto new_offsets  = static_cast<std::size_t*>(
+            _resource->allocate(new_capacity * sizeof(std::size_t), alignof(std::size_t)));
+
+        if (_capacity > 0)
+        {
+            std::memcpy(new_offsets, _offsets, _count * sizeof(std::size_t));
+            _resource->deallocate(_offsets, _capacity * sizeof(std::size_t),
+                                  alignof(std::size_t));
+        }
+
+        _offsets  = new_offsets;
+        _capacity = new_capacity;
+    }
+
+    const Input*                   _input;
+    LEXY_EMPTY_MEMBER resource_ptr _resource;
+    std::size_t*                   _offsets;
+    std::size_t                    _count, _capacity;
+};
+
+/// The location for a position in the input; search starts at the beginning of its line.
+template <typename Counting, typename Input, typename MemoryResource>
+constexpr auto get_input_location(const line_index<Input, MemoryResource>&     index,
+                                  typename lexy::input_reader<Input>::iterator position)
+    -> input_location<Input, Counting>
+{
+    return get_input_location<Counting>(index.input(), position, index.anchor(position));
+}
+template <typename Input, typename MemoryResource>
+constexpr auto get_input_location(const line_index<Input, MemoryResource>&     index,
+                                  typename lexy::input_reader<Input>::iterator position)
+{
+    return get_input_location<_default_location_counting<Input>>(index, position);
+}
+} // namespace lexy
+
 //=== input_line_annotation ===//
 namespace lexy::_detail
 {
@@ -0,0 +1,416 @@
+// Copyright (C) 2020-2022 Jonathan Müller and lexy contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#ifndef LEXY_MAPPED_PARSE_TREE_HPP_INCLUDED
+#define LEXY_MAPPED_PARSE_TREE_HPP_INCLUDED
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <lexy/compact_parse_tree.hpp>
+#include <lexy/input/base.hpp>
+#include <lexy/input/file.hpp>
+
+namespace lexy
+{
+/// The version of the binary format of serialized parse trees.
+/// It is incremented whenever the format changes.
+constexpr std::uint32_t parse_tree_file_version = 1;
+} // namespace lexy
+
+//=== internal: parse tree file format ===//
+namespace lexy::_detail
+{
+// A serialized parse tree consists of the header, followed by the nodes in the layout of
+// cpt_nodes, the production table and the names of the productions.
+// All sections are aligned to four bytes and refer to each other using offsets.
+struct ptf_header
+{
+    char          magic[8];
+    std::uint32_t version;
+    // Written in native byte order, so we can detect a file written on a different platform.
+    std::uint32_t byte_order;
+    std::uint32_t char_size;
+    std::uint32_t input_size;
+    std::uint32_t node_count;
+    std::uint32_t depth;
+    std::uint32_t production_count;
+    std::uint32_t names_size;
+};
+static_assert(sizeof(ptf_header) == 40);
+
+constexpr char          ptf_magic[8]   = {'l', 'e', 'x', 'y', '-', 'p', 't', '\0'};
+constexpr std::uint32_t ptf_byte_order = 0x01020304;
+
+constexpr std::size_t ptf_align(std::size_t size) noexcept
+{
+    return (size + 3) & ~std::size_t(3);
+}
+
+constexpr std::size_t ptf_nodes_size(std::size_t node_count) noexcept
+{
+    // offset, size, kind, and type of each node.
+    return ptf_align(node_count * (2 * sizeof(std::uint32_t) + sizeof(std::uint16_t) + 1));
+}
+
+constexpr std::size_t ptf_productions_size(std::size_t production_count) noexcept
+{
+    // Offset of the name and whether it is a token production.
+    return ptf_align(production_count * (sizeof(std::uint32_t) + 1));
+}
+
+template <typename Iterator>
+struct ptf_input
+{
+    Iterator    begin;
+    std::size_t size;
+};
+
+template <typename Input>
+constexpr auto get_ptf_input(const Input& input)
+{
+    auto reader = input.reader();
+    auto begin  = reader.position();
+    if constexpr (_detail::is_contiguous_reader<decltype(reader)>)
+    {
+        return ptf_input<decltype(begin)>{begin, reader.remaining().size()};
+    }
+    else
+    {
+        while (reader.peek() != decltype(reader)::encoding::eof())
+            reader.bump();
+        return ptf_input<decltype(begin)>{begin, std::size_t(reader.position() - begin)};
+    }
+}
+
+// Calls write(data, size) for each piece of the serialized tree.
+// Returns false without writing anything if the input or tree is too big for the format.
+template <typename Tree, typename Input, typename Write>
+bool serialize_parse_tree(const Tree& tree, const Input& input, Write write)
+{
+    auto [begin, input_size] = get_ptf_input(input);
+    if (input_size > UINT32_MAX)
+        return false;
+
+    // We first flatten the tree into the layout of a compact_parse_tree.
+    // The offset of a production is the distance to its parent, so we don't need a stack.
+    using nodes_t = cpt_nodes<void>;
+    nodes_t                    nodes(get_memory_resource<void>());
+    cpt_production_table<void> productions(get_memory_resource<void>());
+    auto                       names_size = std::size_t(0);
+
+    auto cur = std::size_t(0);
+    for (auto [event, node] : tree.traverse())
+    {
+        if (event == lexy::traverse_event::enter)
+        {
+            auto kind  = node.kind();
+            auto count = productions.count();
+            auto idx   = productions.insert(kind.name(), kind.is_token_production());
+            if (productions.count() != count)
+                names_size += std::strlen(kind.name()) + 1;
+
+            auto node_idx = nodes.count();
+            nodes.push(nodes_t::type_production, idx, node_idx == 0 ? 0 : node_idx - cur, 1);
+            cur = node_idx;
+        }
+        else if (event == lexy::traverse_event::exit)
+        {
+            nodes.set_size(cur, nodes.count() - cur);
+            cur = nodes.production_parent(cur);
+        }
+        else
+        {
+            auto token = node.token();
+            auto kind  = LEXY_DECAY_DECLTYPE(token.kind())::to_raw(token.kind());
+            nodes.push(nodes_t::type_token, kind, std::size_t(token.lexeme().begin() - begin),
+                       token.lexeme().size());
+        }
+    }
+    if (nodes.overflowed() || nodes.count() > UINT32_MAX || names_size > UINT32_MAX)
+        return false;
+
+    constexpr char zeroes[4] = {};
+    auto           write_padded
+        = [&](std::size_t size, std::size_t aligned_size) { write(zeroes, aligned_size - size); };
+
+    ptf_header header{};
+    std::memcpy(header.magic, ptf_magic, sizeof(ptf_magic));
+    header.version          = lexy::parse_tree_file_version;
+    header.byte_order       = ptf_byte_order;
+    header.char_size        = std::uint32_t(sizeof(*begin));
+    header.input_size       = std::uint32_t(input_size);
+    header.node_count       = std::uint32_t(nodes.count());
+    header.depth            = std::uint32_t(tree.empty() ? 0 : tree.depth());
+    header.production_count = std::uint32_t(productions.count());
+    header.names_size       = std::uint32_t(names_size);
+    write(&header, sizeof(header));
+
+    if (nodes.count() > 0)
+    {
+        write(nodes.offset, nodes.count() * sizeof(*nodes.offset));
+        write(nodes.size, nodes.count() * sizeof(*nodes.size));
+        write(nodes.kind, nodes.count() * sizeof(*nodes.kind));
+        write(nodes.type, nodes.count() * sizeof(*nodes.type));
+        write_padded(nodes.count() * 11, ptf_nodes_size(nodes.count()));
+    }
+
+    auto name_offset = std::uint32_t(0);
+    for (auto idx = std::uint16_t(0); idx != productions.count(); ++idx)
+    {
+        write(&name_offset, sizeof(name_offset));
+        name_offset += std::uint32_t(std::strlen(productions.name(idx)) + 1);
+    }
+    for (auto idx = std::uint16_t(0); idx != productions.count(); ++idx)
+    {
+        auto token_production = std::uint8_t(productions.is_token_production(idx) ? 1 : 0);
+        write(&token_production, 1);
+    }
+    write_padded(productions.count() * 5, ptf_productions_size(productions.count()));
+
+    for (auto idx = std::uint16_t(0); idx != productions.count(); ++idx)
+        write(productions.name(idx), std::strlen(productions.name(idx)) + 1);
+    return true;
+}
+} // namespace lexy::_detail
+
+//=== serialization ===//
+namespace lexy
+{
+/// Serializes the parse tree of the input into a relocatable binary format and writes it to out.
+/// Nothing is written if the input or tree is too big for the format.
+template <typename OutputIt, typename Tree, typename Input>
+OutputIt serialize_parse_tree_to(OutputIt out, const Tree& tree, const Input& input)
+{
+    _detail::serialize_parse_tree(tree, input, [&](const void* data, std::size_t size) {
+        auto bytes = static_cast<const char*>(data);
+        for (auto i = std::size_t(0); i != size; ++i)
+            *out++ = bytes[i];
+    });
+    return out;
+}
+
+/// Serializes the parse tree of the input into a relocatable binary format and writes it to file.
+/// Returns false if the input or tree is too big for the format.
+template <typename Tree, typename Input>
+bool serialize_parse_tree(std::FILE* file, const Tree& tree, const Input& input)
+{
+    return _detail::serialize_parse_tree(tree, input, [&](const void* data, std::size_t size) {
+        std::fwrite(data, 1, size, file);
+    });
+}
+} // namespace lexy
+
+//=== mapped_parse_tree ===//
+namespace lexy
+{
+/// Errors that might occur while mapping a serialized parse tree.
+enum class mapped_parse_tree_error
+{
+    _success,
+    /// An internal OS error, such as failure to read from the file.
+    os_error,
+    /// The file was not found.
+    file_not_found,
+    /// The file cannot be opened.
+    permission_denied,
+    /// The file does not contain a serialized parse tree.
+    invalid_file,
+    /// The file was written by a different version of lexy or on a platform with different
+    /// byte order.
+    incompatible_format,
+    /// The tree was serialized for a different input.
+    input_mismatch,
+};
+
+/// A read-only parse tree whose nodes are stored in a mapped file.
+template <typename Reader, typename TokenKind = void>
+class mapped_parse_tree
+{
+public:
+    using tree_type      = lexy::compact_parse_tree<Reader, TokenKind>;
+    using node           = typename tree_type::node;
+    using node_kind      = typename tree_type::node_kind;
+    using traverse_range = typename tree_type::traverse_range;
+
+    mapped_parse_tree() = default;
+
+    //=== container access ===//
+    bool empty() const noexcept
+    {
+        return _tree.empty();
+    }
+
+    std::size_t size() const noexcept
+    {
+        return _tree.size();
+    }
+
+    std::size_t depth() const noexcept
+    {
+        return _tree.depth();
+    }
+
+    /// The compact_parse_tree that views the nodes of the file.
+    const tree_type& compact() const noexcept
+    {
+        return _tree;
+    }
+
+    //=== node access ===//
+    node root() const noexcept
+    {
+        return _tree.root();
+    }
+
+    //=== traverse ===//
+    traverse_range traverse(const node& n) const noexcept
+    {
+        return _tree.traverse(n);
+    }
+    traverse_range traverse() const noexcept
+    {
+        return _tree.traverse();
+    }
+
+public:
+    // Pretend this doesn't exist.
+    mapped_parse_tree_error _assign(lexy::mapped_file<byte_encoding>&& file,
+                                    typename Reader::iterator begin, std::size_t input_size)
+    {
+        LEXY_PRECONDITION(_tree.empty());
+        auto memory = file.data();
+        auto size   = file.size();
+
+        _detail::ptf_header header;
+        if (size < sizeof(header))
+            return mapped_parse_tree_error::invalid_file;
+        std::memcpy(&header, memory, sizeof(header));
+        if (std::memcmp(header.magic, _detail::ptf_magic, sizeof(header.magic)) != 0)
+            return mapped_parse_tree_error::invalid_file;
+        if (header.version != parse_tree_file_version
+            || header.byte_order != _detail::ptf_byte_order)
+            return mapped_parse_tree_error::incompatible_format;
+        if (header.char_size != sizeof(typename Reader::encoding::char_type)
+            || header.input_size != input_size)
+            return mapped_parse_tree_error::input_mismatch;
+
+        auto productions_offset = sizeof(header) + _detail::ptf_nodes_size(header.node_count);
+        auto names_offset
+            = productions_offset + _detail::ptf_productions_size(header.production_count);
+        if (header.production_count > UINT16_MAX || names_offset + header.names_size != size
+            || (header.names_size > 0 && memory[size - 1] != '\0'))
+            return mapped_parse_tree_error::invalid_file;
+
+        auto nodes       = memory + sizeof(header);
+        auto productions = memory + productions_offset;
+        auto flags       = productions + header.production_count * sizeof(std::uint32_t);
+        auto names       = memory + names_offset;
+
+        // We don't look at the nodes, but the production names have to be added to the table.
+        // As they're all distinct copies, they get the same indices as before.
+        _tree._productions.set_copied_names();
+        for (auto idx = std::size_t(0); idx != header.production_count; ++idx)
+        {
+            std::uint32_t name_offset;
+            std::memcpy(&name_offset, productions + idx * sizeof(name_offset), sizeof(name_offset));
+            if (name_offset >= header.names_size)
+            {
+                _tree.clear();
+                return mapped_parse_tree_error::invalid_file;
+            }
+
+            auto name = reinterpret_cast<const char*>(names + name_offset);
+            _tree._productions.insert(name, flags[idx] != 0);
+        }
+
+        _tree._nodes.assign_view(nodes, header.node_count);
+        _tree._begin = begin;
+        _tree._depth = header.depth;
+        _file        = LEXY_MOV(file);
+        return mapped_parse_tree_error::_success;
+    }
+
+private:
+    lexy::mapped_file<byte_encoding> _file;
+    tree_type                        _tree;
+};
+
+template <typename Input, typename TokenKind = void>
+using mapped_parse_tree_for = lexy::mapped_parse_tree<lexy::input_reader<Input>, TokenKind>;
+
+template <typename Reader, typename TokenKind = void>
+class map_parse_tree_result
+{
+public:
+    explicit operator bool() const noexcept
+    {
+        return _ec == mapped_parse_tree_error::_success;
+    }
+
+    const lexy::mapped_parse_tree<Reader, TokenKind>& tree() const& noexcept
+    {
+        LEXY_PRECONDITION(*this);
+        return _tree;
+    }
+    lexy::mapped_parse_tree<Reader, TokenKind>&& tree() && noexcept
+    {
+        LEXY_PRECONDITION(*this);
+        return LEXY_MOV(_tree);
+    }
+
+    mapped_parse_tree_error error() const noexcept
+    {
+        LEXY_PRECONDITION(!*this);
+        return _ec;
+    }
+
+public:
+    // Pretend these two don't exist.
+    explicit map_parse_tree_result(lexy::mapped_parse_tree<Reader, TokenKind>&& tree) noexcept
+    : _tree(LEXY_MOV(tree)), _ec(mapped_parse_tree_error::_success)
+    {}
+    explicit map_parse_tree_result(mapped_parse_tree_error ec) noexcept : _tree(), _ec(ec)
+    {
+        LEXY_PRECONDITION(!*this);
+    }
+
+private:
+    lexy::mapped_parse_tree<Reader, TokenKind> _tree;
+    mapped_parse_tree_error                    _ec;
+};
+
+/// Maps a parse tree of the input that was serialized into the file at the specified path.
+template <typename TokenKind = void, typename Input>
+auto map_parse_tree(const char* path, const Input& input)
+    -> map_parse_tree_result<lexy::input_reader<Input>, TokenKind>
+{
+    using result_type = map_parse_tree_result<lexy::input_reader<Input>, TokenKind>;
+
+    // We only access the nodes we need, so read-ahead is wasteful.
+    const char* memory = nullptr;
+    std::size_t size   = 0;
+    switch (_detail::map_file(path, mapped_file_advice::random, &memory, &size))
+    {
+    case file_error::_success:
+        break;
+    case file_error::os_error:
+        return result_type(mapped_parse_tree_error::os_error);
+    case file_error::file_not_found:
+        return result_type(mapped_parse_tree_error::file_not_found);
+    case file_error::permission_denied:
+        return result_type(mapped_parse_tree_error::permission_denied);
+    }
+
+    auto [begin, input_size] = _detail::get_ptf_input(input);
+
+    lexy::mapped_parse_tree<lexy::input_reader<Input>, TokenKind> tree;
+    auto ec = tree._assign(mapped_file<byte_encoding>(memory, size, 0), begin, input_size);
+    if (ec != mapped_parse_tree_error::_success)
+        return result_type(ec);
+    return result_type(LEXY_MOV(tree));
+}
+} // namespace lexy
+
+#endif // LEXY_MAPPED_PARSE_TREE_HPP_INCLUDED
+
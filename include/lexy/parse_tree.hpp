@@ -186,39 +186,59 @@ struct pt_node_production : pt_node<Reader>
 namespace lexy::_detail
 {
 // Basic stack allocator to store all the nodes of a tree.
+// It owns a list of blocks that grow geometrically and are kept around when the buffer is reset,
+// so parsing into the same tree again doesn't need to allocate.
 template <typename MemoryResource>
 class pt_buffer
 {
     using resource_ptr = _detail::memory_resource_ptr<MemoryResource>;
 
-    static constexpr std::size_t block_size = 4096 - sizeof(void*);
+    // The first block takes up 4 KiB including its header, every following one twice as much as
+    // the previous one, up to 1 MiB.
+    static constexpr std::size_t initial_block_size = 4096;
+    static constexpr std::size_t max_block_size     = 1024 * 1024;
 
     struct block
     {
-        block*        next;
-        unsigned char memory[block_size];
+        block*      next;
+        std::size_t size; // Number of bytes following the header.
 
-        static block* allocate(resource_ptr resource)
+        static block* allocate(resource_ptr resource, std::size_t size)
         {
-            auto memory = resource->allocate(sizeof(block), alignof(block));
-            auto ptr    = ::new (memory) block; // Don't initialize array!
+            auto memory = resource->allocate(sizeof(block) + size, alignof(block));
+            auto ptr    = ::new (memory) block; // Don't initialize the memory!
             ptr->next   = nullptr;
+            ptr->size   = size;
             return ptr;
         }
 
         static block* deallocate(resource_ptr resource, block* ptr)
         {
             auto next = ptr->next;
-            resource->deallocate(ptr, sizeof(block), alignof(block));
+            resource->deallocate(ptr, sizeof(block) + ptr->size, alignof(block));
             return next;
         }
 
+        unsigned char* memory() noexcept
+        {
+            // NOLINTNEXTLINE: The memory is allocated together with the header.
+            return reinterpret_cast<unsigned char*>(this + 1);
+        }
         unsigned char* end() noexcept
         {
-            return &memory[block_size];
+            return memory() + size;
         }
     };
 
+    static std::size_t next_block_size(const block* prev) noexcept
+    {
+        if (prev == nullptr)
+            return initial_block_size - sizeof(block);
+
+        auto size = 2 * (sizeof(block) + prev->size);
+        return (size < max_block_size ? size : max_block_size) - sizeof(block);
+    }
+
 public:
     //=== constructors/destructors/assignment ===//
     explicit constexpr pt_buffer(MemoryResource* resource) noexcept
@@ -258,20 +278,57 @@ public:
     void reset()
     {
         if (!_head)
-            _head = block::allocate(_resource);
+            _head = block::allocate(_resource, next_block_size(nullptr));
 
         _cur_block = _head;
-        _cur_pos   = &_cur_block->memory[0];
+        _cur_pos   = _cur_block->memory();
+    }
+
+    // Ensures that the blocks have a total capacity of at least the given number of bytes.
+    // If necessary, this allocates a single block for everything that is missing.
+    void reserve_capacity(std::size_t bytes)
+    {
+        auto last     = static_cast<block*>(nullptr);
+        auto capacity = std::size_t(0);
+        for (auto cur = _head; cur != nullptr; cur = cur->next)
+        {
+            last = cur;
+            capacity += cur->size;
+        }
+        if (capacity >= bytes)
+            return;
+
+        auto size = next_block_size(last);
+        if (size < bytes - capacity)
+            size = bytes - capacity;
+
+        auto next = block::allocate(_resource, size);
+        if (last == nullptr)
+        {
+            _head      = next;
+            _cur_block = _head;
+            _cur_pos   = _cur_block->memory();
+        }
+        else
+        {
+            last->next = next;
+        }
     }
 
     void reserve(std::size_t size)
     {
         if (remaining_capacity() < size)
         {
-            auto next        = block::allocate(_resource);
-            _cur_block->next = next;
-            _cur_block       = next;
-            _cur_pos         = &_cur_block->memory[0];
+            // Reuse the blocks of a previous tree before allocating new ones.
+            auto next = _cur_block->next;
+            if (next == nullptr)
+            {
+                next             = block::allocate(_resource, next_block_size(_cur_block));
+                _cur_block->next = next;
+            }
+
+            _cur_block = next;
+            _cur_pos   = _cur_block->memory();
         }
     }
 
@@ -301,7 +358,7 @@ public:
         // Note: this is not guaranteed to work by the standard;
         // We'd have to go through std::less instead.
         // However, on all implementations I care about, std::less just does < anyway.
-        if (_cur_block->memory <= pos && pos < _cur_block->end())
+        if (_cur_block->memory() <= pos && pos < _cur_block->end())
             // We're still in the same block, just reset position.
             _cur_pos = pos;
         else
@@ -309,7 +366,7 @@ public:
             // This can waste memory, but this is not a problem here:
             // unwind() is only used to backtrack a production, which happens after a couple of
             // tokens only; the memory waste is directly proportional to the lookahead length.
-            _cur_pos = _cur_block->memory;
+            _cur_pos = _cur_block->memory();
     }
 
 private:
@@ -364,6 +421,13 @@ public:
         _root = nullptr;
     }
 
+    /// Ensures that the tree can store nodes taking up the given number of bytes without
+    /// allocating.
+    void reserve(std::size_t bytes)
+    {
+        _buffer.reserve_capacity(bytes);
+    }
+
     //=== node access ===//
     class node;
     class node_kind;
@@ -0,0 +1,383 @@
+// Copyright (C) 2020-2022 Jonathan Müller and lexy contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#ifndef LEXY_STRUCTURAL_INDEX_HPP_INCLUDED
+#define LEXY_STRUCTURAL_INDEX_HPP_INCLUDED
+
+#include <cstdint>
+#include <cstring>
+#include <lexy/_detail/assert.hpp>
+#include <lexy/_detail/config.hpp>
+#include <lexy/_detail/memory_resource.hpp>
+#include <lexy/_detail/simd.hpp>
+#include <lexy/input/base.hpp>
+
+//=== structural characters ===//
+namespace lexy::_detail
+{
+// The bit masks of the interesting characters of a block of 64 bytes.
+struct structural_block
+{
+    std::uint64_t quote, backslash, op;
+};
+
+inline structural_block classify_structural_block(const unsigned char* block) noexcept
+{
+    structural_block result{0, 0, 0};
+#if LEXY_HAS_SSE2
+    for (auto i = 0u; i != 4; ++i)
+    {
+        auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * i));
+        auto eq    = [&](char c) { return _mm_cmpeq_epi8(chunk, _mm_set1_epi8(c)); };
+        auto mask  = [](__m128i v) { return std::uint64_t(unsigned(_mm_movemask_epi8(v))); };
+
+        auto square = _mm_or_si128(eq('['), eq(']'));
+        auto curly  = _mm_or_si128(eq('{'), eq('}'));
+        auto op = _mm_or_si128(_mm_or_si128(square, curly), _mm_or_si128(eq(','), eq(':')));
+
+        result.quote |= mask(eq('"')) << (16 * i);
+        result.backslash |= mask(eq('\\')) << (16 * i);
+        result.op |= mask(op) << (16 * i);
+    }
+#else
+    for (auto i = 0u; i != 64; ++i)
+    {
+        auto bit = std::uint64_t(1) << i;
+        switch (block[i])
+        {
+        case '"':
+            result.quote |= bit;
+            break;
+        case '\\':
+            result.backslash |= bit;
+            break;
+        case '[':
+        case ']':
+        case '{':
+        case '}':
+        case ',':
+        case ':':
+            result.op |= bit;
+            break;
+        default:
+            break;
+        }
+    }
+#endif
+    return result;
+}
+
+// Returns the characters that are escaped by an odd number of backslashes before them.
+// carry is set if the block ends in an odd number of backslashes.
+inline std::uint64_t find_escaped_chars(std::uint64_t backslash, std::uint64_t& carry) noexcept
+{
+    constexpr auto even_bits = std::uint64_t(0x5555555555555555);
+    constexpr auto odd_bits  = ~even_bits;
+
+    // The first backslash of each sequence of backslashes.
+    auto starts = backslash & ~(backslash << 1);
+    // If the previous block ended in an escape, the first character here is escaped.
+    auto even_start_mask = even_bits ^ carry;
+    auto even_starts     = starts & even_start_mask;
+    auto odd_starts      = starts & ~even_start_mask;
+
+    // Adding the start to a sequence carries into the bit after the sequence.
+    auto even_carries = backslash + even_starts;
+    auto odd_carries  = backslash + odd_starts;
+    auto overflow     = odd_carries < backslash;
+    odd_carries |= carry;
+    carry = overflow ? 1 : 0;
+
+    auto even_carry_ends = even_carries & ~backslash;
+    auto odd_carry_ends  = odd_carries & ~backslash;
+    // A sequence has odd length if it starts and ends at positions of different parity.
+    return (even_carry_ends & odd_bits) | (odd_carry_ends & even_bits);
+}
+
+// Sets every bit that has an odd number of bits set at or below it.
+inline std::uint64_t prefix_xor(std::uint64_t bits) noexcept
+{
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+// Calls fn(offset, mask) for every block of 64 bytes in [data, data + size).
+// The mask has a bit set for every `[]{},:` in the block that is outside of a `"` string.
+// Returns whether the last string is closed.
+template <typename Fn>
+bool for_each_structural_block(const unsigned char* data, std::size_t size, Fn fn)
+{
+    std::uint64_t escape_carry = 0;
+    std::uint64_t in_string    = 0;
+
+    auto process = [&](const unsigned char* block, std::size_t offset) {
+        auto chars = classify_structural_block(block);
+
+        auto escaped = find_escaped_chars(chars.backslash, escape_carry);
+        auto quotes  = chars.quote & ~escaped;
+
+        // The mask covers the opening quote up to the character before the closing quote.
+        auto string_mask = prefix_xor(quotes) ^ in_string;
+        in_string        = std::uint64_t(0) - (string_mask >> 63);
+
+        fn(offset, chars.op & ~string_mask);
+    };
+
+    auto offset = std::size_t(0);
+    for (; offset + 64 <= size; offset += 64)
+        process(data + offset, offset);
+    if (offset != size)
+    {
+        unsigned char block[64];
+        std::memset(block, ' ', sizeof(block));
+        std::memcpy(block, data + offset, size - offset);
+        process(block, offset);
+    }
+
+    return in_string == 0;
+}
+
+} // namespace lexy::_detail
+
+//=== structural_index ===//
+namespace lexy
+{
+/// Stores the position of every bracket and separator of a JSON-like input outside of strings.
+template <typename Input, typename MemoryResource = void>
+class structural_index
+{
+    using iterator     = typename lexy::input_reader<Input>::iterator;
+    using resource_ptr = _detail::memory_resource_ptr<MemoryResource>;
+
+    static_assert(std::is_pointer_v<iterator> && sizeof(*iterator()) == 1,
+                  "structural_index requires contiguous input of bytes");
+
+    // For brackets: the index of the matching bracket.
+    // For separators: the index of the opening bracket they belong to, npos at the top-level.
+    struct entry
+    {
+        std::uint32_t offset;
+        std::uint32_t link;
+    };
+
+    static constexpr auto npos = std::uint32_t(-1);
+
+public:
+    //=== constructors/destructors/assignment ===//
+    explicit structural_index(const Input&    input,
+                              MemoryResource* resource
+                              = _detail::get_memory_resource<MemoryResource>())
+    : _input(&input), _resource(resource), _entries(nullptr), _count(0), _capacity(0),
+      _balanced(true)
+    {
+        LEXY_PRECONDITION(input.size() < npos);
+        auto data = reinterpret_cast<const unsigned char*>(input.data());
+
+        // First pass: count the structural characters, so we can allocate the memory once.
+        auto count = std::size_t(0);
+        _detail::for_each_structural_block(data, input.size(),
+                                           [&](std::size_t, std::uint64_t mask) {
+                                               count += _detail::popcount64(mask);
+                                           });
+        _allocate(count);
+
+        // Second pass: store their offsets.
+        auto strings_closed = _detail::for_each_structural_block( //
+            data, input.size(), [&](std::size_t offset, std::uint64_t mask) {
+                // We write the offsets in groups of eight, which avoids a mispredicted branch per
+                // bit; the garbage written after the last one is overwritten later.
+                auto out = _entries + _count;
+                _count += _detail::popcount64(mask);
+                while (mask != 0)
+                    for (auto i = 0; i != 8; ++i)
+                    {
+                        // The high bit keeps countr_zero defined once the mask is empty.
+                        auto bit = _detail::countr_zero64(mask | (std::uint64_t(1) << 63));
+                        (out++)->offset = std::uint32_t(offset + bit);
+                        mask &= mask - 1;
+                    }
+            });
+        if (!strings_closed)
+            _balanced = false;
+
+        // Third pass: link the brackets.
+        // While a bracket is open, its link is the bracket it is nested in.
+        auto open = npos;
+        for (auto idx = std::uint32_t(0); idx != _count; ++idx)
+        {
+            auto c = data[_entries[idx].offset];
+            if (c == '[' || c == '{')
+            {
+                _entries[idx].link = open;
+                open               = idx;
+            }
+            else if (c == ']' || c == '}')
+            {
+                if (open == npos || data[_entries[open].offset] != _opening(c))
+                {
+                    // Link it to itself, so it is consistent.
+                    _balanced          = false;
+                    _entries[idx].link = idx;
+                    continue;
+                }
+
+                auto parent         = _entries[open].link;
+                _entries[open].link = idx;
+                _entries[idx].link  = open;
+                open                = parent;
+            }
+            else
+            {
+                _entries[idx].link = open;
+            }
+        }
+        if (open != npos)
+            _balanced = false;
+    }
+
+    structural_index(structural_index&& other) noexcept
+    : _input(other._input), _resource(other._resource), _entries(other._entries),
+      _count(other._count), _capacity(other._capacity), _balanced(other._balanced)
+    {
+        other._entries  = nullptr;
+        other._count    = 0;
+        other._capacity = 0;
+    }
+
+    ~structural_index() noexcept
+    {
+        if (_capacity > 0)
+            _resource->deallocate(_entries, _capacity * sizeof(entry), alignof(entry));
+    }
+
+    structural_index& operator=(structural_index&& other) noexcept
+    {
+        lexy::_detail::swap(_input, other._input);
+        lexy::_detail::swap(_resource, other._resource);
+        lexy::_detail::swap(_entries, other._entries);
+        lexy::_detail::swap(_count, other._count);
+        lexy::_detail::swap(_capacity, other._capacity);
+        lexy::_detail::swap(_balanced, other._balanced);
+        return *this;
+    }
+
+    //=== access ===//
+    const Input& input() const noexcept
+    {
+        return *_input;
+    }
+
+    /// The number of brackets and separators.
+    std::size_t size() const noexcept
+    {
+        return _count;
+    }
+
+    /// Whether all brackets are matched and all strings are closed.
+    bool is_balanced() const noexcept
+    {
+        return _balanced;
+    }
+
+    /// The position of the bracket that matches the one at the position.
+    iterator matching_bracket(iterator bracket) const noexcept
+    {
+        LEXY_PRECONDITION(_balanced);
+        auto idx = _find(bracket);
+        LEXY_PRECONDITION(idx < _count && _position(idx) == bracket);
+        return _position(_entries[idx].link);
+    }
+
+    /// The position of the first `,` or `:` of the brackets opened at open that is at or after
+    /// the position, or the closing bracket if there is none.
+    iterator next_separator(iterator open, iterator position) const noexcept
+    {
+        LEXY_PRECONDITION(_balanced);
+        auto open_idx = _find(open);
+        LEXY_PRECONDITION(open_idx < _count && _position(open_idx) == open);
+        auto close_idx = _entries[open_idx].link;
+
+        auto data = _input->data();
+        for (auto idx = _find(position); idx < close_idx;)
+        {
+            switch (data[_entries[idx].offset])
+            {
+            case '[':
+            case '{':
+                // Skip over nested brackets.
+                idx = _entries[idx].link + 1;
+                break;
+
+            case ',':
+            case ':':
+                if (_entries[idx].link == open_idx)
+                    return _position(idx);
+                ++idx;
+                break;
+
+            default:
+                // The closing bracket of nested brackets we've started in.
+                ++idx;
+                break;
+            }
+        }
+
+        return _position(close_idx);
+    }
+
+private:
+    static constexpr unsigned char _opening(unsigned char close) noexcept
+    {
+        return close == ']' ? '[' : '{';
+    }
+
+    iterator _position(std::uint32_t idx) const noexcept
+    {
+        return _input->data() + _entries[idx].offset;
+    }
+
+    // The index of the first entry at or after the position.
+    std::uint32_t _find(iterator position) const noexcept
+    {
+        auto offset = std::size_t(position - _input->data());
+
+        auto first = std::size_t(0);
+        auto count = _count;
+        while (count > 0)
+        {
+            auto half = count / 2;
+            if (_entries[first + half].offset < offset)
+            {
+                first += half + 1;
+                count -= half + 1;
+            }
+            else
+            {
+                count = half;
+            }
+        }
+        return std::uint32_t(first);
+    }
+
+    void _allocate(std::size_t count)
+    {
+        // We write up to 64 entries at once, so we need some padding.
+        _capacity = count + 64;
+        _entries  = static_cast<entry*>(
+            _resource->allocate(_capacity * sizeof(entry), alignof(entry)));
+    }
+
+    const Input*                   _input;
+    LEXY_EMPTY_MEMBER resource_ptr _resource;
+    entry*                         _entries;
+    std::size_t                    _count, _capacity;
+    bool                           _balanced;
+};
+} // namespace lexy
+
+#endif // LEXY_STRUCTURAL_INDEX_HPP_INCLUDED
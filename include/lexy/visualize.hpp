@@ -5,7 +5,9 @@
 #define LEXY_VISUALIZE_HPP_INCLUDED
 
 #include <cstdio>
+#include <cstring>
 #include <lexy/_detail/config.hpp>
+#include <lexy/_detail/detect.hpp>
 #include <lexy/dsl/code_point.hpp>
 #include <lexy/input/range_input.hpp>
 #include <lexy/lexeme.hpp>
@@ -90,18 +92,40 @@ constexpr auto make_literal_lexeme(const typename Encoding::char_type* str, std:
     return lexy::lexeme<reader>(str, str + length);
 }
 
+// An output iterator can provide `write(str, length)` to append multiple characters at once.
+template <typename OutIt>
+using _detect_bulk_write
+    = decltype(LEXY_DECLVAL(OutIt&).write(LEXY_DECLVAL(const char*), std::size_t(0)));
+template <typename OutIt>
+constexpr auto has_bulk_write = is_detected<_detect_bulk_write, OutIt>;
+
 template <typename OutIt>
 constexpr OutIt write_str(OutIt out, const char* str)
 {
-    while (*str)
-        *out++ = *str++;
+    if constexpr (has_bulk_write<OutIt>)
+    {
+        out.write(str, std::strlen(str));
+    }
+    else
+    {
+        while (*str)
+            *out++ = *str++;
+    }
     return out;
 }
 template <typename OutIt>
 constexpr OutIt write_str(OutIt out, const LEXY_CHAR8_T* str)
 {
-    while (*str)
-        *out++ = static_cast<char>(*str++);
+    if constexpr (has_bulk_write<OutIt>)
+    {
+        auto cstr = reinterpret_cast<const char*>(str);
+        out.write(cstr, std::strlen(cstr));
+    }
+    else
+    {
+        while (*str)
+            *out++ = static_cast<char>(*str++);
+    }
     return out;
 }
 
@@ -112,11 +136,29 @@ constexpr OutIt write_format(OutIt out, const char* fmt, const Args&... args)
     auto count = std::snprintf(buffer, N, fmt, args...);
     LEXY_ASSERT(count <= N, "buffer not big enough");
 
-    for (auto i = 0; i != count; ++i)
-        *out++ = buffer[i];
+    if constexpr (has_bulk_write<OutIt>)
+    {
+        out.write(buffer, std::size_t(count));
+    }
+    else
+    {
+        for (auto i = 0; i != count; ++i)
+            *out++ = buffer[i];
+    }
     return out;
 }
 
+// Whether `visualize_to()` writes the ASCII character as-is.
+constexpr bool is_plain_visualized(unsigned char c, visualization_options opts) noexcept
+{
+    if (c == ' ')
+        return !opts.is_set(visualize_space);
+    else if (c == '\\')
+        return opts.is_set(visualize_use_unicode);
+    else
+        return c > ' ' && c < 0x7F;
+}
+
 enum class color
 {
     reset  = 0,
@@ -363,12 +405,49 @@ OutputIt visualize_to(OutputIt out, lexy::lexeme<Reader> lexeme,
     };
 
     using encoding = typename Reader::encoding;
+    using iterator = typename Reader::iterator;
+
+    // If we can write multiple characters at once, we do that for runs of plain characters.
+    // Returns true if we've reached `opts.max_lexeme_width`.
+    [[maybe_unused]] auto write_plain_run
+        = [opts](auto& out, auto& cur, auto end, unsigned& count) {
+              auto remaining = opts.max_lexeme_width - count;
+              if (opts.max_lexeme_width != 0 && unsigned(end - cur) > remaining)
+                  end = cur + remaining;
+
+              auto begin = cur;
+              while (cur != end
+                     && _detail::is_plain_visualized(static_cast<unsigned char>(*cur), opts))
+                  ++cur;
+              if (begin == cur)
+                  return false;
+
+              out.write(reinterpret_cast<const char*>(begin), std::size_t(cur - begin));
+              count += unsigned(cur - begin);
+              return count == opts.max_lexeme_width;
+          };
+    constexpr auto use_plain_runs = _detail::has_bulk_write<OutputIt> //
+                                    && std::is_pointer_v<iterator>
+                                    && sizeof(typename encoding::char_type) == 1;
+
     if constexpr (std::is_same_v<encoding, lexy::ascii_encoding> //
                   || std::is_same_v<encoding, lexy::default_encoding>)
     {
         auto count = 0u;
-        for (char c : lexeme)
+        for (auto cur = lexeme.begin(); cur != lexeme.end();)
         {
+            if constexpr (use_plain_runs)
+            {
+                if (write_plain_run(out, cur, lexeme.end(), count))
+                {
+                    out = _detail::write_ellipsis(out, opts);
+                    break;
+                }
+                else if (cur == lexeme.end())
+                    break;
+            }
+
+            auto c = *cur++;
             // If the character is in fact ASCII, visualize the code point.
             // Otherwise, visualize as byte.
             if (lexy::_detail::is_ascii(c))
@@ -396,6 +475,17 @@ OutputIt visualize_to(OutputIt out, lexy::lexeme<Reader> lexeme,
         auto count = 0u;
         while (true)
         {
+            if constexpr (use_plain_runs)
+            {
+                auto cur = reader.position();
+                if (write_plain_run(out, cur, lexeme.end(), count))
+                {
+                    out = _detail::write_ellipsis(out, opts);
+                    break;
+                }
+                reader.set_position(cur);
+            }
+
             if (auto result = lexy::_detail::parse_code_point(reader);
                 result.error == lexy::_detail::cp_error::eof)
             {
@@ -615,13 +705,108 @@ struct cfile_output_iterator
         std::fputc(c, _file);
         return *this;
     }
+
+    void write(const char* str, std::size_t length)
+    {
+        std::fwrite(str, 1, length, _file);
+    }
+};
+
+/// Collects output in a buffer and writes it to the FILE in bulk.
+class cfile_output_buffer
+{
+public:
+    static constexpr std::size_t capacity = 4 * 1024;
+
+    class iterator
+    {
+    public:
+        explicit constexpr iterator(cfile_output_buffer& buffer) noexcept : _buffer(&buffer) {}
+
+        iterator& operator*() noexcept
+        {
+            return *this;
+        }
+        iterator& operator++(int) noexcept
+        {
+            return *this;
+        }
+
+        iterator& operator=(char c)
+        {
+            _buffer->put(c);
+            return *this;
+        }
+
+        void write(const char* str, std::size_t length)
+        {
+            _buffer->write(str, length);
+        }
+
+    private:
+        cfile_output_buffer* _buffer;
+    };
+
+    explicit cfile_output_buffer(std::FILE* file) noexcept : _file(file), _size(0) {}
+
+    ~cfile_output_buffer() noexcept
+    {
+        flush();
+    }
+
+    cfile_output_buffer(const cfile_output_buffer&) = delete;
+    cfile_output_buffer& operator=(const cfile_output_buffer&) = delete;
+
+    /// An output iterator that appends to the buffer.
+    iterator output_iterator() noexcept
+    {
+        return iterator(*this);
+    }
+
+    void put(char c)
+    {
+        if (_size == capacity)
+            flush();
+        _buffer[_size++] = c;
+    }
+
+    void write(const char* str, std::size_t length)
+    {
+        if (length > capacity - _size)
+        {
+            flush();
+            if (length >= capacity)
+            {
+                // No point in copying it to the buffer first.
+                std::fwrite(str, 1, length, _file);
+                return;
+            }
+        }
+
+        std::memcpy(_buffer + _size, str, length);
+        _size += length;
+    }
+
+    /// Writes the buffered output to the FILE.
+    void flush() noexcept
+    {
+        if (_size > 0)
+            std::fwrite(_buffer, 1, _size, _file);
+        _size = 0;
+    }
+
+private:
+    std::FILE*  _file;
+    std::size_t _size;
+    char        _buffer[capacity];
 };
 
 /// Writes the visualization to the FILE.
 template <typename T>
 void visualize(std::FILE* file, const T& obj, visualization_options opts = {})
 {
-    visualize_to(cfile_output_iterator{file}, obj, opts);
+    cfile_output_buffer buffer(file);
+    visualize_to(buffer.output_iterator(), obj, opts);
 }
 } // namespace lexy
 
@@ -7,6 +7,7 @@
 #include <cctype>
 #include <cstdio>
 #include <doctest/doctest.h>
+#include <lexy/compact_parse_tree.hpp>
 #include <lexy/parse_tree.hpp>
 
 namespace lexy_ext
@@ -138,6 +139,48 @@ public:
         return toString(desc) == string_maker::convert(tree);
     }
 
+    template <typename Reader, typename MemoryResource>
+    friend bool operator==(const parse_tree_desc&                                             desc,
+                           const lexy::compact_parse_tree<Reader, TokenKind, MemoryResource>& tree)
+    {
+        using string_maker
+            = doctest::StringMaker<lexy::compact_parse_tree<Reader, TokenKind, MemoryResource>>;
+        return toString(desc) == string_maker::convert(tree);
+    }
+    template <typename Reader, typename MemoryResource>
+    friend bool operator==(const lexy::compact_parse_tree<Reader, TokenKind, MemoryResource>& tree,
+                           const parse_tree_desc&                                             desc)
+    {
+        using string_maker
+            = doctest::StringMaker<lexy::compact_parse_tree<Reader, TokenKind, MemoryResource>>;
+        return toString(desc) == string_maker::convert(tree);
+    }
+
+    template <typename Tree>
+    static doctest::String _convert(const Tree& tree)
+    {
+        parse_tree_desc builder;
+
+        for (auto [event, node] : tree.traverse())
+            switch (event)
+            {
+            case lexy::traverse_event::enter:
+                builder.production(node.kind().name());
+                break;
+            case lexy::traverse_event::exit:
+                builder.finish();
+                break;
+
+            case lexy::traverse_event::leaf: {
+                auto token = node.token();
+                builder.token(token.kind(), token.lexeme().begin(), token.lexeme().end());
+                break;
+            }
+            }
+
+        return toString(builder);
+    }
+
 private:
     void prefix()
     {
@@ -167,26 +210,18 @@ struct StringMaker<lexy::parse_tree<Reader, TokenKind, MemoryResource>>
 
     static String convert(const parse_tree& tree)
     {
-        lexy_ext::parse_tree_desc<TokenKind> builder;
-
-        for (auto [event, node] : tree.traverse())
-            switch (event)
-            {
-            case lexy::traverse_event::enter:
-                builder.production(node.kind().name());
-                break;
-            case lexy::traverse_event::exit:
-                builder.finish();
-                break;
+        return lexy_ext::parse_tree_desc<TokenKind>::_convert(tree);
+    }
+};
 
-            case lexy::traverse_event::leaf: {
-                auto token = node.token();
-                builder.token(token.kind(), token.lexeme().begin(), token.lexeme().end());
-                break;
-            }
-            }
+template <typename Reader, typename TokenKind, typename MemoryResource>
+struct StringMaker<lexy::compact_parse_tree<Reader, TokenKind, MemoryResource>>
+{
+    using parse_tree = lexy::compact_parse_tree<Reader, TokenKind, MemoryResource>;
 
-        return toString(builder);
+    static String convert(const parse_tree& tree)
+    {
+        return lexy_ext::parse_tree_desc<TokenKind>::_convert(tree);
     }
 };
 } // namespace doctest
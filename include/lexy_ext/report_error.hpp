@@ -145,16 +145,26 @@ struct error_writer
 
 namespace lexy_ext::_detail
 {
-template <typename OutputIt, typename Production, typename Input, typename Reader, typename Tag>
+template <typename OutputIt, typename Production, typename Input, typename Reader, typename Tag,
+          typename LineIndex = void>
 OutputIt write_error(OutputIt out, const lexy::error_context<Production, Input>& context,
-                     const lexy::error<Reader, Tag>& error, lexy::visualization_options opts)
+                     const lexy::error<Reader, Tag>& error, lexy::visualization_options opts,
+                     const LineIndex* index = nullptr)
 {
     _detail::error_writer<Input> writer{&context.input(), opts};
 
     // Convert the context location and error location into line/column information.
-    auto context_location = lexy::get_input_location(context.input(), context.position());
-    auto location
-        = lexy::get_input_location(context.input(), error.position(), context_location.anchor());
+    // If we have a line index, we only need to search from the beginning of their lines.
+    lexy::input_location_anchor<Input> context_anchor(context.input());
+    if constexpr (!std::is_void_v<LineIndex>)
+        context_anchor = index->anchor(context.position());
+    auto context_location
+        = lexy::get_input_location(context.input(), context.position(), context_anchor);
+
+    auto anchor = context_location.anchor();
+    if constexpr (!std::is_void_v<LineIndex>)
+        anchor = index->anchor(error.position());
+    auto location = lexy::get_input_location(context.input(), error.position(), anchor);
 
     // Write the main error headline.
     out = writer.write_message(out, [&](OutputIt out, lexy::visualization_options) {
@@ -225,11 +235,15 @@ OutputIt write_error(OutputIt out, const lexy::error_context<Production, Input>&
 
 namespace lexy_ext
 {
+template <typename LineIndex = void>
 struct _report_error
 {
+    const LineIndex* _index;
+
     struct _sink
     {
-        std::size_t _count;
+        const LineIndex* _index;
+        std::size_t      _count;
 
         using return_type = std::size_t;
 
@@ -237,8 +251,9 @@ struct _report_error
         void operator()(const lexy::error_context<Production, Input>& context,
                         const lexy::error<Reader, Tag>&               error)
         {
-            _detail::write_error(lexy::cfile_output_iterator{stderr}, context, error,
-                                 {lexy::visualize_fancy});
+            lexy::cfile_output_buffer buffer(stderr);
+            _detail::write_error(buffer.output_iterator(), context, error,
+                                 {lexy::visualize_fancy}, _index);
             ++_count;
         }
 
@@ -252,12 +267,20 @@ struct _report_error
 
     constexpr auto sink() const
     {
-        return _sink{};
+        return _sink{_index, 0};
+    }
+
+    // Uses the line index to compute the locations of the errors.
+    // It must have been created for the input that is being parsed.
+    template <typename Input, typename MemoryResource>
+    constexpr auto index(const lexy::line_index<Input, MemoryResource>& index) const
+    {
+        return _report_error<lexy::line_index<Input, MemoryResource>>{&index};
     }
 };
 
 // The error callback that prints to stderr.
-constexpr auto report_error = _report_error{};
+constexpr auto report_error = _report_error<>{};
 } // namespace lexy_ext
 
 #endif // LEXY_EXT_REPORT_ERROR_HPP_INCLUDED
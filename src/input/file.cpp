@@ -107,6 +107,57 @@ lexy::file_error lexy::_detail::read_file(const char* path, file_callback cb, vo
     return lexy::file_error::_success;
 }
 
+lexy::file_error lexy::_detail::map_file(const char* path, mapped_file_advice advice,
+                                         const char** memory, std::size_t* size)
+{
+    raii_fd fd(::open(path, O_RDONLY));
+    if (fd < 0)
+        return get_file_error();
+
+    auto off = ::lseek(fd, 0, SEEK_END);
+    if (off == static_cast<::off_t>(-1))
+        return lexy::file_error::os_error;
+    auto file_size = static_cast<std::size_t>(off);
+
+    if (file_size == 0)
+    {
+        // We can't map an empty file.
+        *memory = nullptr;
+        *size   = 0;
+        return lexy::file_error::_success;
+    }
+
+    auto mapping = ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) // NOLINT: int-to-ptr conversion happens in header
+        return lexy::file_error::os_error;
+
+    // The advice is only a hint, so we don't care whether it fails.
+    switch (advice)
+    {
+    case mapped_file_advice::normal:
+        break;
+    case mapped_file_advice::sequential:
+        ::posix_madvise(mapping, file_size, POSIX_MADV_SEQUENTIAL);
+        break;
+    case mapped_file_advice::random:
+        ::posix_madvise(mapping, file_size, POSIX_MADV_RANDOM);
+        break;
+    case mapped_file_advice::willneed:
+        ::posix_madvise(mapping, file_size, POSIX_MADV_WILLNEED);
+        break;
+    }
+
+    *memory = static_cast<const char*>(mapping);
+    *size   = file_size;
+    return lexy::file_error::_success;
+}
+
+void lexy::_detail::unmap_file(const char* memory, std::size_t size) noexcept
+{
+    // NOLINTNEXTLINE: munmap() takes a non-const pointer.
+    ::munmap(const_cast<char*>(memory), size);
+}
+
 #else // portable read_file() using C I/O
 
 namespace
@@ -183,6 +234,48 @@ lexy::file_error lexy::_detail::read_file(const char* path, file_callback cb, vo
     return file_error::_success;
 }
 
+lexy::file_error lexy::_detail::map_file(const char* path, mapped_file_advice,
+                                         const char** memory, std::size_t* size)
+{
+    // We can't map the file, so we read it into heap memory instead.
+    raii_file file(std::fopen(path, "rb"));
+    if (!file)
+        return get_file_error();
+
+    if (std::fseek(file, 0, SEEK_END) != 0)
+        return lexy::file_error::os_error;
+
+    auto file_size = std::ftell(file);
+    if (file_size == -1)
+        return lexy::file_error::os_error;
+
+    if (std::fseek(file, 0, SEEK_SET) != 0)
+        return lexy::file_error::os_error;
+
+    if (file_size == 0)
+    {
+        *memory = nullptr;
+        *size   = 0;
+        return lexy::file_error::_success;
+    }
+
+    auto data = new char[std::size_t(file_size)];
+    if (std::fread(data, sizeof(char), std::size_t(file_size), file) != std::size_t(file_size))
+    {
+        delete[] data;
+        return lexy::file_error::os_error;
+    }
+
+    *memory = data;
+    *size   = std::size_t(file_size);
+    return lexy::file_error::_success;
+}
+
+void lexy::_detail::unmap_file(const char* memory, std::size_t) noexcept
+{
+    delete[] memory;
+}
+
 #endif
 
 // When reading from stdin, performance doesn't really matter.
@@ -3,3 +3,102 @@
 
 #include <lexy/action/base.hpp>
 
+#include <doctest/doctest.h>
+
+namespace
+{
+struct dummy_handler
+{};
+using control_block_t = lexy::_detail::parse_context_control_block<dummy_handler>;
+
+struct context
+{
+    control_block_t* control_block;
+};
+
+template <int I>
+struct id
+{};
+template <int I>
+using var = lexy::_detail::parse_context_var<id<I>, int>;
+} // namespace
+
+TEST_CASE("_detail::parse_context_var")
+{
+    control_block_t cb(dummy_handler{}, nullptr, 0);
+    context         ctx{&cb};
+
+    SUBCASE("multiple")
+    {
+        var<0> v0(0);
+        var<1> v1(1);
+        var<2> v2(2);
+        var<3> v3(3);
+        var<4> v4(4);
+        var<5> v5(5);
+        var<6> v6(6);
+        var<7> v7(7);
+        var<8> v8(8);
+        // With more variables than slots, at least one has to be found in the list.
+        static_assert(lexy::_detail::parse_context_var_slots < 9);
+
+        v0.link(ctx);
+        v1.link(ctx);
+        v2.link(ctx);
+        v3.link(ctx);
+        v4.link(ctx);
+        v5.link(ctx);
+        v6.link(ctx);
+        v7.link(ctx);
+        v8.link(ctx);
+
+        CHECK(var<0>::get(&cb) == 0);
+        CHECK(var<1>::get(&cb) == 1);
+        CHECK(var<2>::get(&cb) == 2);
+        CHECK(var<3>::get(&cb) == 3);
+        CHECK(var<4>::get(&cb) == 4);
+        CHECK(var<5>::get(&cb) == 5);
+        CHECK(var<6>::get(&cb) == 6);
+        CHECK(var<7>::get(&cb) == 7);
+        CHECK(var<8>::get(&cb) == 8);
+
+        var<4>::get(&cb) = 42;
+        CHECK(v4.value == 42);
+
+        v8.unlink(ctx);
+        v7.unlink(ctx);
+        v6.unlink(ctx);
+        v5.unlink(ctx);
+        v4.unlink(ctx);
+        CHECK(var<0>::get(&cb) == 0);
+        CHECK(var<3>::get(&cb) == 3);
+        v3.unlink(ctx);
+        v2.unlink(ctx);
+        v1.unlink(ctx);
+        v0.unlink(ctx);
+
+        CHECK(cb.vars == nullptr);
+        for (auto slot : cb.var_slots)
+            CHECK(slot == nullptr);
+    }
+    SUBCASE("shadowing")
+    {
+        var<0> outer(0);
+        outer.link(ctx);
+        CHECK(var<0>::get(&cb) == 0);
+
+        var<0> inner(1);
+        inner.link(ctx);
+        CHECK(var<0>::get(&cb) == 1);
+
+        inner.unlink(ctx);
+        CHECK(var<0>::get(&cb) == 0);
+        outer.unlink(ctx);
+    }
+    SUBCASE("index")
+    {
+        auto index = lexy::_detail::parse_context_var_index<id<0>>();
+        CHECK(lexy::_detail::parse_context_var_index<id<0>>() == index);
+        CHECK(lexy::_detail::parse_context_var_index<id<1>>() != index);
+    }
+}
@@ -3,10 +3,14 @@
 
 #include <lexy/action/parse_as_tree.hpp>
 
+#include <algorithm>
 #include <doctest/doctest.h>
+#include <lexy/callback/fold.hpp>
 #include <lexy/dsl.hpp>
+#include <lexy/input/range_input.hpp>
 #include <lexy/input/string_input.hpp>
 #include <lexy_ext/parse_tree_doctest.hpp>
+#include <string>
 
 namespace
 {
@@ -179,3 +183,317 @@ TEST_CASE("parse_as_tree")
     }
 }
 
+
+TEST_CASE("parse_as_tree compact_parse_tree")
+{
+    using compact_parse_tree = lexy::compact_parse_tree_for<lexy::string_input<>, token_kind>;
+    compact_parse_tree tree;
+
+    SUBCASE("parenthesized")
+    {
+        auto input  = lexy::zstring_input("123(abc)321");
+        auto result = lexy::parse_as_tree<root_p>(tree, input, lexy::noop);
+        CHECK(result);
+
+        // clang-format off
+        auto expected = lexy_ext::parse_tree_desc<token_kind>(root_p{})
+            .token(token_kind::a, "123")
+            .production(child_p{})
+                .token(token_kind::b, "(")
+                .production(abc_p{})
+                    .token(token_kind::c, "abc")
+                    .finish()
+                .token(token_kind::b, ")")
+                .finish()
+            .token(token_kind::a, "321")
+            .token(lexy::eof_token_kind, "");
+        // clang-format on
+        CHECK(tree == expected);
+    }
+    SUBCASE("failure")
+    {
+        tree = compact_parse_tree::builder(root_p{}).finish();
+        CHECK(!tree.empty());
+
+        auto input  = lexy::zstring_input("123(abc");
+        auto result = lexy::parse_as_tree<root_p>(tree, input, lexy::noop);
+        CHECK(!result);
+        CHECK(tree.empty());
+    }
+    SUBCASE("recovered")
+    {
+        auto input  = lexy::zstring_input("123(abxxx)321");
+        auto result = lexy::parse_as_tree<root_p>(tree, input, lexy::noop);
+        CHECK(!result);
+        // clang-format off
+        auto expected = lexy_ext::parse_tree_desc<token_kind>(root_p{})
+            .token(token_kind::a, "123")
+            .production(child_p{})
+                .token(token_kind::b, "(")
+                .token(lexy::error_token_kind, "abxxx")
+                .token(token_kind::b, ")")
+                .finish()
+            .token(token_kind::a, "321")
+            .token(lexy::eof_token_kind, "");
+        // clang-format on
+        CHECK(tree == expected);
+    }
+}
+
+namespace
+{
+// Every character of the input is 2 GiB apart, so a few of them are enough to overflow the
+// offsets of a compact parse tree without allocating anything.
+struct sparse_iterator
+{
+    static constexpr std::uint64_t step = std::uint64_t(1) << 31;
+
+    std::uint64_t pos;
+
+    char operator*() const
+    {
+        return 'a';
+    }
+    sparse_iterator& operator++()
+    {
+        pos += step;
+        return *this;
+    }
+    sparse_iterator operator++(int)
+    {
+        auto result = *this;
+        ++*this;
+        return result;
+    }
+
+    friend sparse_iterator operator+(sparse_iterator iter, std::size_t n)
+    {
+        return {iter.pos + n};
+    }
+    friend std::ptrdiff_t operator-(sparse_iterator lhs, sparse_iterator rhs)
+    {
+        return std::ptrdiff_t(lhs.pos - rhs.pos);
+    }
+
+    friend bool operator==(sparse_iterator lhs, sparse_iterator rhs)
+    {
+        return lhs.pos == rhs.pos;
+    }
+    friend bool operator!=(sparse_iterator lhs, sparse_iterator rhs)
+    {
+        return lhs.pos != rhs.pos;
+    }
+    friend bool operator<=(sparse_iterator lhs, sparse_iterator rhs)
+    {
+        return lhs.pos <= rhs.pos;
+    }
+};
+
+struct sparse_p
+{
+    static constexpr auto name = "sparse_p";
+    static constexpr auto rule = lexy::dsl::while_(LEXY_LIT("a")) + lexy::dsl::eof;
+};
+} // namespace
+
+TEST_CASE("parse_as_tree compact_parse_tree overflow")
+{
+    if constexpr (sizeof(std::size_t) > sizeof(std::uint32_t))
+    {
+        using input_t = lexy::range_input<lexy::default_encoding, sparse_iterator>;
+        lexy::compact_parse_tree_for<input_t> tree;
+
+        SUBCASE("fits")
+        {
+            auto input  = input_t(sparse_iterator{0}, sparse_iterator{sparse_iterator::step});
+            auto result = lexy::parse_as_tree<sparse_p>(tree, input, lexy::count);
+            CHECK(result.is_success());
+            CHECK(!tree.empty());
+        }
+        SUBCASE("overflow")
+        {
+            // The EOF token begins at offset 2^32.
+            auto input  = input_t(sparse_iterator{0}, sparse_iterator{2 * sparse_iterator::step});
+            auto result = lexy::parse_as_tree<sparse_p>(tree, input, lexy::count);
+            CHECK(result.is_fatal_error());
+            CHECK(result.error_count() == 1);
+            CHECK(tree.empty());
+        }
+    }
+}
+
+namespace
+{
+struct block_p
+{
+    static constexpr auto name = "block_p";
+    static constexpr auto rule = [] {
+        auto block = lexy::dsl::peek(lexy::dsl::lit_c<'{'>) >> lexy::dsl::recurse<block_p>;
+        auto item  = lexy::dsl::digits<>.kind<token_kind::a> | block;
+        return lexy::dsl::curly_bracketed.opt_list(item, lexy::dsl::sep(lexy::dsl::comma));
+    }();
+};
+
+struct document_p
+{
+    static constexpr auto name       = "document_p";
+    static constexpr auto whitespace = lexy::dsl::ascii::space;
+    static constexpr auto rule
+        = lexy::dsl::terminator(lexy::dsl::eof).opt_list(lexy::dsl::p<block_p>);
+};
+
+template <typename Tree>
+bool same_tree(const Tree& lhs, const Tree& rhs)
+{
+    if (lhs.empty() || rhs.empty())
+        return lhs.empty() == rhs.empty();
+    else if (lhs.size() != rhs.size() || lhs.depth() != rhs.depth())
+        return false;
+
+    auto lhs_range = lhs.traverse();
+    auto rhs_range = rhs.traverse();
+    auto rhs_iter  = rhs_range.begin();
+    for (auto [event, node] : lhs_range)
+    {
+        if (rhs_iter == rhs_range.end())
+            return false;
+
+        auto [rhs_event, rhs_node] = *rhs_iter++;
+        if (event != rhs_event || node.kind() != rhs_node.kind()
+            || node.parent().kind() != rhs_node.parent().kind()
+            || node.lexeme().begin() != rhs_node.lexeme().begin()
+            || node.lexeme().end() != rhs_node.lexeme().end())
+            return false;
+    }
+    return rhs_iter == rhs_range.end();
+}
+} // namespace
+
+TEST_CASE("reparse_as_tree")
+{
+    using compact_parse_tree = lexy::compact_parse_tree_for<lexy::string_input<>, token_kind>;
+    compact_parse_tree tree, expected;
+
+    // Parses the old input, applies the edit and checks that the result is the same as parsing the
+    // new input from scratch.
+    auto check_reparse = [&](const char* old_str, const char* new_str, lexy::input_edit edit) {
+        auto old_input = lexy::zstring_input(old_str);
+        REQUIRE(lexy::parse_as_tree<document_p>(tree, old_input, lexy::noop));
+
+        auto input  = lexy::zstring_input(new_str);
+        auto result = lexy::reparse_as_tree<document_p, block_p>(tree, input, edit, lexy::noop);
+
+        auto expected_result = lexy::parse_as_tree<document_p>(expected, input, lexy::noop);
+        CHECK(result.error_count() == expected_result.error_count());
+        CHECK(same_tree(tree, expected));
+        return result.is_success();
+    };
+
+    SUBCASE("nested block")
+    {
+        CHECK(check_reparse("{1, {2, 3}, 4} {5}", "{1, {22, 3}, 4} {5}", {5, 1, 2}));
+        CHECK(check_reparse("{1, {2, 3}, 4} {5}", "{1, {3}, 4} {5}", {5, 3, 0}));
+        CHECK(check_reparse("{1, {2, 3}, 4} {5}", "{1, {2, 3 , {}}, 4} {5}", {9, 0, 5}));
+    }
+    SUBCASE("depth")
+    {
+        CHECK(check_reparse("{{{1}}} {2}", "{1} {2}", {1, 5, 1}));
+        CHECK(check_reparse("{1} {2}", "{{{1}}} {2}", {1, 1, 5}));
+    }
+    SUBCASE("edit at the boundary")
+    {
+        CHECK(check_reparse("{1} {2}", "{1} {2}{3}", {7, 0, 3}));
+        CHECK(check_reparse("{1} {2}", "{1}  {2}", {3, 0, 1}));
+        CHECK(check_reparse("{1} {2}", "{1} {2, 3}", {6, 0, 3}));
+    }
+    SUBCASE("error")
+    {
+        CHECK(!check_reparse("{1, {2}, 3}", "{1, {2, 3}", {6, 1, 0}));
+        CHECK(!check_reparse("{1, 2}", "{1, x}", {4, 1, 1}));
+    }
+    SUBCASE("errors in the old input")
+    {
+        auto old_input = lexy::zstring_input("{1, x} {2}");
+        CHECK(!lexy::parse_as_tree<document_p>(tree, old_input, lexy::noop));
+        CHECK(tree.had_errors());
+
+        // The edit doesn't touch the error, but we still need to report it again.
+        auto input  = lexy::zstring_input("{1, x} {23}");
+        auto result = lexy::reparse_as_tree<document_p, block_p>(tree, input, {9, 1, 2},
+                                                                 lexy::noop);
+        CHECK(result.error_count() == 1);
+        CHECK(tree.had_errors());
+
+        auto fixed = lexy::zstring_input("{1, 5} {23}");
+        CHECK(lexy::reparse_as_tree<document_p, block_p>(tree, fixed, {4, 1, 1}, lexy::noop));
+        CHECK(!tree.had_errors());
+    }
+    SUBCASE("only the production is parsed again")
+    {
+        // We change text outside of the edit, which isn't parsed again.
+        auto old_input = lexy::zstring_input("{1} {2}");
+        REQUIRE(lexy::parse_as_tree<document_p>(tree, old_input, lexy::noop));
+
+        auto input = lexy::zstring_input("{x} {23}");
+        CHECK(lexy::reparse_as_tree<document_p, block_p>(tree, input, {5, 1, 2}, lexy::noop));
+
+        // clang-format off
+        auto expected_tree = lexy_ext::parse_tree_desc<token_kind>(document_p{})
+            .production(block_p{})
+                .token(lexy::literal_token_kind, "{")
+                .token(token_kind::a, "x")
+                .token(lexy::literal_token_kind, "}")
+                .whitespace(" ")
+                .finish()
+            .production(block_p{})
+                .token(lexy::literal_token_kind, "{")
+                .token(token_kind::a, "23")
+                .token(lexy::literal_token_kind, "}")
+                .finish()
+            .token(lexy::eof_token_kind, "");
+        // clang-format on
+        CHECK(tree == expected_tree);
+    }
+    SUBCASE("random edits")
+    {
+        auto initial = std::string("{1, {2, {}}, 3} {4, {5, 6}}");
+        auto str     = initial;
+        auto rng     = 42u;
+        auto random  = [&](std::size_t n) {
+            rng = rng * 1103515245u + 12345u;
+            return std::size_t((rng >> 16) % n);
+        };
+
+        REQUIRE(lexy::parse_as_tree<document_p>(tree, lexy::string_input(str), lexy::noop));
+        for (auto i = 0; i != 1000; ++i)
+        {
+            auto edit     = lexy::input_edit{random(str.size() + 1), 0, 0};
+            edit.removed  = std::min(random(3), str.size() - edit.offset);
+            auto inserted = std::string();
+            for (auto n = random(5); n > 0; --n)
+                inserted += "{}, 12"[random(6)];
+            edit.inserted = inserted.size();
+
+            auto new_str = str;
+            new_str.replace(edit.offset, edit.removed, inserted);
+            INFO(str);
+            INFO(new_str);
+
+            auto input  = lexy::string_input(new_str);
+            auto result = lexy::reparse_as_tree<document_p, block_p>(tree, input, edit, lexy::noop);
+            auto expected_result = lexy::parse_as_tree<document_p>(expected, input, lexy::noop);
+            CHECK(result.error_count() == expected_result.error_count());
+            CHECK(same_tree(tree, expected));
+
+            if (result)
+                str = LEXY_MOV(new_str);
+            if (!result || str.size() > 4 * initial.size())
+            {
+                // We continue with a valid input that doesn't grow too much.
+                if (result)
+                    str = initial;
+                REQUIRE(lexy::parse_as_tree<document_p>(tree, lexy::string_input(str), lexy::noop));
+            }
+        }
+    }
+}
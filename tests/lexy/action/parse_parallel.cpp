@@ -0,0 +1,255 @@
+// Copyright (C) 2020-2022 Jonathan Müller and lexy contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#include <lexy/action/parse_parallel.hpp>
+
+#include <doctest/doctest.h>
+#include <lexy/callback.hpp>
+#include <lexy/dsl/ascii.hpp>
+#include <lexy/dsl/digit.hpp>
+#include <lexy/dsl/integer.hpp>
+#include <lexy/dsl/newline.hpp>
+#include <lexy/dsl/punctuator.hpp>
+#include <lexy/dsl/recover.hpp>
+#include <lexy/dsl/sequence.hpp>
+#include <lexy/input/buffer.hpp>
+#include <lexy/input/string_input.hpp>
+#include <string>
+#include <vector>
+
+namespace
+{
+namespace dsl = lexy::dsl;
+
+struct record_p
+{
+    static constexpr auto rule  = dsl::integer<int> + dsl::eol;
+    static constexpr auto value = lexy::forward<int>;
+};
+
+// Doesn't consume the newline at the end of the record.
+struct incomplete_record_p
+{
+    static constexpr auto rule  = dsl::integer<int>;
+    static constexpr auto value = lexy::forward<int>;
+};
+
+struct throwing_record_p
+{
+    static constexpr auto rule  = dsl::integer<int> + dsl::eol;
+    static constexpr auto value = lexy::callback<int>([](int i) {
+        if (i == 500)
+            throw i;
+        return i;
+    });
+};
+
+struct void_record_p
+{
+    static constexpr auto rule  = dsl::digits<> + dsl::eol;
+    static constexpr auto value = lexy::noop;
+};
+
+struct state_record_p
+{
+    static constexpr auto rule = dsl::integer<int> + dsl::eol;
+    static constexpr auto value
+        = lexy::bind(lexy::callback<int>([](int state, int i) { return state + i; }),
+                     lexy::parse_state, lexy::values);
+};
+
+struct error_info
+{
+    const char* position;
+    const char* production_begin;
+};
+
+constexpr auto collect_errors
+    = lexy::callback<error_info>([](const auto& context, const auto& error) {
+          return error_info{error.position(), context.position()};
+      });
+
+std::string make_records(unsigned count)
+{
+    std::string result;
+    for (auto i = 0u; i != count; ++i)
+    {
+        result += std::to_string(i);
+        result += '\n';
+    }
+    return result;
+}
+} // namespace
+
+TEST_CASE("line_splitter")
+{
+    auto split = [](const char* str) {
+        auto end = str + std::char_traits<char>::length(str);
+        return lexy::line_splitter(str, end) - str;
+    };
+
+    CHECK(split("") == 0);
+    CHECK(split("abc") == 3);
+    CHECK(split("abc\n") == 4);
+    CHECK(split("abc\ndef") == 4);
+    CHECK(split("\n\n") == 1);
+
+    auto utf16 = u"ab\ncd";
+    CHECK(lexy::line_splitter(utf16, utf16 + 5) == utf16 + 3);
+}
+
+TEST_CASE("parse_parallel")
+{
+    auto sink = lexy::as_list<std::vector<int>>;
+
+    SUBCASE("empty")
+    {
+        auto input  = lexy::zstring_input("");
+        auto result = lexy::parse_parallel<record_p>(input, 4, lexy::line_splitter, sink,
+                                                     lexy::noop);
+        CHECK(result);
+        CHECK(result.value().empty());
+    }
+    SUBCASE("single thread")
+    {
+        auto str    = make_records(100);
+        auto input  = lexy::string_input(str);
+        auto result = lexy::parse_parallel<record_p>(input, 1, lexy::line_splitter, sink,
+                                                     lexy::noop);
+        REQUIRE(result);
+        REQUIRE(result.value().size() == 100);
+        for (auto i = 0; i != 100; ++i)
+            CHECK(result.value()[std::size_t(i)] == i);
+    }
+    SUBCASE("multiple threads")
+    {
+        auto str = make_records(10000);
+        for (auto n_threads : {2u, 3u, 8u, 0u})
+        {
+            INFO(n_threads);
+
+            auto input  = lexy::string_input(str);
+            auto result = lexy::parse_parallel<record_p>(input, n_threads, lexy::line_splitter,
+                                                         sink, lexy::noop);
+            REQUIRE(result);
+            REQUIRE(result.value().size() == 10000);
+            for (auto i = 0; i != 10000; ++i)
+                CHECK(result.value()[std::size_t(i)] == i);
+        }
+    }
+    SUBCASE("fewer records than chunks")
+    {
+        auto input  = lexy::zstring_input("1\n2\n3");
+        auto result = lexy::parse_parallel<record_p>(input, 8, lexy::line_splitter, sink,
+                                                     lexy::noop);
+        REQUIRE(result);
+        CHECK(result.value() == std::vector<int>{1, 2, 3});
+    }
+    SUBCASE("void production")
+    {
+        auto str    = make_records(1000);
+        auto input  = lexy::string_input(str);
+        auto result = lexy::parse_parallel<void_record_p>(input, 4, lexy::line_splitter,
+                                                          lexy::count, lexy::noop);
+        REQUIRE(result);
+        CHECK(result.value() == 1000);
+    }
+    SUBCASE("state")
+    {
+        auto str    = make_records(1000);
+        auto input  = lexy::string_input(str);
+        auto result = lexy::parse_parallel<state_record_p>(input, 100, 4, lexy::line_splitter,
+                                                           sink, lexy::noop);
+        REQUIRE(result);
+        REQUIRE(result.value().size() == 1000);
+        for (auto i = 0; i != 1000; ++i)
+            CHECK(result.value()[std::size_t(i)] == 100 + i);
+    }
+    SUBCASE("errors")
+    {
+        auto str = make_records(1000);
+        str.replace(str.find("\n500\n") + 1, 1, "x");
+        str.replace(str.find("\n20\n") + 1, 1, "x");
+        auto input = lexy::string_input(str);
+
+        auto result = lexy::parse_parallel<record_p>(input, 4, lexy::line_splitter, sink,
+                                                     lexy::collect<std::vector<error_info>>(
+                                                         collect_errors));
+        CHECK(!result);
+        CHECK(result.is_fatal_error());
+        REQUIRE(result.error_count() == 2);
+
+        // The errors are in input order and relative to the entire input.
+        auto first  = str.find("x0\n");
+        auto second = str.find("x00\n");
+        CHECK(result.errors()[0].position == input.data() + first);
+        CHECK(result.errors()[0].production_begin == input.data() + first);
+        CHECK(result.errors()[1].position == input.data() + second);
+        CHECK(result.errors()[1].production_begin == input.data() + second);
+    }
+    SUBCASE("incomplete record")
+    {
+        auto input  = lexy::zstring_input("1\n2\n3");
+        auto errors = lexy::collect<std::vector<error_info>>(collect_errors);
+        auto result = lexy::parse_parallel<incomplete_record_p>(input, 2, lexy::line_splitter,
+                                                                sink, errors);
+        CHECK(!result);
+        CHECK(result.is_fatal_error());
+        REQUIRE(result.error_count() == 2);
+
+        // The last record has no newline, so it is parsed completely.
+        CHECK(result.errors()[0].position == input.data() + 1);
+        CHECK(result.errors()[0].production_begin == input.data());
+        CHECK(result.errors()[1].position == input.data() + 3);
+        CHECK(result.errors()[1].production_begin == input.data() + 2);
+    }
+    SUBCASE("buffer")
+    {
+        // Records aren't parsed with the reader of the buffer, but the errors are for the buffer.
+        using buffer = lexy::buffer<lexy::utf8_encoding>;
+        auto offset  = [](const auto& context, auto position) {
+            return std::size_t(position - context.input().data());
+        };
+        auto callback = lexy::callback<std::size_t>(
+            [=](const auto& context, const lexy::error_for<buffer, lexy::expected_eof>& error) {
+                return offset(context, error.position());
+            },
+            [=](const auto& context,
+                const lexy::error_for<buffer, lexy::expected_char_class>& error) {
+                return offset(context, error.position());
+            },
+            [=](const auto& context, const lexy::error_for<buffer, lexy::integer_overflow>& error) {
+                return offset(context, error.position());
+            });
+
+        auto input  = buffer("1\nx\n3", 5);
+        auto result = lexy::parse_parallel<incomplete_record_p>(input, 2, lexy::line_splitter,
+                                                                sink,
+                                                                lexy::collect<std::vector<
+                                                                    std::size_t>>(callback));
+        CHECK(!result);
+        CHECK(result.errors() == std::vector<std::size_t>{1, 2});
+    }
+    SUBCASE("exception")
+    {
+        auto str = make_records(10000);
+        for (auto n_threads : {1u, 4u})
+        {
+            INFO(n_threads);
+
+            auto input  = lexy::string_input(str);
+            auto thrown = false;
+            try
+            {
+                lexy::parse_parallel<throwing_record_p>(input, n_threads, lexy::line_splitter,
+                                                        sink, lexy::noop);
+            }
+            catch (int i)
+            {
+                CHECK(i == 500);
+                thrown = true;
+            }
+            CHECK(thrown);
+        }
+    }
+}
@@ -0,0 +1,187 @@
+// Copyright (C) 2020-2022 Jonathan Müller and lexy contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#include <lexy/action/record_trace.hpp>
+
+#include <doctest/doctest.h>
+#include <iterator>
+#include <lexy/dsl.hpp>
+#include <lexy/input/string_input.hpp>
+#include <string>
+
+namespace
+{
+namespace dsl = lexy::dsl;
+
+struct id
+{
+    static constexpr auto name = "id";
+    static constexpr auto rule = dsl::identifier(dsl::ascii::alpha);
+};
+
+struct number
+{
+    static constexpr auto name = "number";
+    static constexpr auto rule = dsl::identifier(dsl::ascii::digit);
+};
+
+struct list
+{
+    static constexpr auto name = "list";
+    static constexpr auto rule = dsl::square_bracketed.list(dsl::p<number>, dsl::sep(dsl::comma));
+};
+
+struct object
+{
+    static constexpr auto name = "object";
+
+    struct unexpected
+    {
+        static constexpr auto name = "unexpected";
+    };
+
+    static constexpr auto rule = dsl::peek(LEXY_LIT("ab")) >> LEXY_LIT("abcd") | dsl::p<id> //
+                                 | dsl::p<number> | dsl::p<list>
+                                 | dsl::try_(dsl::error<unexpected>);
+};
+
+struct production
+{
+    static constexpr auto name       = "production";
+    static constexpr auto whitespace = dsl::ascii::space;
+
+    static constexpr auto rule = [] {
+        auto greeting = LEXY_LIT("Hello");
+        return greeting + LEXY_DEBUG("greeting \"hello\"") + dsl::p<object>;
+    }();
+};
+} // namespace
+
+TEST_CASE("record_trace")
+{
+    auto recorder = lexy::trace_recorder<lexy::string_input<>>();
+
+    auto check = [&](const char* str, lexy::visualization_options opts) {
+        auto input = lexy::zstring_input(str);
+
+        std::string expected;
+        lexy::trace_to<production>(std::back_insert_iterator(expected), input, opts);
+
+        lexy::record_trace<production>(recorder, input);
+        std::string actual;
+        recorder.render_to(std::back_insert_iterator(actual), opts);
+
+        CHECK(actual == expected);
+    };
+
+    for (auto str : {"Hello abcd", "Hello ax", "Hello 123", "Hello [1,2,3]", "Hello [1,2,", "Hello",
+                     "Hello\n\n  [1,\n2]", "Hi", "Hello ?"})
+    {
+        check(str, {});
+        check(str, {lexy::visualize_fancy});
+        check(str, {lexy::visualize_default, 2});
+    }
+
+    SUBCASE("result and size")
+    {
+        auto input = lexy::zstring_input("Hello abcd");
+        CHECK(lexy::record_trace<production>(recorder, input));
+        CHECK(recorder.size() == 9);
+
+        auto failed = lexy::zstring_input("Hello [1,");
+        CHECK(!lexy::record_trace<production>(recorder, failed));
+
+        recorder.clear();
+        CHECK(recorder.size() == 0);
+    }
+    SUBCASE("many events")
+    {
+        std::string str = "Hello [0";
+        for (auto i = 0; i != 10 * 1000; ++i)
+            str += ",1";
+        str += "]";
+
+        auto input = lexy::string_input(str.data(), str.size());
+        CHECK(lexy::record_trace<production>(recorder, input));
+        CHECK(recorder.size() == 40018);
+
+        std::string expected;
+        lexy::trace_to<production>(std::back_insert_iterator(expected), input);
+        std::string actual;
+        recorder.render_to(std::back_insert_iterator(actual));
+        CHECK(actual == expected);
+    }
+    SUBCASE("memory resource")
+    {
+        struct counting_resource
+        {
+            std::size_t allocations   = 0;
+            std::size_t deallocations = 0;
+
+            void* allocate(std::size_t bytes, std::size_t)
+            {
+                ++allocations;
+                return ::operator new(bytes);
+            }
+            void deallocate(void* ptr, std::size_t, std::size_t) noexcept
+            {
+                ++deallocations;
+                ::operator delete(ptr);
+            }
+        };
+
+        counting_resource resource;
+        {
+            auto input = lexy::zstring_input("Hello [1,2,3]");
+            lexy::trace_recorder<lexy::string_input<>, void, counting_resource> custom(&resource);
+            CHECK(lexy::record_trace<production>(custom, input));
+            CHECK(resource.allocations == 1);
+
+            std::string expected;
+            lexy::trace_to<production>(std::back_insert_iterator(expected), input);
+            std::string actual;
+            custom.render_to(std::back_insert_iterator(actual));
+            CHECK(actual == expected);
+
+            // Rendering allocated the stack of anchors from it as well.
+            CHECK(resource.allocations == 2);
+            CHECK(resource.deallocations == 1);
+        }
+        CHECK(resource.deallocations == resource.allocations);
+    }
+    SUBCASE("chrome json")
+    {
+        auto input = lexy::zstring_input("Hello [1,\"");
+        lexy::record_trace<production>(recorder, input);
+
+        std::string json;
+        recorder.render_chrome_json_to(std::back_insert_iterator(json));
+        CHECK(json == R"({"traceEvents":[
+{"ph":"B","name":"production","pid":0,"tid":0,"ts":0},
+{"ph":"X","name":"literal","pid":0,"tid":0,"ts":0,"dur":5,"cat":"token"},
+{"ph":"X","name":"whitespace","pid":0,"tid":0,"ts":5,"dur":1,"cat":"token"},
+{"ph":"i","name":"greeting \"hello\"","pid":0,"tid":0,"ts":6,"s":"t","cat":"debug"},
+{"ph":"B","name":"object","pid":0,"tid":0,"ts":6},
+{"ph":"B","name":"id","pid":0,"tid":0,"ts":6},
+{"ph":"E","name":"","pid":0,"tid":0,"ts":6,"args":{"canceled":true}},
+{"ph":"B","name":"number","pid":0,"tid":0,"ts":6},
+{"ph":"E","name":"","pid":0,"tid":0,"ts":6,"args":{"canceled":true}},
+{"ph":"B","name":"list","pid":0,"tid":0,"ts":6},
+{"ph":"X","name":"literal","pid":0,"tid":0,"ts":6,"dur":1,"cat":"token"},
+{"ph":"B","name":"number","pid":0,"tid":0,"ts":7},
+{"ph":"X","name":"identifier","pid":0,"tid":0,"ts":7,"dur":1,"cat":"token"},
+{"ph":"E","name":"","pid":0,"tid":0,"ts":8},
+{"ph":"X","name":"literal","pid":0,"tid":0,"ts":8,"dur":1,"cat":"token"},
+{"ph":"B","name":"number","pid":0,"tid":0,"ts":9},
+{"ph":"i","name":"expected ASCII.digit","pid":0,"tid":0,"ts":9,"s":"t","cat":"error"},
+{"ph":"E","name":"","pid":0,"tid":0,"ts":9,"args":{"canceled":true}},
+{"ph":"B","name":"error recovery","pid":0,"tid":0,"ts":9},
+{"ph":"X","name":"error token","pid":0,"tid":0,"ts":9,"dur":1,"cat":"token"},
+{"ph":"E","name":"","pid":0,"tid":0,"ts":10,"args":{"canceled":true}},
+{"ph":"E","name":"","pid":0,"tid":0,"ts":10,"args":{"canceled":true}},
+{"ph":"E","name":"","pid":0,"tid":0,"ts":10,"args":{"canceled":true}},
+{"ph":"E","name":"","pid":0,"tid":0,"ts":10,"args":{"canceled":true}}
+]}
+)");
+    }
+}
@@ -26,6 +26,22 @@ struct my_allocator : std::allocator<T>
     my_allocator(my_allocator<U>)
     {}
 };
+
+// Its move constructor isn't noexcept, so containers copy it when they grow.
+struct throwing_copy
+{
+    static inline bool should_throw = false;
+
+    int value;
+
+    throwing_copy(int value) : value(value) {}
+    throwing_copy(const throwing_copy& other) : value(other.value)
+    {
+        if (should_throw)
+            throw 0;
+    }
+    throwing_copy(throwing_copy&& other) : value(other.value) {}
+};
 } // namespace
 
 TEST_CASE("as_list")
@@ -98,6 +114,105 @@ TEST_CASE("as_list")
         auto result = LEXY_MOV(cb).finish();
         CHECK(result == decltype(result)({"a", "b", "c"}, 42));
     }
+
+    SUBCASE("sink scratch")
+    {
+        constexpr auto sink = lexy::as_list<std::vector<std::string>>.scratch();
+        auto           cb   = sink.sink();
+        cb("a");
+        cb(std::string("b"));
+        cb(1, 'c');
+
+        std::vector<std::string> result = LEXY_MOV(cb).finish();
+        CHECK(result == std::vector<std::string>{"a", "b", "c"});
+        CHECK(result.capacity() == 3);
+    }
+    SUBCASE("sink scratch allocator")
+    {
+        constexpr auto sink
+            = lexy::as_list<std::vector<std::string, my_allocator<std::string>>>.scratch();
+        auto cb = sink.sink(42);
+        cb("a");
+        cb(std::string("b"));
+        cb(1, 'c');
+
+        auto result = LEXY_MOV(cb).finish();
+        CHECK(result == decltype(result)({"a", "b", "c"}, 42));
+        CHECK(result.capacity() == 3);
+    }
+    SUBCASE("sink scratch state allocator")
+    {
+        constexpr auto sink = lexy::as_list<std::vector<std::string, my_allocator<std::string>>> //
+                                  .allocator()
+                                  .scratch();
+
+        auto cb = sink.sink(alloc);
+        cb("a");
+        cb(std::string("b"));
+        cb(1, 'c');
+
+        auto result = LEXY_MOV(cb).finish();
+        CHECK(result == decltype(result)({"a", "b", "c"}, 42));
+        CHECK(result.capacity() == 3);
+    }
+    SUBCASE("sink scratch nested")
+    {
+        constexpr auto sink = lexy::as_list<std::vector<std::string>>.scratch();
+
+        auto outer = sink.sink();
+        outer("a");
+        {
+            // Abandoned without calling finish().
+            auto abandoned = sink.sink();
+            for (auto i = 0; i != 100; ++i)
+                abandoned("x");
+        }
+        outer("b");
+        {
+            auto inner = sink.sink();
+            inner("c");
+            inner("d");
+
+            auto inner_result = LEXY_MOV(inner).finish();
+            CHECK(inner_result == std::vector<std::string>{"c", "d"});
+        }
+        outer("e");
+
+        auto result = LEXY_MOV(outer).finish();
+        CHECK(result == std::vector<std::string>{"a", "b", "e"});
+    }
+    SUBCASE("sink scratch throwing")
+    {
+        constexpr auto sink = lexy::as_list<std::vector<throwing_copy>>.scratch();
+
+        auto cb    = sink.sink();
+        auto count = 0;
+        for (; count != 64; ++count)
+            cb(count);
+
+        // The scratch stack needs to grow, which throws.
+        throwing_copy::should_throw = true;
+        auto thrown                 = false;
+        try
+        {
+            cb(count);
+        }
+        catch (int)
+        {
+            thrown = true;
+        }
+        throwing_copy::should_throw = false;
+        CHECK(thrown);
+
+        // The items are still there and we can continue.
+        for (; count != 100; ++count)
+            cb(count);
+
+        auto result = LEXY_MOV(cb).finish();
+        REQUIRE(result.size() == 100);
+        for (auto i = 0; i != 100; ++i)
+            CHECK(result[std::size_t(i)].value == i);
+    }
 }
 
 TEST_CASE("as_collection")
@@ -169,6 +284,34 @@ TEST_CASE("as_collection")
         auto result = LEXY_MOV(cb).finish();
         CHECK(result == decltype(result)({"a", "b", "c"}, 42));
     }
+
+    SUBCASE("sink scratch")
+    {
+        constexpr auto sink = lexy::as_collection<std::set<std::string>>.scratch();
+        auto           cb   = sink.sink();
+        cb("a");
+        cb(std::string("b"));
+        cb(1, 'c');
+        cb("a");
+
+        std::set<std::string> result = LEXY_MOV(cb).finish();
+        CHECK(result == std::set<std::string>{"a", "b", "c"});
+    }
+    SUBCASE("sink scratch state allocator")
+    {
+        constexpr auto sink
+            = lexy::as_collection<std::set<std::string, std::less<>, my_allocator<std::string>>> //
+                  .allocator()
+                  .scratch();
+
+        auto cb = sink.sink(alloc);
+        cb("a");
+        cb(std::string("b"));
+        cb(1, 'c');
+
+        auto result = LEXY_MOV(cb).finish();
+        CHECK(result == decltype(result)({"a", "b", "c"}, 42));
+    }
 }
 
 TEST_CASE("collect")
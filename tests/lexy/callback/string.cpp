@@ -154,6 +154,18 @@ TEST_CASE("as_string")
         std::string result = LEXY_MOV(sink).finish();
         CHECK(result == "aabcabchia\u00E4");
     }
+    SUBCASE("sink with size hint")
+    {
+        auto sink = lexy::as_string<std::string, lexy::utf8_encoding>.sink();
+        sink.reserve(100);
+        sink(char_lexeme);
+        sink(uchar_lexeme);
+        sink.reserve(1);
+
+        std::string result = LEXY_MOV(sink).finish();
+        CHECK(result == "abcabc");
+        CHECK(result.capacity() >= 100);
+    }
     SUBCASE("sink with allocator")
     {
         auto sink = lexy::as_string<std::string, lexy::utf8_encoding>.sink(std::allocator<int>());
@@ -0,0 +1,73 @@
+// Copyright (C) 2020-2022 Jonathan Müller and lexy contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#include <lexy/_detail/perfect_hash.hpp>
+
+#include <doctest/doctest.h>
+#include <string>
+
+namespace
+{
+constexpr const char* keys[]
+    = {"", "a", "ab", "abc", "abcd", "abcdefg", "abcdefgh", "abcdefghi", "abcdefghijklmnopq",
+       "abcdefghijklmnopr", "b", "ba", "if", "else", "while", "a"};
+constexpr std::size_t key_lengths[] = {0, 1, 2, 3, 4, 7, 8, 9, 17, 17, 1, 2, 2, 4, 5, 1};
+} // namespace
+
+TEST_CASE("_detail::hash_string")
+{
+    constexpr auto compile_time = lexy::_detail::hash_string(0, "abcdefghijkl", 12);
+    auto           str          = std::string("abcdefghijkl");
+    CHECK(lexy::_detail::hash_string(0, str.c_str(), 12) == compile_time);
+
+    CHECK(lexy::_detail::hash_string(0, "abc", 3) != lexy::_detail::hash_string(1, "abc", 3));
+    CHECK(lexy::_detail::hash_string(0, "abc", 3) != lexy::_detail::hash_string(0, "abd", 3));
+    CHECK(lexy::_detail::hash_string(0, "abc", 2) != lexy::_detail::hash_string(0, "abc", 3));
+    CHECK(lexy::_detail::hash_string(0, u"abc", 3) != lexy::_detail::hash_string(0, u"abd", 3));
+}
+
+TEST_CASE("_detail::string_perfect_hash")
+{
+    SUBCASE("char")
+    {
+        constexpr auto hash = lexy::_detail::string_perfect_hash<char, 16>(keys, key_lengths);
+
+        for (auto i = 0u; i != 15; ++i)
+        {
+            // Use a copy to ensure we're comparing the string and not the pointer.
+            auto str = std::string(keys[i], key_lengths[i]);
+            if (i == 1)
+                // Duplicated key, so the last one wins.
+                CHECK(hash.find(str.c_str(), str.size()) == 15);
+            else
+                CHECK(hash.find(str.c_str(), str.size()) == i);
+        }
+
+        CHECK(hash.find("c", 1) == hash.no_key);
+        CHECK(hash.find("abce", 4) == hash.no_key);
+        CHECK(hash.find("abcdefgi", 8) == hash.no_key);
+        CHECK(hash.find("bbcdefghi", 9) == hash.no_key);
+        CHECK(hash.find("abcdefghijklmnops", 17) == hash.no_key);
+        CHECK(hash.find("abcdefghijklmnopqr", 18) == hash.no_key);
+
+        constexpr auto compile_time = hash.find("while", 5);
+        CHECK(compile_time == 14);
+    }
+    SUBCASE("char16_t")
+    {
+        constexpr const char16_t* keys16[]  = {u"a", u"ab", u"abc", u"ä"};
+        constexpr std::size_t     lengths[] = {1, 2, 3, 1};
+
+        constexpr auto hash = lexy::_detail::string_perfect_hash<char16_t, 4>(keys16, lengths);
+
+        CHECK(hash.find(u"a", 1) == 0);
+        CHECK(hash.find(u"ab", 2) == 1);
+        CHECK(hash.find(u"abc", 3) == 2);
+        CHECK(hash.find(u"ä", 1) == 3);
+
+        CHECK(hash.find(u"b", 1) == hash.no_key);
+        CHECK(hash.find(u"abd", 3) == hash.no_key);
+        CHECK(hash.find(u"", 0) == hash.no_key);
+    }
+}
+
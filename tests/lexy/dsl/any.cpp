@@ -23,5 +23,9 @@ TEST_CASE("dsl::any")
     auto invalid_utf8 = LEXY_VERIFY(lexy::utf8_encoding{}, 'a', 'b', 'c', 0x80, '1', '2', '3');
     CHECK(invalid_utf8.status == test_result::success);
     CHECK(invalid_utf8.trace == test_trace().token("any", "abc\\x80123"));
+
+    auto forward = LEXY_VERIFY(forward_input, "abc");
+    CHECK(forward.status == test_result::success);
+    CHECK(forward.trace == test_trace().token("any", "abc"));
 }
 
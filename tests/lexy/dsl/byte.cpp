@@ -15,6 +15,12 @@ TEST_CASE("dsl::byte")
     CHECK(equivalent_rules(rule, dsl::bytes<1>));
 }
 
+namespace
+{
+constexpr unsigned char three_bytes[] = {42, 11, 0x42, 0};
+constexpr unsigned char four_bytes[]  = {42, 11, 0x42, 0x11, 0};
+} // namespace
+
 TEST_CASE("dsl::bytes")
 {
     constexpr auto rule = dsl::bytes<4>;
@@ -44,6 +50,14 @@ TEST_CASE("dsl::bytes")
     auto five = LEXY_VERIFY(lexy::byte_encoding{}, 42, 11, 0x42, 0x11, 0);
     CHECK(five.status == test_result::success);
     CHECK(five.trace == test_trace().token("any", "\\2A\\0B\\42\\11"));
+
+    auto forward_three = LEXY_VERIFY(forward_input, lexy::byte_encoding{}, three_bytes);
+    CHECK(forward_three.status == test_result::fatal_error);
+    CHECK(forward_three.trace
+          == test_trace().error_token("\\2A\\0B\\42").expected_char_class(3, "byte").cancel());
+    auto forward_four = LEXY_VERIFY(forward_input, lexy::byte_encoding{}, four_bytes);
+    CHECK(forward_four.status == test_result::success);
+    CHECK(forward_four.trace == test_trace().token("any", "\\2A\\0B\\42\\11"));
 }
 
 TEST_CASE("dsl::padding_bytes")
@@ -110,6 +110,25 @@ enum class token_kind
 }
 } // namespace
 
+TEST_CASE("lexy::_detail::ascii_set_matcher::find_first_not_of")
+{
+    using matcher = lexy::_detail::ascii_set_matcher<dsl::_cas<decltype(dsl::ascii::alnum)>>;
+
+    char input[100];
+    for (auto size = 0u; size != sizeof(input); ++size)
+        for (auto mismatch = 0u; mismatch <= size; ++mismatch)
+        {
+            for (auto i = 0u; i != size; ++i)
+                input[i] = "abzAZ09"[i % 7];
+            if (mismatch < size)
+                input[mismatch] = mismatch % 2 == 0 ? '_' : '\xC4';
+
+            auto result
+                = matcher::find_first_not_of<lexy::default_encoding>(input, input + size);
+            CHECK(result == input + mismatch);
+        }
+}
+
 TEST_CASE("character class .kind and .error")
 {
     struct my_error
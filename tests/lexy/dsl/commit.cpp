@@ -0,0 +1,25 @@
+// Copyright (C) 2020-2022 Jonathan Müller and lexy contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#include <lexy/dsl/commit.hpp>
+
+#include "verify.hpp"
+
+TEST_CASE("dsl::commit")
+{
+    constexpr auto commit = dsl::commit;
+    CHECK(lexy::is_rule<decltype(commit)>);
+
+    constexpr auto callback = token_callback;
+
+    // Inputs that can't release anything ignore it.
+    constexpr auto rule = LEXY_LIT("a") + commit + LEXY_LIT("b");
+
+    auto empty = LEXY_VERIFY("");
+    CHECK(empty.status == test_result::fatal_error);
+    CHECK(empty.trace == test_trace().expected_literal(0, "a", 0).cancel());
+
+    auto ab = LEXY_VERIFY("ab");
+    CHECK(ab.status == test_result::success);
+    CHECK(ab.trace == test_trace().literal("a").literal("b"));
+}
@@ -542,6 +542,118 @@ TEST_CASE("dsl::delimited(delim)")
     CHECK(equivalent_rules(dsl::triple_backticked, dsl::delimited(LEXY_LIT("```"))));
 }
 
+TEST_CASE("dsl::delimited() long content")
+{
+    // The content is long enough that the characters are skipped in bulk.
+    constexpr auto rule = dsl::quoted.limit(dsl::ascii::newline)(dsl::ascii::character,
+                                                                 dsl::dollar_escape.rule(
+                                                                     dsl::lit_c<'n'>));
+    CHECK(lexy::is_branch_rule<decltype(rule)>);
+
+    constexpr delim_callback callback
+        = lexy::callback<int>([](const char*, std::size_t count) { return int(count); });
+
+    auto plain = LEXY_VERIFY("\"0123456789abcdefghijklmnopqrstuvwxyz\"");
+    CHECK(plain.status == test_result::success);
+    CHECK(plain.value == 36);
+    CHECK(plain.trace
+          == test_trace()
+                 .literal("\"")
+                 .token("0123456789abcdefghijklmnopqrstuvwxyz")
+                 .literal("\""));
+
+    auto escaped = LEXY_VERIFY("\"0123456789abcdef$nghijklmnopqrstuvwxyz\"");
+    CHECK(escaped.status == test_result::success);
+    CHECK(escaped.value == 36);
+    CHECK(escaped.trace
+          == test_trace()
+                 .literal("\"")
+                 .token("0123456789abcdef")
+                 .literal("$")
+                 .literal("n")
+                 .token("ghijklmnopqrstuvwxyz")
+                 .literal("\""));
+
+    auto invalid = LEXY_VERIFY("\"0123456789abcdefghij\x80klmnopqrstuvwxyz\"");
+    CHECK(invalid.status == test_result::recovered_error);
+    CHECK(invalid.value == 36);
+    CHECK(invalid.trace
+          == test_trace()
+                 .literal("\"")
+                 .token("0123456789abcdefghij")
+                 .expected_char_class(21, "ASCII")
+                 .recovery()
+                 .error_token("\\x80")
+                 .finish()
+                 .token("klmnopqrstuvwxyz")
+                 .literal("\""));
+
+    auto unterminated = LEXY_VERIFY("\"0123456789abcdefghijklmnopqrstuvwxyz\n\"");
+    CHECK(unterminated.status == test_result::fatal_error);
+    CHECK(unterminated.trace
+          == test_trace()
+                 .literal("\"")
+                 .token("0123456789abcdefghijklmnopqrstuvwxyz")
+                 .error(1, 37, "missing delimiter")
+                 .cancel());
+}
+
+namespace
+{
+// Returns the size hint instead of the content.
+struct hint_sink
+{
+    std::size_t result;
+
+    using return_type = std::size_t;
+
+    template <typename... Args>
+    void operator()(const Args&...)
+    {}
+
+    void reserve(std::size_t size)
+    {
+        result = size;
+    }
+
+    std::size_t finish() &&
+    {
+        return result;
+    }
+};
+
+template <typename Callback>
+struct hint_callback : Callback
+{
+    constexpr hint_callback(Callback cb) : Callback(cb) {}
+
+    auto sink() const
+    {
+        return hint_sink{0};
+    }
+};
+} // namespace
+
+TEST_CASE("dsl::delimited() size hint")
+{
+    constexpr auto rule = dsl::quoted.limit(dsl::ascii::newline)(dsl::ascii::character,
+                                                                 dsl::dollar_escape.rule(
+                                                                     dsl::lit_c<'n'>));
+
+    constexpr hint_callback callback
+        = lexy::callback<int>([](const char*, std::size_t hint) { return int(hint); });
+
+    // No escape sequence, so a single lexeme and no need for a hint.
+    auto plain = LEXY_VERIFY("\"0123456789abcdefghijklmnopqrstuvwxyz\"");
+    CHECK(plain.status == test_result::success);
+    CHECK(plain.value == 0);
+
+    // The content can't end before the next quotation mark.
+    auto escaped = LEXY_VERIFY("\"0123456789abcdef$nghijklmnopqrstuvwxyz\"");
+    CHECK(escaped.status == test_result::success);
+    CHECK(escaped.value == 38);
+}
+
 namespace
 {
 constexpr auto symbols = lexy::symbol_table<int>;
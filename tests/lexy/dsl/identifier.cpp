@@ -15,6 +15,13 @@ struct with_whitespace
 {
     static constexpr auto whitespace = LEXY_LIT(".");
 };
+
+// The literals "Aa", "Ab", ..., "Jj".
+template <std::size_t... Idx>
+constexpr auto many_literals(lexy::_detail::index_sequence<Idx...>)
+{
+    return dsl::literal_set(lexyd::_lit<char, char('A' + Idx / 10), char('a' + Idx % 10)>{}...);
+}
 } // namespace
 
 TEST_CASE("dsl::identifier(leading, trailing).pattern()")
@@ -90,6 +97,13 @@ TEST_CASE("dsl::identifier(leading, trailing)")
         CHECK(Abc123.status == test_result::success);
         CHECK(Abc123.value == 1);
         CHECK(Abc123.trace == test_trace().token("identifier", "Abc"));
+
+        auto long_ = LEXY_VERIFY("Abcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyz123");
+        CHECK(long_.status == test_result::success);
+        CHECK(long_.value == 1);
+        CHECK(long_.trace
+              == test_trace().token("identifier",
+                                    "Abcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyz"));
     }
     SUBCASE("with whitespace")
     {
@@ -127,6 +141,10 @@ TEST_CASE("dsl::identifier(leading, trailing)")
     {
         constexpr auto rule
             = id.reserve(LEXY_LIT("Ab"), LEXY_KEYWORD("Abc", id)).reserve(LEXY_LIT("Int"));
+        // Both calls are merged into a single set.
+        CHECK(std::is_same_v<LEXY_DECAY_DECLTYPE(rule),
+                             decltype(id.reserve(LEXY_LIT("Ab"), LEXY_KEYWORD("Abc", id),
+                                                 LEXY_LIT("Int")))>);
 
         auto empty = LEXY_VERIFY("");
         CHECK(empty.status == test_result::fatal_error);
@@ -161,6 +179,40 @@ TEST_CASE("dsl::identifier(leading, trailing)")
         CHECK(Int.trace
               == test_trace().token("identifier", "Int").error(0, 3, "reserved identifier"));
     }
+    SUBCASE(".reserve() many")
+    {
+        constexpr auto rule
+            = id.reserve(many_literals(lexy::_detail::make_index_sequence<100>{}));
+
+        auto A = LEXY_VERIFY("A");
+        CHECK(A.status == test_result::success);
+        CHECK(A.value == 1);
+        CHECK(A.trace == test_trace().token("identifier", "A"));
+        auto Ak = LEXY_VERIFY("Ak");
+        CHECK(Ak.status == test_result::success);
+        CHECK(Ak.value == 1);
+        CHECK(Ak.trace == test_trace().token("identifier", "Ak"));
+        auto Aab = LEXY_VERIFY("Aab");
+        CHECK(Aab.status == test_result::success);
+        CHECK(Aab.value == 1);
+        CHECK(Aab.trace == test_trace().token("identifier", "Aab"));
+
+        auto Aa = LEXY_VERIFY("Aa");
+        CHECK(Aa.status == test_result::recovered_error);
+        CHECK(Aa.value == 1);
+        CHECK(Aa.trace
+              == test_trace().token("identifier", "Aa").error(0, 2, "reserved identifier"));
+        auto Ej = LEXY_VERIFY("Ej");
+        CHECK(Ej.status == test_result::recovered_error);
+        CHECK(Ej.value == 1);
+        CHECK(Ej.trace
+              == test_trace().token("identifier", "Ej").error(0, 2, "reserved identifier"));
+        auto Jj = LEXY_VERIFY("Jj");
+        CHECK(Jj.status == test_result::recovered_error);
+        CHECK(Jj.value == 1);
+        CHECK(Jj.trace
+              == test_trace().token("identifier", "Jj").error(0, 2, "reserved identifier"));
+    }
     SUBCASE(".reserve_prefix()")
     {
         constexpr auto rule = id.reserve_prefix(LEXY_LIT("Ab"));
@@ -227,6 +279,47 @@ TEST_CASE("dsl::identifier(leading, trailing)")
         CHECK(Abcd.trace
               == test_trace().token("identifier", "Abcd").error(0, 4, "reserved identifier"));
     }
+    SUBCASE(".reserve_containing() merged")
+    {
+        constexpr auto rule
+            = id.reserve_containing(LEXY_LIT("b")).reserve_containing(LEXY_LIT("e"));
+        CHECK(std::is_same_v<LEXY_DECAY_DECLTYPE(rule),
+                             decltype(id.reserve_containing(LEXY_LIT("b"), LEXY_LIT("e")))>);
+
+        auto empty = LEXY_VERIFY("");
+        CHECK(empty.status == test_result::fatal_error);
+        CHECK(empty.trace == test_trace().expected_char_class(0, "ASCII.upper").cancel());
+
+        auto A = LEXY_VERIFY("A");
+        CHECK(A.status == test_result::success);
+        CHECK(A.value == 1);
+        CHECK(A.trace == test_trace().token("identifier", "A"));
+        auto Acd = LEXY_VERIFY("Acd");
+        CHECK(Acd.status == test_result::success);
+        CHECK(Acd.value == 1);
+        CHECK(Acd.trace == test_trace().token("identifier", "Acd"));
+
+        auto Ab = LEXY_VERIFY("Ab");
+        CHECK(Ab.status == test_result::recovered_error);
+        CHECK(Ab.value == 1);
+        CHECK(Ab.trace
+              == test_trace().token("identifier", "Ab").error(0, 2, "reserved identifier"));
+        auto Abc = LEXY_VERIFY("Abc");
+        CHECK(Abc.status == test_result::recovered_error);
+        CHECK(Abc.value == 1);
+        CHECK(Abc.trace
+              == test_trace().token("identifier", "Abc").error(0, 3, "reserved identifier"));
+        auto Abcd = LEXY_VERIFY("Abcd");
+        CHECK(Abcd.status == test_result::recovered_error);
+        CHECK(Abcd.value == 1);
+        CHECK(Abcd.trace
+              == test_trace().token("identifier", "Abcd").error(0, 4, "reserved identifier"));
+        auto Acde = LEXY_VERIFY("Acde");
+        CHECK(Acde.status == test_result::recovered_error);
+        CHECK(Acde.value == 1);
+        CHECK(Acde.trace
+              == test_trace().token("identifier", "Acde").error(0, 4, "reserved identifier"));
+    }
     SUBCASE(".reserve_suffix()")
     {
         constexpr auto rule = id.reserve_suffix(LEXY_LIT("c"));
@@ -103,6 +103,14 @@ TEST_CASE("dsl::lit")
         auto utf16 = LEXY_VERIFY(u"abc");
         CHECK(utf16.status == test_result::success);
         CHECK(utf16.trace == test_trace().literal("abc"));
+
+        auto forward = LEXY_VERIFY(forward_input, "abc");
+        CHECK(forward.status == test_result::success);
+        CHECK(forward.trace == test_trace().literal("abc"));
+        auto forward_ab = LEXY_VERIFY(forward_input, "ab");
+        CHECK(forward_ab.status == test_result::fatal_error);
+        CHECK(forward_ab.trace
+              == test_trace().error_token("ab").expected_literal(0, "abc", 2).cancel());
     }
     SUBCASE("UTF-16, but only in ASCII")
     {
@@ -184,6 +192,10 @@ TEST_CASE("dsl::lit_cp")
         auto ascii = LEXY_VERIFY(lexy::ascii_encoding{}, "a");
         CHECK(ascii.status == test_result::success);
         CHECK(ascii.trace == test_trace().literal("a"));
+
+        auto forward = LEXY_VERIFY(forward_input, u"a");
+        CHECK(forward.status == test_result::success);
+        CHECK(forward.trace == test_trace().literal("a"));
     }
     SUBCASE("BMP")
     {
@@ -438,6 +450,64 @@ TEST_CASE("dsl::literal_set")
         CHECK(u_utf16.trace == test_trace().literal("\\u00FC"));
     }
 
+    SUBCASE("many transitions")
+    {
+        constexpr auto rule
+            = dsl::literal_set(LEXY_LIT("a"), LEXY_LIT("b"), LEXY_LIT("c"), LEXY_LIT("d"),
+                               LEXY_LIT("e"), LEXY_LIT("f"), LEXY_LIT("g"), LEXY_LIT("xa"),
+                               LEXY_LIT("xb"), LEXY_LIT("xc"), LEXY_LIT("xd"), LEXY_LIT("xe"),
+                               LEXY_LIT("xf"), LEXY_LIT("xg"), LEXY_LIT("xh"), LEXY_LIT("xhij"));
+        CHECK(lexy::is_token_rule<decltype(rule)>);
+        CHECK(lexy::is_literal_set_rule<decltype(rule)>);
+
+        auto empty = LEXY_VERIFY("");
+        CHECK(empty.status == test_result::fatal_error);
+        CHECK(empty.trace == test_trace().error(0, 0, "expected literal set").cancel());
+
+        auto a = LEXY_VERIFY("a");
+        CHECK(a.status == test_result::success);
+        CHECK(a.trace == test_trace().literal("a"));
+        auto g = LEXY_VERIFY("g");
+        CHECK(g.status == test_result::success);
+        CHECK(g.trace == test_trace().literal("g"));
+        auto h = LEXY_VERIFY("h");
+        CHECK(h.status == test_result::fatal_error);
+        CHECK(h.trace == test_trace().error(0, 0, "expected literal set").cancel());
+
+        auto x = LEXY_VERIFY("x");
+        CHECK(x.status == test_result::fatal_error);
+        CHECK(x.trace == test_trace().error(0, 0, "expected literal set").cancel());
+        auto xa = LEXY_VERIFY("xa");
+        CHECK(xa.status == test_result::success);
+        CHECK(xa.trace == test_trace().literal("xa"));
+        auto xd = LEXY_VERIFY("xd");
+        CHECK(xd.status == test_result::success);
+        CHECK(xd.trace == test_trace().literal("xd"));
+        auto xi = LEXY_VERIFY("xi");
+        CHECK(xi.status == test_result::fatal_error);
+        CHECK(xi.trace == test_trace().error(0, 0, "expected literal set").cancel());
+
+        auto xh = LEXY_VERIFY("xh");
+        CHECK(xh.status == test_result::success);
+        CHECK(xh.trace == test_trace().literal("xh"));
+        auto xhi = LEXY_VERIFY("xhi");
+        CHECK(xhi.status == test_result::success);
+        CHECK(xhi.trace == test_trace().literal("xh"));
+        auto xhij = LEXY_VERIFY("xhij");
+        CHECK(xhij.status == test_result::success);
+        CHECK(xhij.trace == test_trace().literal("xhij"));
+
+        auto xa_utf16 = LEXY_VERIFY(u"xa");
+        CHECK(xa_utf16.status == test_result::success);
+        CHECK(xa_utf16.trace == test_trace().literal("xa"));
+        auto xhij_utf16 = LEXY_VERIFY(u"xhij");
+        CHECK(xhij_utf16.status == test_result::success);
+        CHECK(xhij_utf16.trace == test_trace().literal("xhij"));
+        auto xi_utf16 = LEXY_VERIFY(u"xi");
+        CHECK(xi_utf16.status == test_result::fatal_error);
+        CHECK(xi_utf16.trace == test_trace().error(0, 0, "expected literal set").cancel());
+    }
+
     SUBCASE("keyword")
     {
         constexpr auto id1 = dsl::identifier(dsl::ascii::alpha);
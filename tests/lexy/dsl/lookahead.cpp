@@ -138,6 +138,17 @@ TEST_CASE("dsl::lookahead()")
         auto something1_limit = LEXY_VERIFY("abc.def!ghi");
         CHECK(something1_limit.status == test_result::success);
         CHECK(something1_limit.trace == test_trace().backtracked("abc."));
+
+        auto long_something = LEXY_VERIFY("0123456789-0123456789-0123456789-0123456789,!");
+        CHECK(long_something.status == test_result::success);
+        CHECK(long_something.trace
+              == test_trace().backtracked("0123456789-0123456789-0123456789-0123456789,"));
+        auto long_limit = LEXY_VERIFY("0123456789-0123456789-0123456789-0123456789?.");
+        CHECK(long_limit.status == test_result::recovered_error);
+        CHECK(long_limit.trace
+              == test_trace()
+                     .error(0, 44, "lookahead failure")
+                     .backtracked("0123456789-0123456789-0123456789-0123456789?"));
         auto something2_limit = LEXY_VERIFY("abc,def!ghi");
         CHECK(something2_limit.status == test_result::success);
         CHECK(something2_limit.trace == test_trace().backtracked("abc,"));
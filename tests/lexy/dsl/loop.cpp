@@ -4,7 +4,9 @@
 #include <lexy/dsl/loop.hpp>
 
 #include "verify.hpp"
+#include <lexy/dsl/ascii.hpp>
 #include <lexy/dsl/choice.hpp>
+#include <lexy/dsl/unicode.hpp>
 #include <lexy/dsl/recover.hpp>
 
 TEST_CASE("dsl::loop()")
@@ -82,6 +84,114 @@ TEST_CASE("dsl::while_()")
           == test_trace().literal("a").expected_literal(1, "bc", 0).literal("a").literal("bc"));
 }
 
+TEST_CASE("dsl::while_(char_class)")
+{
+    constexpr auto callback = token_callback;
+
+    SUBCASE("ASCII")
+    {
+        constexpr auto rule = dsl::while_(dsl::ascii::lower);
+
+        auto empty = LEXY_VERIFY("");
+        CHECK(empty.status == test_result::success);
+        CHECK(empty.trace == test_trace());
+
+        auto abc = LEXY_VERIFY("abc!");
+        CHECK(abc.status == test_result::success);
+        CHECK(abc.trace == test_trace().token("a").token("b").token("c"));
+
+        auto long_ = LEXY_VERIFY("abcdefghijklmnopqrstuvwxyzabcdefghijklmnopq!");
+        CHECK(long_.status == test_result::success);
+        CHECK(long_.trace
+              == test_trace()
+                     .token("a")
+                     .token("b")
+                     .token("c")
+                     .token("d")
+                     .token("e")
+                     .token("f")
+                     .token("g")
+                     .token("h")
+                     .token("i")
+                     .token("j")
+                     .token("k")
+                     .token("l")
+                     .token("m")
+                     .token("n")
+                     .token("o")
+                     .token("p")
+                     .token("q")
+                     .token("r")
+                     .token("s")
+                     .token("t")
+                     .token("u")
+                     .token("v")
+                     .token("w")
+                     .token("x")
+                     .token("y")
+                     .token("z")
+                     .token("a")
+                     .token("b")
+                     .token("c")
+                     .token("d")
+                     .token("e")
+                     .token("f")
+                     .token("g")
+                     .token("h")
+                     .token("i")
+                     .token("j")
+                     .token("k")
+                     .token("l")
+                     .token("m")
+                     .token("n")
+                     .token("o")
+                     .token("p")
+                     .token("q"));
+    }
+    SUBCASE("Unicode")
+    {
+        constexpr auto rule = dsl::while_(dsl::unicode::lower);
+
+        auto empty = LEXY_VERIFY(lexy::utf8_encoding{}, LEXY_CHAR8_STR(""));
+        CHECK(empty.status == test_result::success);
+        CHECK(empty.trace == test_trace());
+
+        auto abc = LEXY_VERIFY(lexy::utf8_encoding{},
+                               LEXY_CHAR8_STR("abcdefghijklmnopqrstuvwxyzäb!"));
+        CHECK(abc.status == test_result::success);
+        CHECK(abc.trace
+              == test_trace()
+                     .token("a")
+                     .token("b")
+                     .token("c")
+                     .token("d")
+                     .token("e")
+                     .token("f")
+                     .token("g")
+                     .token("h")
+                     .token("i")
+                     .token("j")
+                     .token("k")
+                     .token("l")
+                     .token("m")
+                     .token("n")
+                     .token("o")
+                     .token("p")
+                     .token("q")
+                     .token("r")
+                     .token("s")
+                     .token("t")
+                     .token("u")
+                     .token("v")
+                     .token("w")
+                     .token("x")
+                     .token("y")
+                     .token("z")
+                     .token("\\u00E4")
+                     .token("b"));
+    }
+}
+
 TEST_CASE("dsl::while_one()")
 {
     constexpr auto rule = dsl::while_one(LEXY_LIT("a") >> LEXY_LIT("bc"));
@@ -4,11 +4,19 @@
 #include <lexy/dsl/production.hpp>
 
 #include "verify.hpp"
+#include <climits>
+#include <lexy/action/validate.hpp>
 #include <lexy/dsl/capture.hpp>
+#include <lexy/dsl/choice.hpp>
+#include <lexy/dsl/context_counter.hpp>
 #include <lexy/dsl/if.hpp>
+#include <lexy/dsl/peek.hpp>
 #include <lexy/dsl/position.hpp>
 #include <lexy/dsl/recover.hpp>
+#include <lexy/dsl/sequence.hpp>
 #include <lexy/dsl/whitespace.hpp>
+#include <string>
+#include <thread>
 
 namespace
 {
@@ -235,6 +243,182 @@ TEST_CASE("dsl::p")
     }
 }
 
+namespace
+{
+int memo_count = 0;
+
+struct count_rule : dsl::rule_base
+{
+    template <typename NextParser>
+    struct p
+    {
+        template <typename Context, typename Reader, typename... Args>
+        static constexpr bool parse(Context& context, Reader& reader, Args&&... args)
+        {
+            ++memo_count;
+            return NextParser::parse(context, reader, LEXY_FWD(args)...);
+        }
+    };
+};
+
+struct not_memoized
+{};
+
+// level<N> matches `x` followed by N letters `a` or `b`.
+// It looks ahead to decide between them, so each level matches the level below twice.
+template <bool Memoize, int N, bool Recover>
+struct level : std::conditional_t<Memoize, lexy::memoized_production, not_memoized>
+{
+    static constexpr auto rule = [] {
+        if constexpr (N == 0)
+        {
+            if constexpr (Recover)
+                return count_rule{} + dsl::try_(dsl::lit_c<'x'>);
+            else
+                return count_rule{} + dsl::lit_c<'x'>;
+        }
+        else
+        {
+            auto lower = dsl::p<level<Memoize, N - 1, Recover>>;
+            return dsl::peek(lower + dsl::lit_c<'a'>) >> lower + dsl::lit_c<'a'>
+                   | dsl::else_ >> lower + dsl::lit_c<'b'>;
+        }
+    }();
+};
+
+// Looks ahead twice over the same production at the same position.
+template <bool Memoize>
+struct two_peeks
+{
+    static constexpr auto rule = [] {
+        auto lower = dsl::p<level<Memoize, 3, false>>;
+        return dsl::peek(lower + dsl::lit_c<'!'>) >> lower + dsl::lit_c<'!'>
+               | dsl::peek(lower + dsl::lit_c<'?'>) >> lower + dsl::lit_c<'?'>;
+    }();
+};
+
+// Matches `x` if the counter is zero, `y` otherwise.
+constexpr auto memo_counter = dsl::context_counter<struct memo_counter_id>;
+struct counter_dependent : lexy::memoized_production
+{
+    static constexpr auto rule = count_rule{}
+                                 + (memo_counter.is_zero() >> dsl::lit_c<'x'>
+                                    | dsl::else_ >> dsl::lit_c<'y'>);
+};
+
+// Looks ahead twice over the production with different values of the counter.
+struct counter_peeks
+{
+    static constexpr auto rule = [] {
+        auto lower = dsl::p<counter_dependent>;
+        return dsl::peek(memo_counter.create() + memo_counter.inc() + lower) >> dsl::lit_c<'y'>
+               | dsl::peek(memo_counter.create() + lower) >> dsl::lit_c<'x'>;
+    }();
+};
+
+template <template <typename> typename Action, bool Memoize, int N, bool Recover = false>
+auto count_memo(const char* str)
+{
+    memo_count  = 0;
+    auto input  = lexy::zstring_input(str);
+    auto result = Action<level<Memoize, N, Recover>>{}(input);
+    return std::make_pair(result, memo_count);
+}
+
+template <typename Production>
+struct do_match
+{
+    template <typename Input>
+    bool operator()(const Input& input)
+    {
+        return lexy::match<Production>(input);
+    }
+};
+
+template <typename Production>
+struct do_validate
+{
+    template <typename Input>
+    bool operator()(const Input& input)
+    {
+        return lexy::validate<Production>(input, lexy::noop).is_success();
+    }
+};
+} // namespace
+
+TEST_CASE("dsl::p memoized")
+{
+    SUBCASE("lookahead")
+    {
+        auto plain = count_memo<do_match, false, 12>("xabababababab");
+        CHECK(plain.first);
+        CHECK(plain.second == 4096);
+
+        auto memoized = count_memo<do_match, true, 12>("xabababababab");
+        CHECK(memoized.first);
+        CHECK(memoized.second == 1);
+
+        CHECK(!count_memo<do_match, true, 12>("xabababababac").first);
+        CHECK(!count_memo<do_match, true, 12>("yabababababab").first);
+    }
+    SUBCASE("full parse")
+    {
+        auto plain = count_memo<do_validate, false, 12>("xabababababab");
+        CHECK(plain.first);
+        CHECK(plain.second == 4096);
+
+        auto memoized = count_memo<do_validate, true, 12>("xabababababab");
+        CHECK(memoized.first);
+        CHECK(memoized.second == 2);
+
+        CHECK(!count_memo<do_validate, true, 12>("xabababababac").first);
+    }
+    SUBCASE("recovered errors")
+    {
+        auto plain = count_memo<do_match, false, 3, true>("ybab");
+        CHECK(!plain.first);
+        CHECK(plain.second == 8);
+
+        auto memoized = count_memo<do_match, true, 3, true>("ybab");
+        CHECK(!memoized.first);
+        CHECK(memoized.second == 1);
+
+        CHECK(count_memo<do_match, true, 3, true>("xbab").first);
+    }
+    SUBCASE("shared by all lookahead of the action")
+    {
+        // The action only prepares the cache if it finds a memoized production in the grammar.
+        CHECK(!lexy::_has_memoized_production<two_peeks<false>>);
+        CHECK(lexy::_has_memoized_production<two_peeks<true>>);
+        CHECK(lexy::_has_memoized_production<counter_peeks>);
+
+        memo_count = 0;
+        CHECK(lexy::match<two_peeks<false>>(lexy::zstring_input("xbab?")));
+        CHECK(memo_count == 24);
+
+        auto input = lexy::zstring_input("xbab?");
+        memo_count = 0;
+        CHECK(lexy::match<two_peeks<true>>(input));
+        CHECK(memo_count == 1);
+
+        // A new action doesn't see the results of the previous one.
+        memo_count = 0;
+        CHECK(lexy::match<two_peeks<true>>(input));
+        CHECK(memo_count == 1);
+    }
+    SUBCASE("context variables")
+    {
+        // The production isn't cached while a context variable exists.
+        memo_count = 0;
+        CHECK(lexy::match<counter_peeks>(lexy::zstring_input("x")));
+        CHECK(memo_count == 2);
+
+        memo_count = 0;
+        CHECK(lexy::match<counter_peeks>(lexy::zstring_input("y")));
+        CHECK(memo_count == 1);
+    }
+}
+
 namespace
 {
 template <std::size_t N>
@@ -539,3 +723,61 @@ TEST_CASE("dsl::recurse_branch")
     // No need to test other cases, code is shared with `dsl::p`.
 }
 
+#if LEXY_HAS_STACK_SEGMENTS
+namespace
+{
+struct nested : lexy::segmented_stack_production
+{
+    // Small segments, so we switch a lot.
+    static constexpr std::size_t stack_segment_size = 64 * 1024;
+
+    static constexpr auto rule = dsl::if_(LEXY_LIT("[") >> dsl::recurse<nested> + LEXY_LIT("]"));
+};
+
+struct nested_branch : lexy::segmented_stack_production
+{
+    static constexpr std::size_t stack_segment_size = 64 * 1024;
+
+    static constexpr auto rule
+        = LEXY_LIT("[") >> dsl::if_(dsl::recurse_branch<nested_branch>) + LEXY_LIT("]");
+};
+
+template <typename Production>
+bool validate_nested(std::size_t depth, bool balanced = true)
+{
+    auto str = std::string(depth, '[') + std::string(balanced ? depth : depth - 1, ']');
+    return lexy::validate<Production>(lexy::string_input(str.data(), str.size()), lexy::noop)
+        .is_success();
+}
+} // namespace
+
+TEST_CASE("dsl::recurse segmented stack")
+{
+    // Deep enough to overflow the native stack.
+    constexpr auto depth = std::size_t(100) * 1000;
+
+    CHECK(lexy::max_recursion_depth<nested>() == INT_MAX);
+    CHECK(lexy::stack_segment_size<nested>() == 64 * 1024);
+    CHECK(lexy::stack_segment_size<test_production_for<decltype(LEXY_LIT("a"))>>() == 0);
+
+    CHECK(validate_nested<nested>(depth));
+    CHECK(!validate_nested<nested>(depth, false));
+    // The segments of the previous parses are reused.
+    CHECK(validate_nested<nested>(depth));
+
+    CHECK(validate_nested<nested_branch>(depth));
+    CHECK(!validate_nested<nested_branch>(depth, false));
+
+    // Use a new thread, so we start without any segments.
+    std::thread([&] {
+        auto& segments = lexy::_detail::stack_segments::get();
+
+        // A shallow recursion stays on the native stack.
+        CHECK(validate_nested<nested>(10));
+        CHECK(segments.segment_count() == 0);
+
+        CHECK(validate_nested<nested>(depth));
+        CHECK(segments.segment_count() > 0);
+    }).join();
+}
+#endif
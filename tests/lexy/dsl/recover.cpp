@@ -43,6 +43,14 @@ TEST_CASE("dsl::find()")
     auto unterminated = LEXY_VERIFY("abc");
     CHECK(unterminated.status == test_result::fatal_error);
     CHECK(unterminated.trace == test_trace().recovery().error_token("abc").cancel().cancel());
+
+    auto long_garbage = LEXY_VERIFY("0123456789-0123456789-0123456789-0123456789;");
+    CHECK(long_garbage.status == test_result::success);
+    CHECK(long_garbage.trace
+          == test_trace()
+                 .recovery()
+                 .error_token("0123456789-0123456789-0123456789-0123456789")
+                 .finish());
 }
 
 TEST_CASE("dsl::find().limit()")
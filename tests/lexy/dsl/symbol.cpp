@@ -9,6 +9,23 @@
 #include <lexy/dsl/if.hpp>
 #include <lexy/dsl/whitespace.hpp>
 
+namespace
+{
+// A table with a hundred symbols "Aa", "Ab", ..., "Jj" mapped to 1 to 100.
+template <std::size_t I>
+using big_symbol = lexy::_detail::type_string<char, char('A' + I / 10), char('a' + I % 10)>;
+template <std::size_t I, typename Table>
+LEXY_CONSTEVAL auto map_big_symbols(Table table)
+{
+    if constexpr (I == 100)
+        return table;
+    else
+        return map_big_symbols<I + 1>(table.template map<big_symbol<I>>(int(I + 1)));
+}
+
+constexpr auto big_symbols = map_big_symbols<0>(lexy::symbol_table<int>);
+} // namespace
+
 TEST_CASE("symbol_table")
 {
     // Note: try_parse() and key_index tested implicitly by the actual parsing code.
@@ -57,6 +74,74 @@ TEST_CASE("symbol_table")
         ++iter;
         CHECK(iter == table.end());
     }
+    SUBCASE("parse")
+    {
+        constexpr auto table = lexy::symbol_table<int> //
+                                   .map<LEXY_SYMBOL("abstract")>(0)
+                                   .map<LEXY_SYMBOL("and")>(1)
+                                   .map<LEXY_SYMBOL("as")>(2)
+                                   .map<LEXY_SYMBOL("break")>(3)
+                                   .map<LEXY_SYMBOL("case")>(4)
+                                   .map<LEXY_SYMBOL("catch")>(5)
+                                   .map<LEXY_SYMBOL("class")>(6)
+                                   .map<LEXY_SYMBOL("const")>(7)
+                                   .map<LEXY_SYMBOL("continue")>(8)
+                                   .map<LEXY_SYMBOL("do")>(9)
+                                   .map<LEXY_SYMBOL("else")>(10)
+                                   .map<LEXY_SYMBOL("enum")>(11)
+                                   .map<LEXY_SYMBOL("for")>(12)
+                                   .map<LEXY_SYMBOL("if")>(13)
+                                   .map<LEXY_SYMBOL("in")>(14)
+                                   .map<LEXY_SYMBOL("return")>(15)
+                                   .map<LEXY_SYMBOL("while")>(16)
+                                   .map<LEXY_SYMBOL("as")>(17);
+
+        auto parse = [&](const char* str) {
+            auto contiguous = table.parse(lexy::zstring_input(str));
+            auto forward    = table.parse(lexy_test::_get_input(lexy_test::forward_input, str));
+            CHECK(contiguous == forward);
+            return contiguous ? table[contiguous] : -1;
+        };
+
+        CHECK(parse("abstract") == 0);
+        CHECK(parse("and") == 1);
+        CHECK(parse("break") == 3);
+        CHECK(parse("const") == 7);
+        CHECK(parse("if") == 13);
+        CHECK(parse("in") == 14);
+        CHECK(parse("while") == 16);
+        // The last mapping wins.
+        CHECK(parse("as") == 17);
+
+        CHECK(parse("") == -1);
+        CHECK(parse("a") == -1);
+        CHECK(parse("abstrac") == -1);
+        CHECK(parse("abstracts") == -1);
+        CHECK(parse("i") == -1);
+        CHECK(parse("iF") == -1);
+        CHECK(parse("whilE") == -1);
+    }
+    SUBCASE("parse big table")
+    {
+        auto parse = [&](const char* str) {
+            auto input      = lexy_test::_get_input(lexy_test::forward_input, str);
+            auto contiguous = big_symbols.parse(lexy::zstring_input(str));
+            auto forward    = big_symbols.parse(input);
+            CHECK(contiguous == forward);
+            return contiguous ? big_symbols[contiguous] : -1;
+        };
+
+        CHECK(parse("Aa") == 1);
+        CHECK(parse("Ab") == 2);
+        CHECK(parse("Ej") == 50);
+        CHECK(parse("Jj") == 100);
+
+        CHECK(parse("") == -1);
+        CHECK(parse("A") == -1);
+        CHECK(parse("Ak") == -1);
+        CHECK(parse("Aaa") == -1);
+        CHECK(parse("aA") == -1);
+    }
 }
 
 namespace
@@ -416,3 +501,67 @@ TEST_CASE("dsl::symbol(identifier)")
     }
 }
 
+TEST_CASE("dsl::symbol(identifier) big table")
+{
+    constexpr auto symbol = dsl::symbol<big_symbols>(dsl::identifier(dsl::ascii::alpha));
+    CHECK(lexy::is_branch_rule<decltype(symbol)>);
+
+    SUBCASE("as rule")
+    {
+        struct production : test_production_for<decltype(symbol)>, with_whitespace
+        {};
+
+        auto empty = LEXY_VERIFY_P(production, "");
+        CHECK(empty.status == test_result::fatal_error);
+        CHECK(empty.trace == test_trace().expected_char_class(0, "ASCII.alpha").cancel());
+
+        auto Aa = LEXY_VERIFY_P(production, "Aa");
+        CHECK(Aa.status == test_result::success);
+        CHECK(Aa.value == 1);
+        CHECK(Aa.trace == test_trace().token("identifier", "Aa"));
+        auto Jj = LEXY_VERIFY_P(production, "Jj");
+        CHECK(Jj.status == test_result::success);
+        CHECK(Jj.value == 100);
+        CHECK(Jj.trace == test_trace().token("identifier", "Jj"));
+
+        auto Aab = LEXY_VERIFY_P(production, "Aab");
+        CHECK(Aab.status == test_result::fatal_error);
+        CHECK(Aab.trace
+              == test_trace().token("identifier", "Aab").error(0, 3, "unknown symbol").cancel());
+        auto Ka = LEXY_VERIFY_P(production, "Ka");
+        CHECK(Ka.status == test_result::fatal_error);
+        CHECK(Ka.trace
+              == test_trace().token("identifier", "Ka").error(0, 2, "unknown symbol").cancel());
+
+        auto whitespace = LEXY_VERIFY_P(production, "Bc...");
+        CHECK(whitespace.status == test_result::success);
+        CHECK(whitespace.value == 13);
+        CHECK(whitespace.trace == test_trace().token("identifier", "Bc").whitespace("..."));
+    }
+    SUBCASE("as branch")
+    {
+        struct production : test_production_for<decltype(dsl::if_(symbol))>, with_whitespace
+        {};
+
+        auto empty = LEXY_VERIFY_P(production, "");
+        CHECK(empty.status == test_result::success);
+        CHECK(empty.value == 0);
+        CHECK(empty.trace == test_trace());
+
+        auto Aa = LEXY_VERIFY_P(production, "Aa");
+        CHECK(Aa.status == test_result::success);
+        CHECK(Aa.value == 1);
+        CHECK(Aa.trace == test_trace().token("identifier", "Aa"));
+
+        auto Aab = LEXY_VERIFY_P(production, "Aab");
+        CHECK(Aab.status == test_result::success);
+        CHECK(Aab.value == 0);
+        CHECK(Aab.trace == test_trace());
+
+        auto whitespace = LEXY_VERIFY_P(production, "Bc...");
+        CHECK(whitespace.status == test_result::success);
+        CHECK(whitespace.value == 13);
+        CHECK(whitespace.trace == test_trace().token("identifier", "Bc").whitespace("..."));
+    }
+}
+
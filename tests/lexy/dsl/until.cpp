@@ -34,6 +34,14 @@ TEST_CASE("dsl::until()")
     CHECK(unterminated.trace
           == test_trace().error_token("abc").expected_literal(3, "!", 0).cancel());
 
+    auto forward = LEXY_VERIFY(forward_input, "abc!");
+    CHECK(forward.status == test_result::success);
+    CHECK(forward.trace == test_trace().token("any", "abc!"));
+    auto forward_unterminated = LEXY_VERIFY(forward_input, "abc");
+    CHECK(forward_unterminated.status == test_result::fatal_error);
+    CHECK(forward_unterminated.trace
+          == test_trace().error_token("abc").expected_literal(3, "!", 0).cancel());
+
     auto invalid_utf8 = LEXY_VERIFY(lexy::utf8_encoding{}, 'a', 'b', 'c', 0x80, '!');
     CHECK(invalid_utf8.status == test_result::success);
     CHECK(invalid_utf8.trace == test_trace().token("any", "abc\\x80!"));
@@ -67,8 +75,73 @@ TEST_CASE("dsl::until().or_eof()")
     CHECK(unterminated.status == test_result::success);
     CHECK(unterminated.trace == test_trace().token("any", "abc"));
 
+    auto forward = LEXY_VERIFY(forward_input, "abc!");
+    CHECK(forward.status == test_result::success);
+    CHECK(forward.trace == test_trace().token("any", "abc!"));
+    auto forward_unterminated = LEXY_VERIFY(forward_input, "abc");
+    CHECK(forward_unterminated.status == test_result::success);
+    CHECK(forward_unterminated.trace == test_trace().token("any", "abc"));
+
     auto invalid_utf8 = LEXY_VERIFY(lexy::utf8_encoding{}, 'a', 'b', 'c', 0x80, '!');
     CHECK(invalid_utf8.status == test_result::success);
     CHECK(invalid_utf8.trace == test_trace().token("any", "abc\\x80!"));
 }
 
+
+TEST_CASE("dsl::until() long input")
+{
+    // The input is long enough that we skip to the condition in bulk.
+    constexpr auto callback = token_callback;
+
+    SUBCASE("literal")
+    {
+        constexpr auto rule = dsl::until(LEXY_LIT("*/"));
+
+        auto comment = LEXY_VERIFY("a*b**c/d-0123456789-0123456789-0123456789*/e");
+        CHECK(comment.status == test_result::success);
+        CHECK(comment.trace
+              == test_trace().token("any", "a*b**c/d-0123456789-0123456789-0123456789*/"));
+
+        auto unterminated = LEXY_VERIFY("a*b**c/d-0123456789-0123456789-0123456789*");
+        CHECK(unterminated.status == test_result::fatal_error);
+        CHECK(unterminated.trace
+              == test_trace()
+                     .error_token("a*b**c/d-0123456789-0123456789-0123456789*")
+                     .expected_literal(42, "*/", 0)
+                     .cancel());
+
+        auto utf16 = LEXY_VERIFY(u"a*b**c/d-0123456789-0123456789-0123456789*/e");
+        CHECK(utf16.status == test_result::success);
+        CHECK(utf16.trace
+              == test_trace().token("any", "a*b**c/d-0123456789-0123456789-0123456789*/"));
+    }
+    SUBCASE("literal set")
+    {
+        constexpr auto rule = dsl::until(dsl::literal_set(LEXY_LIT("!!"), LEXY_LIT("?"))).or_eof();
+
+        auto question = LEXY_VERIFY("a!b-0123456789-0123456789-0123456789?c");
+        CHECK(question.status == test_result::success);
+        CHECK(question.trace == test_trace().token("any", "a!b-0123456789-0123456789-0123456789?"));
+        auto exclamation = LEXY_VERIFY("a!b-0123456789-0123456789-0123456789!!c");
+        CHECK(exclamation.status == test_result::success);
+        CHECK(exclamation.trace
+              == test_trace().token("any", "a!b-0123456789-0123456789-0123456789!!"));
+
+        auto eof = LEXY_VERIFY("a!b-0123456789-0123456789-0123456789!");
+        CHECK(eof.status == test_result::success);
+        CHECK(eof.trace == test_trace().token("any", "a!b-0123456789-0123456789-0123456789!"));
+    }
+    SUBCASE("big literal set")
+    {
+        constexpr auto rule = dsl::until(dsl::literal_set(LEXY_LIT("a"), LEXY_LIT("b"),
+                                                          LEXY_LIT("c"), LEXY_LIT("d"),
+                                                          LEXY_LIT("e"), LEXY_LIT("f"),
+                                                          LEXY_LIT("g"), LEXY_LIT("h"),
+                                                          LEXY_LIT("i")));
+
+        auto found = LEXY_VERIFY("0123456789-0123456789-0123456789-0123456789i");
+        CHECK(found.status == test_result::success);
+        CHECK(found.trace
+              == test_trace().token("any", "0123456789-0123456789-0123456789-0123456789i"));
+    }
+}
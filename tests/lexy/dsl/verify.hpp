@@ -10,6 +10,7 @@
 #include <lexy/callback/adapter.hpp>
 #include <lexy/callback/fold.hpp>
 #include <lexy/dsl/any.hpp>
+#include <lexy/input/range_input.hpp>
 #include <lexy/input/string_input.hpp>
 #include <lexy/token.hpp>
 #include <lexy/visualize.hpp>
@@ -581,6 +582,52 @@ constexpr auto _get_input(Encoding, const CharT* str)
 {
     return lexy::zstring_input<Encoding>(str);
 }
+// Reads the string using forward iterators, so rules can't use the ContiguousReader fast paths.
+struct forward_input_t
+{};
+constexpr auto forward_input = forward_input_t{};
+
+template <typename CharT>
+class _forward_iterator
+: public lexy::_detail::forward_iterator_base<_forward_iterator<CharT>, const CharT>
+{
+public:
+    constexpr _forward_iterator() noexcept : _ptr(nullptr) {}
+    constexpr explicit _forward_iterator(const CharT* ptr) noexcept : _ptr(ptr) {}
+
+    constexpr const CharT& deref() const noexcept
+    {
+        return *_ptr;
+    }
+    constexpr void increment() noexcept
+    {
+        ++_ptr;
+    }
+    constexpr bool equal(_forward_iterator rhs) const noexcept
+    {
+        return _ptr == rhs._ptr;
+    }
+
+private:
+    const CharT* _ptr;
+};
+
+template <typename Encoding, typename CharT>
+constexpr auto _get_input(forward_input_t, Encoding, const CharT* str)
+{
+    auto end = str;
+    while (*end)
+        ++end;
+
+    using iterator = _forward_iterator<CharT>;
+    return lexy::range_input<Encoding, iterator>(iterator(str), iterator(end));
+}
+template <typename CharT>
+constexpr auto _get_input(forward_input_t, const CharT* str)
+{
+    return _get_input(forward_input, lexy::deduce_encoding<CharT>{}, str);
+}
+
 template <typename Encoding, typename = typename Encoding::int_type>
 constexpr auto _get_input(Encoding)
 {
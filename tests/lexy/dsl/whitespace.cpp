@@ -4,6 +4,7 @@
 #include <lexy/dsl/whitespace.hpp>
 
 #include "verify.hpp"
+#include <lexy/dsl/ascii.hpp>
 #include <lexy/dsl/if.hpp>
 #include <lexy/dsl/production.hpp>
 #include <lexy/dsl/recover.hpp>
@@ -14,6 +15,11 @@ struct with_whitespace
 {
     static constexpr auto whitespace = LEXY_LIT(".");
 };
+
+struct with_char_class_whitespace
+{
+    static constexpr auto whitespace = dsl::ascii::space;
+};
 } // namespace
 
 TEST_CASE("automatic whitespace")
@@ -39,6 +45,20 @@ TEST_CASE("automatic whitespace")
         CHECK(ws.status == test_result::success);
         CHECK(ws.trace == test_trace().whitespace("..").literal("x").whitespace(".."));
     }
+    SUBCASE("char class whitespace")
+    {
+        struct production : test_production_for<decltype(rule)>,
+                            with_char_class_whitespace
+        {};
+
+        auto ws = LEXY_VERIFY_P(production, "\t\t\nx\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\n");
+        CHECK(ws.status == test_result::success);
+        CHECK(ws.trace
+              == test_trace()
+                     .whitespace("\\t\\t\\n")
+                     .literal("x")
+                     .whitespace("\\t\\t\\t\\t\\t\\t\\t\\t\\t\\t\\t\\t\\t\\t\\t\\t\\t\\t\\n"));
+    }
     SUBCASE("indirect parent has whitespace")
     {
         struct inner : production_for<decltype(rule)>
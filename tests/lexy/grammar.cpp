@@ -33,6 +33,9 @@ struct prod_depth
 {
     static constexpr auto max_recursion_depth = 32;
 };
+
+struct prod_segmented : lexy::segmented_stack_production
+{};
 } // namespace
 
 TEST_CASE("production traits simple")
@@ -57,6 +60,12 @@ TEST_CASE("max_recursion_depth()")
 {
     CHECK(lexy::max_recursion_depth<prod>() == 1024);
     CHECK(lexy::max_recursion_depth<prod_depth>() == 32);
+    // Without stack segments, the recursion is still limited by the native stack.
+#if LEXY_HAS_STACK_SEGMENTS
+    CHECK(lexy::max_recursion_depth<prod_segmented>() == INT_MAX);
+#else
+    CHECK(lexy::max_recursion_depth<prod_segmented>() == 1024);
+#endif
 }
 
 namespace
@@ -6,6 +6,26 @@
 #include <doctest/doctest.h>
 #include <lexy/input/string_input.hpp>
 
+TEST_CASE("ContiguousReader")
+{
+    auto input  = lexy::zstring_input("abc");
+    auto reader = input.reader();
+    CHECK(lexy::_detail::is_contiguous_reader<decltype(reader)>);
+
+    auto remaining = reader.remaining();
+    CHECK(remaining.begin() == input.data());
+    CHECK(remaining.size() == 3);
+
+    reader.advance(2);
+    CHECK(reader.position() == input.data() + 2);
+    CHECK(reader.peek() == 'c');
+    CHECK(reader.remaining().size() == 1);
+
+    reader.advance(1);
+    CHECK(reader.peek() == lexy::default_encoding::eof());
+    CHECK(reader.remaining().empty());
+}
+
 TEST_CASE("partial_input()")
 {
     auto input = lexy::zstring_input("abc");
@@ -4,6 +4,7 @@
 #include <lexy/input/buffer.hpp>
 
 #include <doctest/doctest.h>
+#include <string>
 
 #if defined(__has_include) && __has_include(<memory_resource>)
 #    include <memory_resource>
@@ -238,6 +239,23 @@ TEST_CASE("buffer")
         CHECK(reader.position() == buffer.data() + 3);
         CHECK(reader.peek() == lexy::default_encoding::eof());
     }
+    SUBCASE("reader, remaining")
+    {
+        const lexy::buffer<lexy::ascii_encoding> buffer(str, 3);
+
+        auto reader = buffer.reader();
+        CHECK(reader.remaining().begin() == buffer.data());
+        CHECK(reader.remaining().size() == 3);
+
+        reader.advance(2);
+        CHECK(reader.position() == buffer.data() + 2);
+        CHECK(reader.peek() == 'c');
+        CHECK(reader.remaining().size() == 1);
+
+        reader.advance(1);
+        CHECK(reader.peek() == lexy::default_encoding::eof());
+        CHECK(reader.remaining().empty());
+    }
 }
 
 TEST_CASE("make_buffer")
@@ -421,5 +439,132 @@ TEST_CASE("make_buffer")
         CHECK(big_bom.size() == 1);
         CHECK(big_bom.data()[0] == 0x00112233);
     }
+    SUBCASE("long input")
+    {
+        // Long enough to use the vectorized conversion, with a remainder.
+        unsigned char long_str[4 * 67];
+        for (auto i = 0u; i != sizeof(long_str); ++i)
+            long_str[i] = static_cast<unsigned char>(i);
+
+        auto utf16 = lexy::make_buffer_from_raw<lexy::utf16_encoding,
+                                                lexy::encoding_endianness::big>(long_str,
+                                                                                sizeof(long_str));
+        CHECK(utf16.size() == 2 * 67);
+        for (auto i = 0u; i != utf16.size(); ++i)
+        {
+            auto expected = (long_str[2 * i] << 8) | long_str[2 * i + 1];
+            CHECK(utf16.data()[i] == expected);
+        }
+
+        auto utf32
+            = lexy::make_buffer_from_raw<lexy::utf32_encoding,
+                                         lexy::encoding_endianness::little>(long_str,
+                                                                            sizeof(long_str));
+        CHECK(utf32.size() == 67);
+        for (auto i = 0u; i != utf32.size(); ++i)
+        {
+            auto expected = char32_t(long_str[4 * i]) | char32_t(long_str[4 * i + 1]) << 8
+                            | char32_t(long_str[4 * i + 2]) << 16
+                            | char32_t(long_str[4 * i + 3]) << 24;
+            CHECK(utf32.data()[i] == expected);
+        }
+    }
 }
 
+
+TEST_CASE("validate_utf8")
+{
+    // Long enough to use the vectorized validation, with multi-byte sequences everywhere.
+    auto make_text = [] {
+        std::string text;
+        for (auto i = 0; i != 20; ++i)
+            text += "a\xC3\xA4\xE2\x82\xAC\xF0\x9F\x99\x82"; // aä€🙂
+        return text;
+    };
+    auto validate = [](const std::string& text) {
+        return lexy::validate_utf8(lexy::buffer<lexy::utf8_encoding>(text.data(), text.size()));
+    };
+
+    SUBCASE("well-formed")
+    {
+        for (auto offset = 0u; offset != 16; ++offset)
+        {
+            INFO(offset);
+
+            auto result = validate(std::string(offset, 'x') + make_text());
+            REQUIRE(result);
+
+            auto buffer = LEXY_MOV(result).buffer();
+            CHECK(buffer.size() == offset + make_text().size());
+
+            auto reader = buffer.reader();
+            static_assert(lexy::_detail::is_validated_utf8_reader<decltype(reader)>);
+            auto unchecked_reader = buffer.buffer().reader();
+            static_assert(!lexy::_detail::is_validated_utf8_reader<decltype(unchecked_reader)>);
+            while (true)
+            {
+                auto cp       = lexy::_detail::parse_code_point(reader);
+                auto expected = lexy::_detail::parse_code_point(unchecked_reader);
+                CHECK(cp.error == expected.error);
+                CHECK(cp.end == expected.end);
+                if (cp.error != lexy::_detail::cp_error::success)
+                    break;
+
+                CHECK(cp.cp == expected.cp);
+                reader.set_position(cp.end);
+                unchecked_reader.set_position(expected.end);
+            }
+        }
+    }
+    SUBCASE("ill-formed")
+    {
+        const char* sequences[] = {
+            "\x80",             // leads with trailing
+            "\xC3\x41",         // missing trailing
+            "\xE2\x82\x41",     // missing trailing
+            "\xC0\x84",         // overlong
+            "\xE0\x80\x80",     // overlong
+            "\xF0\x80\x80\x80", // overlong
+            "\xED\xA0\x80",     // surrogate
+            "\xF4\x90\x80\x80", // out of range
+            "\xF8\x80\x80\x80", // invalid lead
+            "\xFF",             // invalid lead
+        };
+        for (auto sequence : sequences)
+            for (auto offset = 0u; offset != 16; ++offset)
+            {
+                INFO(offset);
+
+                auto prefix = std::string(offset, 'x') + make_text();
+                auto result = validate(prefix + sequence + make_text());
+                REQUIRE(!result);
+
+                auto error  = result.error_position();
+                auto buffer = LEXY_MOV(result).unvalidated_buffer();
+                CHECK(std::size_t(error - buffer.data()) == prefix.size());
+            }
+    }
+    SUBCASE("truncated")
+    {
+        for (auto offset = 0u; offset != 16; ++offset)
+        {
+            INFO(offset);
+
+            auto text = std::string(offset, 'x') + make_text();
+            text.pop_back();
+
+            auto result = validate(text);
+            REQUIRE(!result);
+
+            auto error  = result.error_position();
+            auto buffer = LEXY_MOV(result).unvalidated_buffer();
+            CHECK(std::size_t(error - buffer.data()) == text.size() - 3);
+        }
+    }
+    SUBCASE("empty")
+    {
+        auto result = validate("");
+        REQUIRE(result);
+        CHECK(result.buffer().size() == 0);
+    }
+}
@@ -195,6 +195,112 @@ TEST_CASE("read_file")
     std::remove(test_file_name);
 }
 
+TEST_CASE("map_file")
+{
+    std::remove(test_file_name);
+
+    SUBCASE("non-existing file")
+    {
+        auto result = lexy::map_file(test_file_name);
+        CHECK(!result);
+        CHECK(result.error() == lexy::file_error::file_not_found);
+    }
+    SUBCASE("empty file")
+    {
+        write_test_data("");
+
+        auto result = lexy::map_file(test_file_name);
+        REQUIRE(result);
+        CHECK(result.file().size() == 0);
+
+        auto reader = result.file().reader();
+        CHECK(reader.peek() == lexy::default_encoding::eof());
+    }
+    SUBCASE("tiny file")
+    {
+        write_test_data("abc");
+
+        auto result = lexy::map_file(test_file_name);
+        REQUIRE(result);
+        CHECK(result.file().size() == 3);
+
+        auto reader = result.file().reader();
+        CHECK(reader.peek() == 'a');
+
+        reader.bump();
+        CHECK(reader.peek() == 'b');
+
+        reader.bump();
+        CHECK(reader.peek() == 'c');
+
+        reader.bump();
+        CHECK(reader.peek() == lexy::default_encoding::eof());
+    }
+    SUBCASE("big file")
+    {
+        {
+            auto file = std::fopen(test_file_name, "wb");
+            for (auto i = 0; i != 200 * 1024; ++i)
+                std::fputc('a', file);
+            for (auto i = 0; i != 200 * 1024; ++i)
+                std::fputc('b', file);
+            std::fclose(file);
+        }
+
+        auto result = lexy::map_file(test_file_name, lexy::mapped_file_advice::willneed);
+        REQUIRE(result);
+
+        auto file   = LEXY_MOV(result).file();
+        auto reader = file.reader();
+        for (auto i = 0; i != 200 * 1024; ++i)
+        {
+            CHECK(reader.peek() == 'a');
+            reader.bump();
+        }
+
+        for (auto i = 0; i != 200 * 1024; ++i)
+        {
+            CHECK(reader.peek() == 'b');
+            reader.bump();
+        }
+
+        CHECK(reader.peek() == lexy::default_encoding::eof());
+    }
+    SUBCASE("UTF-8 with BOM")
+    {
+        write_test_data("\xEF\xBB\xBF" "abc");
+
+        auto result = lexy::map_file<lexy::utf8_encoding>(test_file_name);
+        REQUIRE(result);
+        CHECK(result.file().size() == 3);
+
+        auto reader = result.file().reader();
+        CHECK(reader.peek() == 'a');
+    }
+    SUBCASE("native byte order")
+    {
+        const char16_t data[] = {0x2211, 0x4433, 0x0000};
+        write_test_data(reinterpret_cast<const char*>(data));
+
+        constexpr auto native
+            = LEXY_IS_LITTLE_ENDIAN ? lexy::encoding_endianness::little
+                                    : lexy::encoding_endianness::big;
+        auto result = lexy::map_file<lexy::utf16_encoding, native>(test_file_name);
+        REQUIRE(result);
+
+        auto reader = result.file().reader();
+        CHECK(reader.peek() == 0x2211);
+
+        reader.bump();
+        CHECK(reader.peek() == 0x4433);
+
+        reader.bump();
+        CHECK(reader.peek() == lexy::utf16_encoding::eof());
+    }
+
+    std::remove(test_file_name);
+}
+
 TEST_CASE("read_stdin")
 {
     // Here, we'll reassociate stdin with our test file.
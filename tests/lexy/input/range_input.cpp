@@ -58,6 +58,7 @@ struct test_sentinel
 TEST_CASE("range_input")
 {
     lexy::range_input<lexy::default_encoding, test_iterator, test_sentinel> input;
+    CHECK(!lexy::_detail::is_contiguous_reader<decltype(input.reader())>);
     CHECK(sizeof(input) == (LEXY_HAS_EMPTY_MEMBER ? sizeof(int) : 2 * sizeof(int)));
 
     CHECK(input.reader().position().count == 0);
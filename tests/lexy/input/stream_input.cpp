@@ -0,0 +1,259 @@
+// Copyright (C) 2020-2022 Jonathan Müller and lexy contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#include <lexy/input/stream_input.hpp>
+
+#include <algorithm>
+#include <doctest/doctest.h>
+#include <lexy/action/match.hpp>
+#include <lexy/action/validate.hpp>
+#include <lexy/callback/adapter.hpp>
+#include <lexy/callback/container.hpp>
+#include <lexy/dsl/ascii.hpp>
+#include <lexy/dsl/commit.hpp>
+#include <lexy/dsl/eof.hpp>
+#include <lexy/dsl/list.hpp>
+#include <lexy/dsl/loop.hpp>
+#include <lexy/dsl/newline.hpp>
+#include <lexy/dsl/production.hpp>
+#include <lexy/dsl/terminator.hpp>
+#include <lexy/input_location.hpp>
+#include <string>
+#include <vector>
+
+namespace
+{
+// Returns at most three characters at a time, like a pipe that isn't filled yet.
+struct string_source
+{
+    const std::string* str;
+    std::size_t        pos;
+
+    std::size_t operator()(char* buffer, std::size_t size)
+    {
+        auto count = std::min({size, std::size_t(3), str->size() - pos});
+        str->copy(buffer, count, pos);
+        pos += count;
+        return count;
+    }
+};
+
+template <typename Reader>
+std::string read_all(Reader& reader)
+{
+    std::string result;
+    while (reader.peek() != lexy::default_encoding::eof())
+    {
+        result += char(reader.peek());
+        reader.bump();
+    }
+    return result;
+}
+
+namespace dsl = lexy::dsl;
+
+template <bool Commit>
+struct lines
+{
+    static constexpr auto rule = [] {
+        auto line = dsl::while_(dsl::ascii::alpha) + dsl::newline;
+        if constexpr (Commit)
+            return dsl::terminator(dsl::eof).list(line + dsl::commit);
+        else
+            return dsl::terminator(dsl::eof).list(line);
+    }();
+};
+
+// Every line is a separate production, which begins after the commit.
+struct line_productions
+{
+    struct line
+    {
+        static constexpr auto rule = dsl::while_(dsl::ascii::alpha) + dsl::newline;
+    };
+
+    static constexpr auto rule = dsl::terminator(dsl::eof).list(dsl::p<line> + dsl::commit);
+};
+
+std::string make_lines(unsigned count)
+{
+    std::string result;
+    for (auto i = 0u; i != count; ++i)
+        result += "abcdefgh\n";
+    return result;
+}
+} // namespace
+
+TEST_CASE("stream_input")
+{
+    SUBCASE("empty")
+    {
+        std::string        str;
+        lexy::stream_input input(string_source{&str, 0}, 4);
+
+        auto reader = input.reader();
+        CHECK(reader.peek() == lexy::default_encoding::eof());
+        CHECK(reader.position().index() == 0);
+
+        reader.set_position(reader.position());
+        CHECK(reader.peek() == lexy::default_encoding::eof());
+        CHECK(input.live_chunks() == 0);
+    }
+    SUBCASE("multiple chunks")
+    {
+        for (auto size : {1u, 4u, 7u, 8u, 9u, 100u})
+        {
+            INFO(size);
+            std::string        str(size, 'a');
+            lexy::stream_input input(string_source{&str, 0}, 4);
+            for (auto i = 0u; i != size; ++i)
+                str[i] = char('a' + i % 26);
+
+            auto reader = input.reader();
+            CHECK(read_all(reader) == str);
+            CHECK(reader.position().index() == size);
+            CHECK(input.live_chunks() == (size + 3) / 4);
+        }
+    }
+    SUBCASE("backtracking")
+    {
+        std::string        str = "abcdefghij";
+        lexy::stream_input input(string_source{&str, 0}, 4);
+
+        auto reader = input.reader();
+        auto begin  = reader.position();
+        reader.bump();
+        auto b = reader.position();
+        CHECK(*b == 'b');
+
+        CHECK(read_all(reader) == "bcdefghij");
+        auto end = reader.position();
+
+        reader.set_position(b);
+        CHECK(reader.peek() == 'b');
+        CHECK(read_all(reader) == "bcdefghij");
+
+        reader.set_position(begin);
+        CHECK(read_all(reader) == str);
+
+        reader.set_position(end);
+        CHECK(reader.peek() == lexy::default_encoding::eof());
+
+        // Iterating the range between positions.
+        std::string range;
+        for (auto iter = b; iter != end; ++iter)
+            range += *iter;
+        CHECK(range == "bcdefghij");
+    }
+    SUBCASE("end at chunk boundary")
+    {
+        std::string        str = "abcdefgh";
+        lexy::stream_input input(string_source{&str, 0}, 4);
+
+        auto reader = input.reader();
+        CHECK(read_all(reader) == str);
+        auto end = reader.position();
+        CHECK(end.index() == 8);
+
+        reader.set_position(decltype(input)::iterator(input, 0));
+        reader.set_position(end);
+        CHECK(reader.peek() == lexy::default_encoding::eof());
+        CHECK(reader.position() == end);
+    }
+    SUBCASE("commit")
+    {
+        std::string        str = "abcd\nfghij";
+        lexy::stream_input input(string_source{&str, 0}, 4);
+
+        auto reader = input.reader();
+        for (auto i = 0; i != 5; ++i)
+            reader.bump();
+        CHECK(input.live_chunks() == 2);
+
+        reader.commit();
+        CHECK(input.live_chunks() == 1);
+        CHECK(reader.peek() == 'f');
+        CHECK(read_all(reader) == "fghij");
+        CHECK(input.live_chunks() == 2);
+        CHECK(input.max_live_chunks() == 2);
+    }
+    SUBCASE("commit inside a line")
+    {
+        std::string        str = "ab\ncdefghij\nk";
+        lexy::stream_input input(string_source{&str, 0}, 4);
+
+        auto reader = input.reader();
+        for (auto i = 0; i != 7; ++i)
+            reader.bump();
+        CHECK(input.live_chunks() == 2);
+
+        // We keep the chunk with the beginning of the line.
+        reader.commit();
+        CHECK(input.live_chunks() == 2);
+
+        CHECK(read_all(reader) == "ghij\nk");
+        reader.commit();
+        CHECK(input.live_chunks() == 1);
+
+        // The reader begins at the line of the last commit.
+        auto line = input.reader();
+        CHECK(line.position().index() == 12);
+        CHECK(line.peek() == 'k');
+    }
+    SUBCASE("location after commit")
+    {
+        auto str = make_lines(100);
+        str.replace(99 * 9 + 4, 1, "1");
+
+        struct error_location
+        {
+            unsigned context_line, line, column;
+        };
+        auto callback
+            = lexy::callback<error_location>([](const auto& context, const auto& error) {
+                  auto context_location
+                      = lexy::get_input_location(context.input(), context.position());
+                  auto location = lexy::get_input_location(context.input(), error.position(),
+                                                           context_location.anchor());
+                  return error_location{context_location.line_nr(), location.line_nr(),
+                                        location.column_nr()};
+              });
+
+        lexy::stream_input input(string_source{&str, 0}, 16);
+        auto result = lexy::validate<line_productions>(input, lexy::collect<std::vector<
+                                                                  error_location>>(callback));
+        // A line can span two chunks, and we've already loaded the next one.
+        CHECK(input.max_live_chunks() <= 3);
+        REQUIRE(result.error_count() == 1);
+        CHECK(result.errors()[0].context_line == 100);
+        CHECK(result.errors()[0].line == 100);
+        CHECK(result.errors()[0].column == 5);
+    }
+    SUBCASE("dsl::commit")
+    {
+        auto str = make_lines(1000);
+
+        lexy::stream_input with_commit(string_source{&str, 0}, 64);
+        CHECK(lexy::match<lines<true>>(with_commit));
+        CHECK(with_commit.max_live_chunks() <= 2);
+
+        lexy::stream_input without_commit(string_source{&str, 0}, 64);
+        CHECK(lexy::match<lines<false>>(without_commit));
+        CHECK(without_commit.max_live_chunks() == (str.size() + 63) / 64);
+    }
+    SUBCASE("FILE")
+    {
+        auto file = std::tmpfile();
+        REQUIRE(file);
+
+        auto str = make_lines(100);
+        std::fwrite(str.data(), 1, str.size(), file);
+        std::rewind(file);
+
+        lexy::stream_input input(file, 16);
+        CHECK(lexy::match<lines<true>>(input));
+        CHECK(input.max_live_chunks() <= 2);
+
+        std::fclose(file);
+    }
+}
@@ -5,6 +5,7 @@
 
 #include <doctest/doctest.h>
 #include <lexy/input/string_input.hpp>
+#include <string>
 
 TEST_CASE("get_input_location()")
 {
@@ -155,6 +156,91 @@ TEST_CASE("get_input_location()")
     }
 }
 
+TEST_CASE("line_index")
+{
+    auto verify_all = [](const auto& index, auto counting) {
+        using counting_t = decltype(counting);
+
+        auto& input = index.input();
+        for (auto offset = 0u; offset <= input.size(); ++offset)
+        {
+            INFO(offset);
+            auto pos = input.data() + offset;
+
+            auto expected = lexy::get_input_location<counting_t>(input, pos);
+            auto actual   = lexy::get_input_location<counting_t>(index, pos);
+            CHECK(actual.line_nr() == expected.line_nr());
+            CHECK(actual.column_nr() == expected.column_nr());
+            CHECK(actual.position() == expected.position());
+            CHECK(actual.anchor()._line_begin == expected.anchor()._line_begin);
+        }
+    };
+
+    SUBCASE("empty")
+    {
+        auto input = lexy::zstring_input("");
+        auto index = lexy::line_index(input);
+        CHECK(index.line_count() == 1);
+        CHECK(&index.input() == &input);
+
+        auto loc = lexy::get_input_location(index, input.data());
+        CHECK(loc.line_nr() == 1);
+        CHECK(loc.column_nr() == 1);
+    }
+    SUBCASE("code unit counting")
+    {
+        auto input = lexy::zstring_input("Line 1\n"
+                                         "Line 2\r\n"
+                                         "Line 3\n");
+        auto index = lexy::line_index(input);
+        CHECK(index.line_count() == 4);
+
+        auto loc = lexy::get_input_location(index, input.data() + 14);
+        CHECK(loc.line_nr() == 2);
+        CHECK(loc.column_nr() == 7);
+        CHECK(loc.position() == input.data() + 13);
+
+        verify_all(index, lexy::code_unit_location_counting{});
+    }
+    SUBCASE("code point counting")
+    {
+        auto input = lexy::zstring_input<lexy::utf8_encoding>(u8"Line 1\n"
+                                                              u8"Line 2\r\n"
+                                                              u8"ä\n");
+        auto index = lexy::line_index(input);
+        CHECK(index.line_count() == 4);
+
+        verify_all(index, lexy::code_point_location_counting{});
+    }
+    SUBCASE("UTF-16")
+    {
+        auto input = lexy::zstring_input<lexy::utf16_encoding>(u"Line 1\n"
+                                                               u"\n"
+                                                               u"Line 3\r\n"
+                                                               u"\x0A0A\n");
+        auto index = lexy::line_index(input);
+        CHECK(index.line_count() == 5);
+
+        verify_all(index, lexy::code_unit_location_counting{});
+    }
+    SUBCASE("long input")
+    {
+        std::string str;
+        for (auto i = 0u; i != 200; ++i)
+        {
+            str.append(i % 7, 'a');
+            str += i % 3 == 0 ? "\r\n" : "\n";
+        }
+        str += "end";
+
+        auto input = lexy::string_input(str);
+        auto index = lexy::line_index(input);
+        CHECK(index.line_count() == 201);
+
+        verify_all(index, lexy::code_unit_location_counting{});
+    }
+}
+
 TEST_CASE("_detail::get_input_line()")
 {
     auto input = lexy::zstring_input("Line 1\n"
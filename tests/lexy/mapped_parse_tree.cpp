@@ -0,0 +1,191 @@
+// Copyright (C) 2020-2022 Jonathan Müller and lexy contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#undef LEXY_DISABLE_FILE
+#include <lexy/mapped_parse_tree.hpp>
+
+#include <cstdio>
+#include <doctest/doctest.h>
+#include <iterator>
+#include <lexy/action/parse_as_tree.hpp>
+#include <lexy/dsl.hpp>
+#include <lexy/input/string_input.hpp>
+#include <lexy_ext/parse_tree_doctest.hpp>
+#include <string>
+
+namespace
+{
+constexpr auto test_file_name = "lexy-mapped-parse-tree.test.delete-me";
+
+void write_test_data(const std::string& data)
+{
+    auto file = std::fopen(test_file_name, "wb");
+    std::fwrite(data.data(), 1, data.size(), file);
+    std::fclose(file);
+}
+
+struct abc_p : lexy::token_production
+{
+    static constexpr auto name = "abc_p";
+    static constexpr auto rule = LEXY_LIT("abc");
+};
+
+struct child_p
+{
+    static constexpr auto name = "child_p";
+    static constexpr auto rule = lexy::dsl::parenthesized(lexy::dsl::p<abc_p>);
+};
+
+struct root_p
+{
+    static constexpr auto name = "root_p";
+    static constexpr auto rule = lexy::dsl::digits<> + lexy::dsl::p<child_p> + lexy::dsl::digits<>;
+};
+} // namespace
+
+TEST_CASE("serialize_parse_tree")
+{
+    auto input = lexy::zstring_input("123(abc)321");
+
+    lexy::parse_tree_for<decltype(input)> tree;
+    REQUIRE(lexy::parse_as_tree<root_p>(tree, input, lexy::noop));
+
+    std::string data;
+    lexy::serialize_parse_tree_to(std::back_inserter(data), tree, input);
+    CHECK(data.compare(0, 8, "lexy-pt\0", 8) == 0);
+
+    SUBCASE("compact_parse_tree")
+    {
+        lexy::compact_parse_tree_for<decltype(input)> compact_tree;
+        REQUIRE(lexy::parse_as_tree<root_p>(compact_tree, input, lexy::noop));
+
+        std::string compact_data;
+        lexy::serialize_parse_tree_to(std::back_inserter(compact_data), compact_tree, input);
+        CHECK(compact_data == data);
+    }
+    SUBCASE("file")
+    {
+        auto file = std::fopen(test_file_name, "wb");
+        lexy::serialize_parse_tree(file, tree, input);
+        std::fclose(file);
+
+        file = std::fopen(test_file_name, "rb");
+        std::string file_data;
+        for (auto c = std::fgetc(file); c != EOF; c = std::fgetc(file))
+            file_data.push_back(char(c));
+        std::fclose(file);
+        CHECK(file_data == data);
+
+        std::remove(test_file_name);
+    }
+}
+
+TEST_CASE("map_parse_tree")
+{
+    std::remove(test_file_name);
+    auto input = lexy::zstring_input("123(abc)321");
+
+    auto serialized = [&] {
+        lexy::parse_tree_for<decltype(input)> tree;
+        REQUIRE(lexy::parse_as_tree<root_p>(tree, input, lexy::noop));
+
+        std::string data;
+        lexy::serialize_parse_tree_to(std::back_inserter(data), tree, input);
+        return data;
+    }();
+
+    SUBCASE("non-existing file")
+    {
+        auto result = lexy::map_parse_tree(test_file_name, input);
+        CHECK(!result);
+        CHECK(result.error() == lexy::mapped_parse_tree_error::file_not_found);
+    }
+    SUBCASE("valid file")
+    {
+        write_test_data(serialized);
+
+        auto result = lexy::map_parse_tree(test_file_name, input);
+        REQUIRE(result);
+
+        auto tree = LEXY_MOV(result).tree();
+        CHECK(!tree.empty());
+        CHECK(tree.size() == 8);
+        CHECK(tree.depth() == 3);
+
+        // clang-format off
+        auto expected = lexy_ext::parse_tree_desc(root_p{})
+            .digits("123")
+            .production(child_p{})
+                .literal("(")
+                .production(abc_p{})
+                    .literal("abc")
+                    .finish()
+                .literal(")")
+                .finish()
+            .digits("321");
+        // clang-format on
+        CHECK(tree.compact() == expected);
+
+        auto child = *std::next(tree.root().children().begin());
+        CHECK(child.kind() == child_p{});
+        CHECK(child.kind() != root_p{});
+        CHECK(child.kind() == child.kind());
+        CHECK(child.parent() == tree.root());
+
+        auto abc = *std::next(child.children().begin());
+        CHECK(abc.kind() == abc_p{});
+        CHECK(abc.kind().is_token_production());
+        CHECK(!child.kind().is_token_production());
+
+        auto token = *abc.children().begin();
+        CHECK(token.lexeme().begin() == input.data() + 4);
+        CHECK(token.lexeme().end() == input.data() + 7);
+    }
+    SUBCASE("empty tree")
+    {
+        lexy::parse_tree_for<decltype(input)> tree;
+        std::string                           data;
+        lexy::serialize_parse_tree_to(std::back_inserter(data), tree, input);
+        write_test_data(data);
+
+        auto result = lexy::map_parse_tree(test_file_name, input);
+        REQUIRE(result);
+        CHECK(result.tree().empty());
+        CHECK(result.tree().size() == 0);
+    }
+    SUBCASE("invalid file")
+    {
+        write_test_data("abc");
+
+        auto result = lexy::map_parse_tree(test_file_name, input);
+        CHECK(!result);
+        CHECK(result.error() == lexy::mapped_parse_tree_error::invalid_file);
+    }
+    SUBCASE("truncated file")
+    {
+        write_test_data(serialized.substr(0, serialized.size() - 4));
+
+        auto result = lexy::map_parse_tree(test_file_name, input);
+        CHECK(!result);
+        CHECK(result.error() == lexy::mapped_parse_tree_error::invalid_file);
+    }
+    SUBCASE("different version")
+    {
+        serialized[8] = char(serialized[8] + 1);
+        write_test_data(serialized);
+
+        auto result = lexy::map_parse_tree(test_file_name, input);
+        CHECK(!result);
+        CHECK(result.error() == lexy::mapped_parse_tree_error::incompatible_format);
+    }
+    SUBCASE("different input")
+    {
+        write_test_data(serialized);
+
+        auto result = lexy::map_parse_tree(test_file_name, lexy::zstring_input("123(abc)4321"));
+        CHECK(!result);
+        CHECK(result.error() == lexy::mapped_parse_tree_error::input_mismatch);
+    }
+
+    std::remove(test_file_name);
+}
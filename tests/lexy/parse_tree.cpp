@@ -718,6 +718,86 @@ TEST_CASE("parse_tree::builder")
     }
 }
 
+TEST_CASE("parse_tree memory")
+{
+    struct counting_resource
+    {
+        std::size_t allocations   = 0;
+        std::size_t deallocations = 0;
+
+        void* allocate(std::size_t bytes, std::size_t)
+        {
+            ++allocations;
+            return ::operator new(bytes);
+        }
+        void deallocate(void* ptr, std::size_t, std::size_t) noexcept
+        {
+            ++deallocations;
+            ::operator delete(ptr);
+        }
+    };
+    using parse_tree = lexy::parse_tree_for<lexy::string_input<>, token_kind, counting_resource>;
+
+    auto input = lexy::zstring_input("abc");
+    auto build = [&](parse_tree&& tree, unsigned count) {
+        parse_tree::builder builder(LEXY_MOV(tree), root_p{});
+        for (auto i = 0u; i != count; ++i)
+        {
+            auto m = builder.start_production(child_p{});
+            builder.token(token_kind::a, input.data(), input.data() + input.size());
+            builder.finish_production(LEXY_MOV(m));
+        }
+        return LEXY_MOV(builder).finish();
+    };
+
+    counting_resource resource;
+    SUBCASE("reuse")
+    {
+        {
+            parse_tree tree(&resource);
+            tree = build(LEXY_MOV(tree), 1024);
+            CHECK(tree.size() == 2 * 1024 + 1);
+
+            // The blocks grow geometrically.
+            auto allocations = resource.allocations;
+            CHECK(allocations > 1);
+            CHECK(allocations < 8);
+
+            // A smaller tree re-uses the existing blocks.
+            tree = build(LEXY_MOV(tree), 16);
+            CHECK(tree.size() == 2 * 16 + 1);
+            CHECK(resource.allocations == allocations);
+
+            // As does a tree of the same size.
+            tree = build(LEXY_MOV(tree), 1024);
+            CHECK(tree.size() == 2 * 1024 + 1);
+            CHECK(resource.allocations == allocations);
+
+            tree.clear();
+            CHECK(tree.empty());
+            CHECK(resource.deallocations == 0);
+        }
+        CHECK(resource.deallocations == resource.allocations);
+    }
+    SUBCASE("reserve")
+    {
+        {
+            parse_tree tree(&resource);
+            tree.reserve(64 * 1024u);
+            CHECK(resource.allocations == 1);
+
+            tree = build(LEXY_MOV(tree), 1024);
+            CHECK(tree.size() == 2 * 1024 + 1);
+            CHECK(resource.allocations == 1);
+
+            // We already have enough memory.
+            tree.reserve(1024u);
+            CHECK(resource.allocations == 1);
+        }
+        CHECK(resource.deallocations == 1);
+    }
+}
+
 namespace
 {
 template <typename Production, typename NodeKind>
@@ -0,0 +1,179 @@
+// Copyright (C) 2020-2022 Jonathan Müller and lexy contributors
+// SPDX-License-Identifier: BSL-1.0
+
+#include <lexy/structural_index.hpp>
+
+#include <doctest/doctest.h>
+#include <lexy/input/string_input.hpp>
+#include <string>
+#include <vector>
+
+namespace
+{
+std::vector<std::size_t> structurals(const std::string& str)
+{
+    std::vector<std::size_t> result;
+    auto data = reinterpret_cast<const unsigned char*>(str.data());
+    lexy::_detail::for_each_structural_block(data, str.size(),
+                                             [&](std::size_t offset, std::uint64_t mask) {
+                                                 for (auto i = 0u; i != 64; ++i)
+                                                     if (mask & (std::uint64_t(1) << i))
+                                                         result.push_back(offset + i);
+                                             });
+    return result;
+}
+
+std::vector<std::size_t> structurals_naive(const std::string& str)
+{
+    std::vector<std::size_t> result;
+    auto                     in_string = false;
+    for (auto i = std::size_t(0); i != str.size(); ++i)
+    {
+        auto c = str[i];
+        if (in_string)
+        {
+            if (c == '\\')
+                ++i;
+            else if (c == '"')
+                in_string = false;
+        }
+        else if (c == '"')
+            in_string = true;
+        else if (c == '[' || c == ']' || c == '{' || c == '}' || c == ',' || c == ':')
+            result.push_back(i);
+    }
+    return result;
+}
+} // namespace
+
+TEST_CASE("_detail::for_each_structural_block")
+{
+    SUBCASE("basic")
+    {
+        CHECK(structurals("").empty());
+        CHECK(structurals("[1, 2]") == std::vector<std::size_t>{0, 2, 5});
+        CHECK(structurals(R"({"a,b": [":"]})") == std::vector<std::size_t>{0, 6, 8, 12, 13});
+        CHECK(structurals(R"(["\"]", 1])") == std::vector<std::size_t>{0, 6, 9});
+        CHECK(structurals(R"(["\\", 1])") == std::vector<std::size_t>{0, 5, 8});
+    }
+    SUBCASE("escapes across blocks")
+    {
+        // Place sequences of backslashes of all lengths at all positions around a block boundary.
+        for (auto length = 0u; length != 6; ++length)
+            for (auto offset = 50u; offset != 70u; ++offset)
+            {
+                INFO(length);
+                INFO(offset);
+
+                auto str = std::string("[");
+                str.append(offset, ' ');
+                str += '"';
+                str.append(length, '\\');
+                str += "\",[\"],\" , ]";
+
+                CHECK(structurals(str) == structurals_naive(str));
+            }
+    }
+    SUBCASE("long strings")
+    {
+        std::string str = "[";
+        for (auto i = 0u; i != 100; ++i)
+        {
+            str += '"';
+            str.append(i, i % 3 == 0 ? ',' : '\\');
+            if (i % 3 != 0 && i % 2 != 0)
+                str += '\\';
+            str += "\",";
+        }
+        str += "{}]";
+
+        CHECK(structurals(str) == structurals_naive(str));
+    }
+}
+
+TEST_CASE("structural_index")
+{
+    SUBCASE("empty")
+    {
+        auto input = lexy::zstring_input("");
+        auto index = lexy::structural_index(input);
+        CHECK(&index.input() == &input);
+        CHECK(index.size() == 0);
+        CHECK(index.is_balanced());
+    }
+    SUBCASE("array")
+    {
+        auto input = lexy::zstring_input(R"([1, [2, 3], "4,]", {}])");
+        auto index = lexy::structural_index(input);
+        CHECK(index.size() == 10);
+        REQUIRE(index.is_balanced());
+
+        auto data = input.data();
+        CHECK(index.matching_bracket(data) == data + 21);
+        CHECK(index.matching_bracket(data + 21) == data);
+        CHECK(index.matching_bracket(data + 4) == data + 9);
+        CHECK(index.matching_bracket(data + 19) == data + 20);
+
+        CHECK(index.next_separator(data, data + 1) == data + 2);
+        CHECK(index.next_separator(data, data + 3) == data + 10);
+        CHECK(index.next_separator(data, data + 6) == data + 10);
+        CHECK(index.next_separator(data, data + 11) == data + 17);
+        CHECK(index.next_separator(data, data + 18) == data + 21);
+        CHECK(index.next_separator(data + 4, data + 5) == data + 6);
+        CHECK(index.next_separator(data + 4, data + 7) == data + 9);
+    }
+    SUBCASE("object")
+    {
+        auto input = lexy::zstring_input(R"({"a": {"b": 1}, "c:": 2})");
+        auto index = lexy::structural_index(input);
+        CHECK(index.size() == 8);
+        REQUIRE(index.is_balanced());
+
+        auto data = input.data();
+        CHECK(index.matching_bracket(data) == data + 23);
+        CHECK(index.next_separator(data, data + 1) == data + 4);
+        CHECK(index.next_separator(data, data + 5) == data + 14);
+        CHECK(index.next_separator(data, data + 15) == data + 20);
+        CHECK(index.next_separator(data, data + 21) == data + 23);
+    }
+    SUBCASE("long input")
+    {
+        std::string str = "[";
+        for (auto i = 0u; i != 1000; ++i)
+            str += R"({"key\"": [1, 2, "]"]},)";
+        str += "0]";
+
+        auto input = lexy::string_input(str);
+        auto index = lexy::structural_index(input);
+        CHECK(index.size() == 1000 * 8 + 2);
+        REQUIRE(index.is_balanced());
+
+        auto data  = input.data();
+        auto count = 0u;
+        for (auto cur = data + 1;; ++count)
+        {
+            auto sep = index.next_separator(data, cur);
+            if (*sep == ']')
+                break;
+            CHECK(*sep == ',');
+            CHECK(index.matching_bracket(cur) == sep - 1);
+            cur = sep + 1;
+        }
+        CHECK(count == 1000);
+    }
+    SUBCASE("unbalanced")
+    {
+        auto balanced = [](const char* str) {
+            auto input = lexy::zstring_input(str);
+            return lexy::structural_index(input).is_balanced();
+        };
+
+        CHECK(balanced("[{}]"));
+        CHECK(!balanced("["));
+        CHECK(!balanced("]"));
+        CHECK(!balanced("[}"));
+        CHECK(!balanced("[{]}"));
+        CHECK(!balanced(R"(["])"));
+        CHECK(!balanced(R"(["\"])"));
+    }
+}
@@ -3,12 +3,42 @@
 
 #include <lexy/visualize.hpp>
 
+#include <cstdio>
 #include <doctest/doctest.h>
 #include <iterator>
 #include <lexy/input/string_input.hpp>
 #include <lexy/parse_tree.hpp>
 #include <string>
 
+namespace
+{
+// An output iterator that supports bulk writes.
+struct string_writer
+{
+    std::string* str;
+
+    string_writer& operator*() noexcept
+    {
+        return *this;
+    }
+    string_writer& operator++(int) noexcept
+    {
+        return *this;
+    }
+
+    string_writer& operator=(char c)
+    {
+        str->push_back(c);
+        return *this;
+    }
+
+    void write(const char* data, std::size_t length)
+    {
+        str->append(data, length);
+    }
+};
+} // namespace
+
 TEST_CASE("visualize code_point")
 {
     auto visualize = [](lexy::code_point cp, lexy::visualization_options opts) {
@@ -105,6 +135,12 @@ TEST_CASE("visualize lexeme")
         lexy::visualize_to(std::back_insert_iterator(result),
                            lexeme(input.data(), input.data() + input.size()), opts);
 
+        // Writing in bulk must not change the result.
+        std::string bulk_result;
+        lexy::visualize_to(string_writer{&bulk_result},
+                           lexeme(input.data(), input.data() + input.size()), opts);
+        CHECK(bulk_result == result);
+
         return result;
     };
 
@@ -117,6 +153,9 @@ TEST_CASE("visualize lexeme")
         CHECK(visualize(lexy::default_encoding{}, out_of_range) == R"(a\xFFc)");
 
         CHECK(visualize(lexy::default_encoding{}, "abc", 2) == R"(ab...)");
+        CHECK(visualize(lexy::default_encoding{}, "abc", 3) == R"(abc...)");
+        CHECK(visualize(lexy::default_encoding{}, "ab c\\d", 6) == R"(ab c\\d...)");
+        CHECK(visualize(lexy::default_encoding{}, "abc\ndef", 5) == R"(abc\nd...)");
     }
     SUBCASE("unicode encoding")
     {
@@ -136,6 +175,9 @@ TEST_CASE("visualize lexeme")
         CHECK(visualize(lexy::utf32_encoding{}, U"\x1100FF") == R"(\x11\x00\xFF)");
 
         CHECK(visualize(lexy::utf8_encoding{}, "abc", 2) == R"(ab...)");
+        CHECK(visualize(lexy::utf8_encoding{}, "ab\u1234cd", 4) == R"(ab\u1234c...)");
+        CHECK(visualize(lexy::utf8_encoding{}, "ab\xC0\xA0"
+                                                "cd") == R"(ab\xC0\xA0cd)");
     }
     SUBCASE("byte encoding")
     {
@@ -299,3 +341,35 @@ TEST_CASE("visualization_display_width")
     }
 }
 
+TEST_CASE("cfile_output_buffer")
+{
+    auto file = std::tmpfile();
+    REQUIRE(file != nullptr);
+
+    std::string expected;
+    {
+        lexy::cfile_output_buffer buffer(file);
+
+        auto out = buffer.output_iterator();
+        for (auto i = 0; i != 1000; ++i)
+        {
+            *out++ = 'a';
+            out.write("bcd", 3);
+            expected += "abcd";
+        }
+
+        auto long_str = std::string(2 * lexy::cfile_output_buffer::capacity, 'x');
+        out.write(long_str.data(), long_str.size());
+        expected += long_str;
+
+        lexy::visualize_to(out, lexy::code_point('\n'));
+        expected += "\\n";
+    }
+
+    std::string result(expected.size() + 1, '\0');
+    std::rewind(file);
+    result.resize(std::fread(&result[0], 1, result.size(), file));
+    std::fclose(file);
+
+    CHECK(result == expected);
+}
@@ -198,6 +198,29 @@ TEST_CASE("_detail::write_error")
 )*");
     }
 
+    SUBCASE("line index")
+    {
+        auto input = lexy::zstring_input("hello\nworld\r\nabc");
+        auto index = lexy::line_index(input);
+
+        auto context = lexy::error_context(production{}, input, input.data() + 6);
+        lexy::string_error<error_tag> error(input.data() + 14);
+
+        std::string str;
+        lexy_ext::_detail::write_error(std::back_insert_iterator(str), context, error, {}, &index);
+        CHECK(str == R"*(error: while parsing production
+     |
+   2 | world
+     | ~ beginning here
+     |
+   3 | abc
+     |  ^ error tag
+)*");
+
+        auto callback = lexy_ext::report_error.index(index);
+        CHECK(callback.sink()._index == &index);
+    }
+
     SUBCASE("multi-line range")
     {
         auto input = lexy::zstring_input("hello\nworld");